@@ -10,10 +10,104 @@
 #ifndef __ECON_H__
 #define __ECON_H__
 
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ *  completion candidates.
+ */
+struct econ_completion;
+
+/**
+ *  argument completer.
+ *
+ *  called with the command words typed so far, the last one of
+ *  @c argv is the word being completed (may be empty).
+ *  candidates are added with econ_completion_add().
+ */
+typedef void (*econ_completer_fn)(struct econ_completion *comp, int argc, char **argv);
+
+/**
+ *  command flags.
+ */
+enum {
+    ECON_FLAG_ASYNC = 0x01,         /**< run on the worker pool. */
+    ECON_FLAG_IDEMPOTENT = 0x02,    /**< output depends on the words only, and may be cached. */
+    ECON_FLAG_INVALIDATE = 0x04,    /**< changes state, cached output is dropped when run. */
+};
+
+/**
+ *  argument value types.
+ */
+enum {
+    ECON_TYPE_INT,      /**< decimal, or hexadecimal with 0x prefix. */
+    ECON_TYPE_HEX,      /**< hexadecimal, 0x prefix is optional. */
+    ECON_TYPE_ENUM,     /**< one of @c choices. */
+    ECON_TYPE_STRING,   /**< any word. */
+};
+
+/**
+ *  argument flags.
+ */
+enum {
+    ECON_ARG_OPTIONAL = 0x01,   /**< may be omitted, and so may the following ones. */
+};
+
+/**
+ *  most arguments of a schema.
+ */
+#define ECON_ARGS_MAX (16)
+
+/**
+ *  argument schema entry.
+ *
+ *  numbers are checked to be within @c min and @c max, strings to have
+ *  a length within them. nothing is checked when both are 0.
+ */
+struct econ_arg {
+    const char *name;               /**< argument name, NULL terminates a schema. */
+    int type;                       /**< value type. */
+    long long min;                  /**< smallest value or length. */
+    long long max;                  /**< largest value or length. */
+    const char *const *choices;     /**< enum names, NULL terminated. */
+    unsigned int flags;             /**< argument flags. */
+};
+
+/**
+ *  converted argument.
+ */
+union econ_value {
+    long long i;            /**< @ref ECON_TYPE_INT. */
+    unsigned long long u;   /**< @ref ECON_TYPE_HEX. */
+    int index;              /**< @ref ECON_TYPE_ENUM, index into choices. */
+    const char *s;          /**< @ref ECON_TYPE_STRING. */
+};
+
+/**
+ *  argument schema helpers.
+ */
+#define ECON_ARG(n, t, lo, hi, c, f) \
+    {.name=(n), .type=(t), .min=(lo), .max=(hi), .choices=(c), .flags=(f)}
+#define ECON_ARG_INT(n, lo, hi) ECON_ARG(n, ECON_TYPE_INT, lo, hi, NULL, 0)
+#define ECON_ARG_HEX(n, lo, hi) ECON_ARG(n, ECON_TYPE_HEX, lo, hi, NULL, 0)
+#define ECON_ARG_ENUM(n, c) ECON_ARG(n, ECON_TYPE_ENUM, 0, 0, c, 0)
+#define ECON_ARG_STRING(n) ECON_ARG(n, ECON_TYPE_STRING, 0, 0, NULL, 0)
+#define ECON_END_OF_ARG() ECON_ARG(NULL, 0, 0, 0, NULL, 0)
+
+struct econ_command;
+
+/**
+ *  command lookup of a command list.
+ *
+ *  returns the entry of @c cmds named @c name, or NULL.
+ */
+typedef const struct econ_command *(*econ_lookup_fn)(const struct econ_command *cmds, const char *name);
+
 /**
  *  command structure.
  */
@@ -23,6 +117,13 @@ struct econ_command {
     int (*func)(int, char **);     /**< command function. */
     const char *help;              /**< help message. */
     void (*usage)(const char *);   /**< command usage. */
+    econ_completer_fn complete;    /**< argument completer, or NULL. */
+    unsigned int flags;            /**< command flags. */
+    const struct econ_arg *args;   /**< argument schema, or NULL. */
+    econ_lookup_fn lookup;         /**< lookup of the whole list, set on its first
+                                        entry only, or NULL to scan the list. */
+    unsigned int ttl;              /**< milliseconds cached output is served for,
+                                        0 until invalidated. */
 };
 
 /**
@@ -31,6 +132,52 @@ struct econ_command {
 #define ECON_COMMAND(c, f, h, u) \
     {.command=(c), .sub_cmds=NULL, .func=(f), .help=(h), .usage=(u)}
 
+/**
+ *  command with argument completer registration helper.
+ */
+#define ECON_COMMAND_COMPLETE(c, f, h, u, x) \
+    {.command=(c), .sub_cmds=NULL, .func=(f), .help=(h), .usage=(u), .complete=(x)}
+
+/**
+ *  command with argument schema registration helper.
+ *
+ *  arguments are converted before @c f is called, see econ_values().
+ *  usage is generated from the schema.
+ */
+#define ECON_COMMAND_ARGS(c, f, h, a) \
+    {.command=(c), .sub_cmds=NULL, .func=(f), .help=(h), .usage=NULL, .args=(a)}
+
+/**
+ *  idempotent command registration helper.
+ *
+ *  output of a successful run is served to identical command lines
+ *  for @c t milliseconds, see econ_cache_init().
+ */
+#define ECON_CACHED_COMMAND(c, f, h, u, t) \
+    {.command=(c), .sub_cmds=NULL, .func=(f), .help=(h), .usage=(u), .flags=ECON_FLAG_IDEMPOTENT, .ttl=(t)}
+
+/**
+ *  long-running command registration helper.
+ */
+#define ECON_ASYNC_COMMAND(c, f, h, u) \
+    {.command=(c), .sub_cmds=NULL, .func=(f), .help=(h), .usage=(u), .flags=ECON_FLAG_ASYNC}
+
+/**
+ *  job control commands registration helper.
+ */
+#define ECON_JOB_COMMANDS()                                                \
+    ECON_COMMAND("jobs", econ_jobs_command, "list jobs", NULL),            \
+    ECON_COMMAND("fg", econ_fg_command, "bring job to foreground", NULL), \
+    ECON_COMMAND("wait", econ_wait_command, "wait for jobs", NULL)
+
+/**
+ *  pipeline filter commands registration helper.
+ */
+#define ECON_PIPE_COMMANDS()                                                                \
+    ECON_COMMAND("grep", econ_grep_command, "print lines matching pattern", econ_grep_usage), \
+    ECON_COMMAND("head", econ_head_command, "print first lines", econ_head_usage),            \
+    ECON_COMMAND("wc", econ_wc_command, "count lines, words and bytes", econ_wc_usage)
+
 /**
  *  sub-command registration helper.
  */
@@ -44,26 +191,688 @@ struct econ_command {
     {.command=NULL, .sub_cmds=NULL, .func=NULL, .help=NULL, .usage=NULL}
 
 /**
- *  command prompt.
+ *  console session.
+ */
+struct econ_session;
+
+/**
+ *  output sink.
+ *
+ *  writes up to @c len bytes of @c buf, returns written length,
+ *  0 if nothing can be written now, or -1 on error.
+ */
+typedef ssize_t (*econ_output_fn)(void *ctx, const void *buf, size_t len);
+
+/**
+ *  session counters.
+ */
+struct econ_session_stats {
+    uint64_t keys;      /**< handled keystrokes. */
+    uint64_t reads;     /**< input read calls. */
+    uint64_t in_bytes;  /**< input bytes. */
+    uint64_t writes;    /**< output sink calls. */
+    uint64_t out_bytes; /**< output bytes. */
+    uint64_t dropped;   /**< output bytes dropped. */
+    uint64_t stalls;    /**< waits for the output to take more. */
+};
+
+/**
+ *  output policies, when the output queue is full.
+ */
+enum {
+    ECON_OUTPUT_BLOCK,  /**< the command waits for room. */
+    ECON_OUTPUT_DROP,   /**< newest output is dropped and counted. */
+    ECON_OUTPUT_MORE,   /**< as block, and output stops at every screenful
+                             until a key is typed. */
+};
+
+/**
+ *  output flow control flags.
+ */
+enum {
+    ECON_FLOW_XONXOFF = 0x01,   /**< DC3 typed pauses output, DC1 resumes it. */
+    ECON_FLOW_RTSCTS = 0x02,    /**< hardware flow control on the output terminal. */
+};
+
+/**
+ *  output queue configuration.
+ */
+struct econ_output_config {
+    size_t limit;       /**< bytes queued at most, 0 for no limit. */
+    int policy;         /**< output policy. */
+    int flow;           /**< output flow control flags. */
+};
+
+/**
+ *  session timer.
+ */
+struct econ_timer;
+
+/**
+ *  timer callback.
+ */
+typedef void (*econ_timer_fn)(struct econ_timer *t, void *ctx);
+
+/**
+ *  create console session.
+ */
+struct econ_session *econ_session_create(int in_fd, int out_fd);
+
+/**
+ *  destroy console session.
+ */
+void econ_session_destroy(struct econ_session *s);
+
+/**
+ *  replace session output sink.
+ */
+void econ_session_set_output(struct econ_session *s, econ_output_fn output, void *ctx);
+
+/**
+ *  configure session output queue.
+ */
+int econ_session_set_flow(struct econ_session *s, const struct econ_output_config *config);
+
+/**
+ *  command prompt on session.
+ */
+int econ_session_prompt(struct econ_session *s, const char *prompt, char **argv, size_t length);
+
+/**
+ *  get session polling fd.
+ */
+int econ_session_fd(const struct econ_session *s);
+
+/**
+ *  command prompt on session, without waiting.
+ */
+int econ_session_step(struct econ_session *s, const char *prompt, char **argv, size_t length);
+
+/**
+ *  add session timer.
+ */
+struct econ_timer *econ_timer_add(struct econ_session *s, uint64_t delay_ms, uint64_t interval_ms,
+                                  econ_timer_fn fn, void *ctx);
+
+/**
+ *  restart session timer.
+ */
+int econ_timer_set(struct econ_timer *t, uint64_t delay_ms, uint64_t interval_ms);
+
+/**
+ *  remove session timer.
+ */
+void econ_timer_remove(struct econ_timer *t);
+
+/**
+ *  command invoke on session.
+ */
+int econ_session_invoke(struct econ_session *s, int argc, char **argv, struct econ_command *cmds);
+
+/**
+ *  flush session output.
+ */
+int econ_session_flush(struct econ_session *s);
+
+/**
+ *  get session counters.
+ */
+void econ_session_get_stats(const struct econ_session *s, struct econ_session_stats *stats);
+
+/**
+ *  reset session counters.
+ */
+void econ_session_reset_stats(struct econ_session *s);
+
+/**
+ *  get session of the running command.
+ */
+struct econ_session *econ_session_current(void);
+
+/**
+ *  command prompt on default session.
+ *
+ *  the default session is created once for the process. it is not
+ *  locked, one thread at a time may use it.
  */
 int econ_prompt(const char *prompt, char **argv, size_t length);
 
 /**
- *  command invoke.
+ *  get default session polling fd.
+ */
+int econ_fd(void);
+
+/**
+ *  command prompt on default session, without waiting.
+ */
+int econ_step(const char *prompt, char **argv, size_t length);
+
+/**
+ *  command invoke on current session.
  */
 int econ_invoke(int argc, char **argv, struct econ_command *cmds);
 
-#define logger_debug(format, ...)                             \
-    do {                                                      \
-        extern FILE *logger;                                  \
-        if (logger == NULL) {                                 \
-            logger = fopen("/tmp/econ.log", "w");             \
-        }                                                     \
-        fprintf(logger, "%s:%d:%s " format "\n",              \
-                __FILE__, __LINE__, __func__, ##__VA_ARGS__); \
-        fflush(logger);                                       \
+/**
+ *  write to current session.
+ */
+ssize_t econ_write(const void *buf, size_t len);
+
+/**
+ *  flush current session output.
+ */
+int econ_flush(void);
+
+/**
+ *  formatted write to current session.
+ */
+int econ_printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ *  configure job worker pool.
+ */
+int econ_jobs_init(size_t workers, size_t limit);
+
+/**
+ *  stop job worker pool.
+ */
+void econ_jobs_shutdown(void);
+
+/**
+ *  check cancel request of running job.
+ */
+int econ_cancelled(void);
+
+/**
+ *  get converted arguments of running command.
+ */
+const union econ_value *econ_values(void);
+
+/**
+ *  `jobs` command.
+ */
+int econ_jobs_command(int argc, char **argv);
+
+/**
+ *  `fg` command.
+ */
+int econ_fg_command(int argc, char **argv);
+
+/**
+ *  `wait` command.
+ */
+int econ_wait_command(int argc, char **argv);
+
+/**
+ *  byte stream between piped commands.
+ */
+struct econ_stream;
+
+/**
+ *  get input stream of running command.
+ */
+struct econ_stream *econ_input(void);
+
+/**
+ *  get unread length of stream.
+ */
+size_t econ_stream_length(const struct econ_stream *st);
+
+/**
+ *  peek at next line of stream.
+ */
+ssize_t econ_stream_peek_line(struct econ_stream *st, const char **line);
+
+/**
+ *  discard bytes of stream.
+ */
+size_t econ_stream_skip(struct econ_stream *st, size_t len);
+
+/**
+ *  read bytes of stream.
+ */
+ssize_t econ_stream_read(struct econ_stream *st, void *buf, size_t len);
+
+/**
+ *  pass bytes of stream to output without copying.
+ */
+ssize_t econ_stream_forward(struct econ_stream *st, size_t len);
+
+/**
+ *  `grep` filter command.
+ */
+int econ_grep_command(int argc, char **argv);
+
+/**
+ *  `head` filter command.
+ */
+int econ_head_command(int argc, char **argv);
+
+/**
+ *  `wc` filter command.
+ */
+int econ_wc_command(int argc, char **argv);
+
+/**
+ *  `grep` usage.
+ */
+void econ_grep_usage(const char *name);
+
+/**
+ *  `head` usage.
+ */
+void econ_head_usage(const char *name);
+
+/**
+ *  `wc` usage.
+ */
+void econ_wc_usage(const char *name);
+
+/**
+ *  batch mode flags.
+ */
+enum {
+    ECON_BATCH_STOP_ON_ERROR = 0x01,    /**< stop at the first failed command. */
+};
+
+/**
+ *  batch mode counters.
+ */
+struct econ_batch_stats {
+    size_t lines;       /**< lines read. */
+    size_t commands;    /**< commands run. */
+    size_t errors;      /**< failed commands. */
+    size_t first_error; /**< line number of the first failure, 0 if none. */
+};
+
+/**
+ *  run commands read from fd without line editing.
+ */
+int econ_run_stream(int fd, struct econ_command *cmds, int flags, struct econ_batch_stats *stats);
+
+/**
+ *  answer JSON-lines requests read from fd, without echo or line editing.
+ */
+int econ_run_rpc(int in_fd, int out_fd, struct econ_command *cmds, struct econ_batch_stats *stats);
+
+/**
+ *  command registry.
+ */
+struct econ_registry;
+
+/**
+ *  create command registry.
+ */
+struct econ_registry *econ_registry_create(const struct econ_command *cmds);
+
+/**
+ *  destroy command registry.
+ */
+void econ_registry_destroy(struct econ_registry *reg);
+
+/**
+ *  register command.
+ */
+int econ_registry_register(struct econ_registry *reg, const struct econ_command *cmd);
+
+/**
+ *  unregister command.
+ */
+int econ_registry_unregister(struct econ_registry *reg, const char *name);
+
+/**
+ *  find command.
+ */
+const struct econ_command *econ_registry_find(const struct econ_registry *reg, const char *name);
+
+/**
+ *  get sub-command registry.
+ */
+struct econ_registry *econ_registry_sub(struct econ_registry *reg, const char *name);
+
+/**
+ *  print available command list.
+ */
+void econ_registry_help(const struct econ_registry *reg);
+
+/**
+ *  command invoke from registry.
+ */
+int econ_registry_invoke(struct econ_registry *reg, int argc, char **argv);
+
+/**
+ *  collect completion candidates from registry.
+ */
+int econ_registry_complete(struct econ_registry *reg, int argc, char **argv,
+                           struct econ_completion *comp);
+
+/**
+ *  add completion candidate.
+ */
+int econ_completion_add(struct econ_completion *comp, const char *candidate);
+
+/**
+ *  attach command registry used for completion to session.
+ */
+void econ_session_set_registry(struct econ_session *s, struct econ_registry *reg);
+
+/**
+ *  command history.
+ */
+struct econ_history;
+
+/**
+ *  open command history.
+ */
+struct econ_history *econ_history_open(const char *path, size_t entries);
+
+/**
+ *  close command history.
+ */
+void econ_history_close(struct econ_history *h);
+
+/**
+ *  append line to history.
+ */
+int econ_history_add(struct econ_history *h, const char *line);
+
+/**
+ *  get range of history entries.
+ */
+size_t econ_history_range(struct econ_history *h, int64_t *first, int64_t *last);
+
+/**
+ *  get history entry.
+ */
+ssize_t econ_history_get(struct econ_history *h, int64_t seq, char *buf, size_t size);
+
+/**
+ *  search history backward.
+ */
+int64_t econ_history_search(struct econ_history *h, const char *query, int64_t from);
+
+/**
+ *  attach history to session.
+ */
+void econ_session_set_history(struct econ_session *s, struct econ_history *h);
+
+/**
+ *  console server configuration.
+ */
+struct econ_server_config {
+    const char *unix_path;          /**< AF_UNIX socket path, or NULL. */
+    int tcp_port;                   /**< loopback TCP port, 0 for any, -1 for none. */
+    const char *prompt;             /**< prompt string. */
+    struct econ_command *cmds;      /**< command list. */
+    size_t max_clients;             /**< maximum connections, 0 for default. */
+    struct econ_history *history;   /**< history shared by connections, or NULL. */
+    int rpc;                        /**< connections exchange JSON-lines frames
+                                         instead of typing, see econ_run_rpc(). */
+};
+
+/**
+ *  console server.
+ */
+struct econ_server;
+
+/**
+ *  create console server.
+ */
+struct econ_server *econ_server_create(const struct econ_server_config *config);
+
+/**
+ *  destroy console server.
+ */
+void econ_server_destroy(struct econ_server *srv);
+
+/**
+ *  get bound TCP port.
+ */
+int econ_server_port(const struct econ_server *srv);
+
+/**
+ *  serve connections until stopped.
+ */
+int econ_server_run(struct econ_server *srv);
+
+/**
+ *  stop econ_server_run().
+ */
+void econ_server_stop(struct econ_server *srv);
+
+/**
+ *  log levels.
+ */
+#define ECON_LOG_ERROR (0)
+#define ECON_LOG_WARN (1)
+#define ECON_LOG_INFO (2)
+#define ECON_LOG_DEBUG (3)
+
+/**
+ *  most verbose level compiled in.
+ */
+#ifndef ECON_LOG_LEVEL
+#if defined(NODEBUG) && (NODEBUG == 1)
+#define ECON_LOG_LEVEL ECON_LOG_INFO
+#else
+#define ECON_LOG_LEVEL ECON_LOG_DEBUG
+#endif
+#endif
+
+/**
+ *  most arguments recorded by a log call.
+ */
+#define ECON_LOG_MAX_ARGS (16)
+
+/**
+ *  log call site.
+ *
+ *  one static instance per call, only its address is recorded.
+ */
+struct econ_log_site {
+    int level;              /**< log level. */
+    int line;               /**< source line. */
+    const char *file;       /**< source file. */
+    const char *func;       /**< function name. */
+    const char *format;     /**< printf format. */
+    int state;              /**< @c types state. (internal) */
+    int nargs;              /**< argument count. (internal) */
+    unsigned char types[ECON_LOG_MAX_ARGS]; /**< argument types. (internal) */
+    uint32_t id;            /**< output id. (internal) */
+};
+
+/**
+ *  record a log event to the ring of this thread.
+ */
+void econ_log_record(struct econ_log_site *site, ...);
+
+/**
+ *  check log arguments against the format at compile time.
+ */
+static inline void econ_log_check(const char *format, ...) __attribute__((format(printf, 1, 2)));
+static inline void econ_log_check(const char *format, ...)
+{
+}
+
+#define ECON_LOG_AT(lv, format, ...)                                     \
+    do {                                                                 \
+        static struct econ_log_site econ_log_site_ = {                   \
+            (lv), __LINE__, __FILE__, __func__, (format), 0, 0, {0}, 0}; \
+        if (0) {                                                         \
+            econ_log_check(format, ##__VA_ARGS__);                       \
+        }                                                                \
+        econ_log_record(&econ_log_site_, ##__VA_ARGS__);                 \
     } while (0)
 
+#if ECON_LOG_LEVEL >= ECON_LOG_ERROR
+#define econ_log_error(format, ...) ECON_LOG_AT(ECON_LOG_ERROR, format, ##__VA_ARGS__)
+#else
+#define econ_log_error(format, ...) do {} while (0)
+#endif
+#if ECON_LOG_LEVEL >= ECON_LOG_WARN
+#define econ_log_warn(format, ...) ECON_LOG_AT(ECON_LOG_WARN, format, ##__VA_ARGS__)
+#else
+#define econ_log_warn(format, ...) do {} while (0)
+#endif
+#if ECON_LOG_LEVEL >= ECON_LOG_INFO
+#define econ_log_info(format, ...) ECON_LOG_AT(ECON_LOG_INFO, format, ##__VA_ARGS__)
+#else
+#define econ_log_info(format, ...) do {} while (0)
+#endif
+#if ECON_LOG_LEVEL >= ECON_LOG_DEBUG
+#define econ_log_debug(format, ...) ECON_LOG_AT(ECON_LOG_DEBUG, format, ##__VA_ARGS__)
+#else
+#define econ_log_debug(format, ...) do {} while (0)
+#endif
+
+/**
+ *  former debug logger, now recorded at debug level.
+ */
+#define logger_debug(format, ...) econ_log_debug(format, ##__VA_ARGS__)
+
+/**
+ *  open background log output.
+ */
+int econ_log_open(const char *path);
+
+/**
+ *  write pending log records and close background output.
+ */
+int econ_log_close(void);
+
+/**
+ *  write pending log records to background output now.
+ */
+int econ_log_flush(void);
+
+/**
+ *  decode a binary log to text.
+ */
+int econ_log_decode(int in_fd, int out_fd);
+
+/**
+ *  log command.
+ */
+int econ_log_command(int argc, char **argv);
+
+/**
+ *  log command usage.
+ */
+void econ_log_usage(const char *name);
+
+/**
+ *  log command registration helper.
+ */
+#define ECON_LOG_COMMAND() \
+    ECON_COMMAND("log", econ_log_command, "show or write log records", econ_log_usage)
+
+/**
+ *  latency summary.
+ *
+ *  command paths are timed per call, the prompt from wake-up on
+ *  input to the echo being written. compiled out with NODEBUG=1.
+ */
+struct econ_stats {
+    const char *name;   /**< command path, or "prompt/echo" and "prompt/wakeups". */
+    const char *unit;   /**< "ns", or "" for counts. */
+    uint64_t count;     /**< recorded values. */
+    uint64_t mean;      /**< mean value. */
+    uint64_t p50;       /**< median. */
+    uint64_t p99;       /**< 99th percentile. */
+    uint64_t p999;      /**< 99.9th percentile. */
+    uint64_t max;       /**< largest value. */
+};
+
+/**
+ *  get latency summaries.
+ */
+size_t econ_stats_list(struct econ_stats *list, size_t length);
+
+/**
+ *  get latency summary by name.
+ */
+int econ_stats_get(const char *name, struct econ_stats *st);
+
+/**
+ *  clear latency figures.
+ */
+void econ_stats_reset(void);
+
+/**
+ *  stats command.
+ */
+int econ_stats_command(int argc, char **argv);
+
+/**
+ *  stats command usage.
+ */
+void econ_stats_usage(const char *name);
+
+/**
+ *  stats command registration helper.
+ */
+#define ECON_STATS_COMMAND() \
+    ECON_COMMAND("stats", econ_stats_command, "show latency statistics", econ_stats_usage)
+
+/**
+ *  output cache counters.
+ */
+struct econ_cache_stats {
+    uint64_t hits;          /**< runs served from the cache. */
+    uint64_t misses;        /**< runs of cacheable commands not found. */
+    uint64_t evictions;     /**< entries dropped for room. */
+    uint64_t expired;       /**< entries dropped for their age. */
+    uint64_t invalidated;   /**< entries dropped on request. */
+    size_t entries;         /**< entries held. */
+    size_t bytes;           /**< output bytes held. */
+};
+
+/**
+ *  configure output cache.
+ */
+int econ_cache_init(size_t entries, size_t bytes);
+
+/**
+ *  drop cached output of a command function, or of all commands.
+ */
+void econ_cache_invalidate(int (*func)(int, char **));
+
+/**
+ *  get output cache counters.
+ */
+void econ_cache_get_stats(struct econ_cache_stats *st);
+
+/**
+ *  cache command.
+ */
+int econ_cache_command(int argc, char **argv);
+
+/**
+ *  cache command usage.
+ */
+void econ_cache_usage(const char *name);
+
+/**
+ *  cache command registration helper.
+ */
+#define ECON_CACHE_COMMAND() \
+    ECON_COMMAND("cache", econ_cache_command, "show or clear cached output", econ_cache_usage)
+
+/**
+ *  watch command.
+ */
+int econ_watch_command(int argc, char **argv);
+
+/**
+ *  watch command usage.
+ */
+void econ_watch_usage(const char *name);
+
+/**
+ *  watch command registration helper.
+ */
+#define ECON_WATCH_COMMAND() \
+    ECON_COMMAND("watch", econ_watch_command, "run a command periodically", econ_watch_usage)
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,362 @@
+/** @file       econ.hpp
+ *  @brief      Compile-time command tables for C++.
+ *
+ *  a table is built by a constexpr call, the compiler rejects duplicate
+ *  names and lays out the lookup, nothing is initialized at run time.
+ *
+ *  @code
+ *  constexpr auto cmds = econ::make_table({
+ *      econ::command("peek", cmd_peek, "read register"),
+ *      ECON_COMMAND_ARGS("poke", cmd_poke, "write register", poke_args),
+ *      ECON_JOB_COMMANDS(),
+ *  });
+ *
+ *  econ_session_invoke(s, argc, argv, cmds.commands());
+ *  @endcode
+ *
+ *  names are placed by a perfect hash (hash and displace), so a lookup
+ *  hashes the name once and compares it with one entry. the library
+ *  looks commands up through econ_command::lookup of the first entry,
+ *  and C code sees a terminated list as usual.
+ *
+ *  requires C++17.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-17 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_HPP__
+#define __ECON_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+
+#include "econ.h"
+
+namespace econ {
+
+/**
+ *  command entry.
+ */
+constexpr econ_command command(const char *name, int (*func)(int, char **), const char *help,
+                               void (*usage)(const char *) = nullptr,
+                               econ_completer_fn complete = nullptr)
+{
+    return econ_command{name, nullptr, func, help, usage, complete, 0, nullptr, nullptr};
+}
+
+/**
+ *  long-running command entry.
+ */
+constexpr econ_command async_command(const char *name, int (*func)(int, char **), const char *help,
+                                     void (*usage)(const char *) = nullptr)
+{
+    return econ_command{name, nullptr, func, help, usage, nullptr, ECON_FLAG_ASYNC, nullptr, nullptr};
+}
+
+/**
+ *  idempotent command entry, output is served for @c ttl milliseconds.
+ */
+constexpr econ_command cached_command(const char *name, int (*func)(int, char **), const char *help,
+                                      unsigned int ttl, void (*usage)(const char *) = nullptr)
+{
+    return econ_command{name, nullptr, func, help, usage, nullptr, ECON_FLAG_IDEMPOTENT, nullptr, nullptr, ttl};
+}
+
+/**
+ *  command with argument schema entry.
+ */
+constexpr econ_command command_args(const char *name, int (*func)(int, char **), const char *help,
+                                    const econ_arg *args)
+{
+    return econ_command{name, nullptr, func, help, nullptr, nullptr, 0, args, nullptr};
+}
+
+/**
+ *  sub-command entry, @c sub_cmds is commands() of another table.
+ */
+constexpr econ_command subcommand(const char *name, econ_command *sub_cmds, const char *help)
+{
+    return econ_command{name, sub_cmds, nullptr, help, nullptr, nullptr, 0, nullptr, nullptr};
+}
+
+namespace detail {
+
+/**
+ *  smallest power of 2 not less than @c n.
+ */
+constexpr size_t pow2(size_t n)
+{
+    size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+/**
+ *  mix bits of @c h, so that any of them may be masked.
+ */
+constexpr uint32_t mix(uint32_t h)
+{
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ *  hash of a name. (FNV-1a)
+ */
+constexpr uint32_t hash(const char *s)
+{
+    uint32_t h = 2166136261u;
+    while (*s != '\0') {
+        h = (h ^ (unsigned char)*s++) * 16777619u;
+    }
+    return mix(h);
+}
+
+/**
+ *  slot of hash @c h displaced by @c d.
+ */
+constexpr uint32_t displace(uint32_t h, uint32_t d)
+{
+    return mix(h ^ (d * 0x9E3779B9u));
+}
+
+constexpr bool equal(const char *a, const char *b)
+{
+    while ((*a != '\0') && (*a == *b)) {
+        ++a;
+        ++b;
+    }
+    return *a == *b;
+}
+
+constexpr size_t length(const char *s)
+{
+    size_t len = 0;
+    while (s[len] != '\0') {
+        ++len;
+    }
+    return len;
+}
+
+} // namespace detail
+
+/**
+ *  command table of @c N commands.
+ */
+template <size_t N>
+class command_table {
+public:
+    static_assert(N > 0, "empty command table");
+    static_assert(N < UINT16_MAX, "too many commands");
+
+    static constexpr size_t buckets = detail::pow2(N);      /**< first level of the hash. */
+    static constexpr size_t slots = detail::pow2(N * 2);    /**< second level of the hash. */
+
+    /**
+     *  build table of @c cmds.
+     *
+     *  throws if two commands have one name, which fails a constexpr table
+     *  at compile time.
+     */
+    constexpr explicit command_table(const econ_command (&cmds)[N])
+        : cmds_{}, disp_{}, slot_{}, width_(0)
+    {
+        uint32_t hashes[N] = {};
+
+        for (size_t i = 0; i < N; ++i) {
+            if (cmds[i].command == nullptr) {
+                throw "command without name";
+            }
+            for (size_t j = 0; j < i; ++j) {
+                if (detail::equal(cmds[i].command, cmds[j].command)) {
+                    throw "duplicate command name";
+                }
+            }
+            cmds_[i] = cmds[i];
+            cmds_[i].lookup = nullptr;
+            hashes[i] = detail::hash(cmds[i].command);
+            size_t len = detail::length(cmds[i].command);
+            width_ = (len > width_) ? len : width_;
+        }
+        cmds_[0].lookup = &command_table::lookup;
+
+        /* largest buckets are placed first, while most slots are free. */
+        size_t count[buckets] = {};
+        size_t largest = 0;
+        for (size_t i = 0; i < N; ++i) {
+            size_t n = ++count[hashes[i] & (buckets - 1)];
+            largest = (n > largest) ? n : largest;
+        }
+        for (size_t n = largest; n > 0; --n) {
+            for (size_t b = 0; b < buckets; ++b) {
+                if (count[b] == n) {
+                    place(hashes, b);
+                }
+            }
+        }
+    }
+
+    /**
+     *  find command @c name.
+     *
+     *  @return returns the command, or nullptr.
+     */
+    constexpr const econ_command *find(const char *name) const
+    {
+        uint32_t h = detail::hash(name);
+        uint16_t i = slot_[detail::displace(h, disp_[h & (buckets - 1)]) & (slots - 1)];
+
+        return ((i > 0) && detail::equal(cmds_[i - 1].command, name)) ? &cmds_[i - 1] : nullptr;
+    }
+
+    /**
+     *  terminated command list for the C API.
+     *
+     *  the library does not modify it.
+     */
+    constexpr econ_command *commands() const
+    {
+        return const_cast<econ_command *>(cmds_);
+    }
+
+    /**
+     *  number of commands.
+     */
+    constexpr size_t size() const
+    {
+        return N;
+    }
+
+    /**
+     *  length of the longest name.
+     */
+    constexpr size_t width() const
+    {
+        return width_;
+    }
+
+    /**
+     *  length of the help listing, see help_text.
+     */
+    constexpr size_t help_size() const
+    {
+        size_t size = 0;
+        for (size_t i = 0; i < N; ++i) {
+            size += 2 + (width_ + 1) + 2 + ((cmds_[i].help) ? detail::length(cmds_[i].help) : 0) + 2;
+        }
+        return size;
+    }
+
+    /**
+     *  render the help listing, @c L is help_size().
+     */
+    template <size_t L>
+    constexpr std::array<char, L + 1> help() const
+    {
+        std::array<char, L + 1> text = {};
+        size_t pos = 0;
+
+        for (size_t i = 0; i < N; ++i) {
+            const char *name = cmds_[i].command;
+            const char *help = (cmds_[i].help) ? cmds_[i].help : "";
+            size_t len = detail::length(name);
+
+            text[pos++] = '*';
+            text[pos++] = ' ';
+            for (size_t k = 0; k < width_ + 1; ++k) {
+                text[pos++] = (k < len) ? name[k] : ' ';
+            }
+            text[pos++] = ':';
+            text[pos++] = ' ';
+            while (*help != '\0') {
+                text[pos++] = *help++;
+            }
+            text[pos++] = '\r';
+            text[pos++] = '\n';
+        }
+        return text;
+    }
+
+private:
+    /**
+     *  find a displacement putting every command of bucket @c b
+     *  into a free slot.
+     */
+    constexpr void place(const uint32_t (&hashes)[N], size_t b)
+    {
+        for (uint32_t d = 0; d < 0x10000; ++d) {
+            size_t taken[N] = {};
+            size_t n = 0;
+            bool fits = true;
+
+            for (size_t i = 0; fits && (i < N); ++i) {
+                if ((hashes[i] & (buckets - 1)) != b) {
+                    continue;
+                }
+                size_t s = detail::displace(hashes[i], d) & (slots - 1);
+                fits = (slot_[s] == 0);
+                for (size_t k = 0; fits && (k < n); ++k) {
+                    fits = (taken[k] != s);
+                }
+                taken[n++] = s;
+            }
+            if (fits) {
+                disp_[b] = d;
+                n = 0;
+                for (size_t i = 0; i < N; ++i) {
+                    if ((hashes[i] & (buckets - 1)) == b) {
+                        slot_[taken[n++]] = (uint16_t)(i + 1);
+                    }
+                }
+                return;
+            }
+        }
+        throw "no perfect hash";
+    }
+
+    /**
+     *  econ_command::lookup of the table.
+     */
+    static const econ_command *lookup(const econ_command *cmds, const char *name)
+    {
+        /* cmds_ is the first member. */
+        return reinterpret_cast<const command_table *>(cmds)->find(name);
+    }
+
+    econ_command cmds_[N + 1];  /**< commands, terminated. */
+    uint32_t disp_[buckets];    /**< displacement of each bucket. */
+    uint16_t slot_[slots];      /**< command index + 1 of each slot, 0 if free. */
+    size_t width_;              /**< length of the longest name. */
+};
+
+/**
+ *  build a command table.
+ *
+ *  declare the table constexpr, so that it is checked and laid out
+ *  at compile time.
+ */
+template <size_t N>
+constexpr command_table<N> make_table(const econ_command (&cmds)[N])
+{
+    return command_table<N>(cmds);
+}
+
+/**
+ *  help listing of table @c T, aligned at compile time.
+ */
+template <const auto &T>
+inline constexpr auto help_text = T.template help<T.help_size()>();
+
+} // namespace econ
+
+#endif /* __ECON_HPP__ */
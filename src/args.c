@@ -0,0 +1,211 @@
+/** @file       args.c
+ *  @brief      Command argument schemas.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "econ.h"
+#include "args.h"
+
+_Thread_local const union econ_value *args_current = NULL;
+
+/**
+ *  check if @c arg has a range.
+ */
+static inline bool args_ranged(const struct econ_arg *arg)
+{
+    return (arg->min != 0) || (arg->max != 0);
+}
+
+/**
+ *  print range of @c arg.
+ */
+static void args_print_range(const struct econ_arg *arg)
+{
+    if (arg->type == ECON_TYPE_HEX) {
+        econ_printf("0x%llx-0x%llx", (unsigned long long)arg->min, (unsigned long long)arg->max);
+    } else {
+        econ_printf("%lld-%lld", arg->min, arg->max);
+    }
+}
+
+/**
+ *  print choices of an enum argument.
+ */
+static void args_print_choices(const struct econ_arg *arg)
+{
+    for (int i = 0; arg->choices[i] != NULL; ++i) {
+        econ_printf("%s%s", (i > 0) ? "|" : "", arg->choices[i]);
+    }
+}
+
+/**
+ *  convert one argument.
+ *
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned.
+ */
+static int args_value(const char *name, const struct econ_arg *arg, const char *word, union econ_value *value)
+{
+    char *end;
+
+    errno = 0;
+    switch (arg->type) {
+    case ECON_TYPE_INT: {
+        const char *digits = (*word == '-') ? word + 1 : word;
+        int base = ((digits[0] == '0') && ((digits[1] == 'x') || (digits[1] == 'X'))) ? 16 : 10;
+        value->i = strtoll(word, &end, base);
+        if ((*word == '\0') || (*end != '\0') || (errno == ERANGE)) {
+            econ_printf("%s: %s: invalid number '%s'\r\n", name, arg->name, word);
+            return -1;
+        }
+        if (args_ranged(arg) && ((value->i < arg->min) || (value->i > arg->max))) {
+            econ_printf("%s: %s: %s is out of range ", name, arg->name, word);
+            args_print_range(arg);
+            econ_printf("\r\n");
+            return -1;
+        }
+        return 0;
+    }
+    case ECON_TYPE_HEX:
+        value->u = strtoull(word, &end, 16);
+        if ((*word == '\0') || (*word == '-') || (*word == '+') || (*end != '\0') || (errno == ERANGE)) {
+            econ_printf("%s: %s: invalid hex number '%s'\r\n", name, arg->name, word);
+            return -1;
+        }
+        if (args_ranged(arg)
+            && ((value->u < (unsigned long long)arg->min) || (value->u > (unsigned long long)arg->max))) {
+            econ_printf("%s: %s: %s is out of range ", name, arg->name, word);
+            args_print_range(arg);
+            econ_printf("\r\n");
+            return -1;
+        }
+        return 0;
+    case ECON_TYPE_ENUM:
+        for (int i = 0; arg->choices[i] != NULL; ++i) {
+            if (strcmp(arg->choices[i], word) == 0) {
+                value->index = i;
+                return 0;
+            }
+        }
+        econ_printf("%s: %s: '%s' is not one of ", name, arg->name, word);
+        args_print_choices(arg);
+        econ_printf("\r\n");
+        return -1;
+    default: {
+        long long len = strlen(word);
+        if (args_ranged(arg) && ((len < arg->min) || (len > arg->max))) {
+            econ_printf("%s: %s: length must be %lld-%lld\r\n", name, arg->name, arg->min, arg->max);
+            return -1;
+        }
+        value->s = word;
+        return 0;
+    }
+    }
+}
+
+int args_convert(const struct econ_command *cmd, int argc, char **argv, union econ_value *values)
+{
+    const struct econ_arg *args = cmd->args;
+    int i;
+
+    for (i = 0; args[i].name != NULL; ++i) {
+        if (i >= ECON_ARGS_MAX) {
+            econ_printf("%s: too many arguments in schema\r\n", argv[0]);
+            errno = E2BIG;
+            return -1;
+        }
+        memset(&values[i], 0, sizeof(values[i]));
+        if (i + 1 >= argc) {
+            if (args[i].flags & ECON_ARG_OPTIONAL) {
+                continue;
+            }
+            econ_printf("%s: missing <%s>\r\n", argv[0], args[i].name);
+            errno = EINVAL;
+            return -1;
+        }
+        if (args_value(argv[0], &args[i], argv[i + 1], &values[i]) != 0) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    if (argc > i + 1) {
+        econ_printf("%s: too many arguments\r\n", argv[0]);
+        errno = EINVAL;
+        return -1;
+    }
+
+    return 0;
+}
+
+void args_usage(const struct econ_command *cmd, const char *name)
+{
+    const struct econ_arg *args = cmd->args;
+    int width = 0;
+
+    econ_printf("usage: %s", name);
+    for (int i = 0; args[i].name != NULL; ++i) {
+        bool optional = args[i].flags & ECON_ARG_OPTIONAL;
+        econ_printf(optional ? " [%s]" : " <%s>", args[i].name);
+        if ((int)strlen(args[i].name) > width) {
+            width = strlen(args[i].name);
+        }
+    }
+    econ_printf("\r\n");
+
+    static const char *const types[] = {"int", "hex", "", "string"};
+    for (int i = 0; args[i].name != NULL; ++i) {
+        const struct econ_arg *arg = &args[i];
+
+        econ_printf("  %-*s  ", width, arg->name);
+        if (arg->type == ECON_TYPE_ENUM) {
+            args_print_choices(arg);
+        } else {
+            econ_printf("%s", types[arg->type]);
+            if (args_ranged(arg)) {
+                econ_printf((arg->type == ECON_TYPE_STRING) ? ", length " : " ");
+                args_print_range(arg);
+            }
+        }
+        econ_printf("\r\n");
+    }
+}
+
+void args_complete(const struct econ_command *cmd, struct econ_completion *comp, int argc, char **argv)
+{
+    const struct econ_arg *args = cmd->args;
+
+    /* argv[argc - 1] is the word being completed, value argc - 2 of the schema. */
+    for (int i = 0; args[i].name != NULL; ++i) {
+        if (i == argc - 2) {
+            if (args[i].type == ECON_TYPE_ENUM) {
+                for (int j = 0; args[i].choices[j] != NULL; ++j) {
+                    econ_completion_add(comp, args[i].choices[j]);
+                }
+            }
+            return;
+        }
+    }
+}
+
+/**
+ *  @details    get arguments of the running command converted by its
+ *              schema, see @ref ECON_COMMAND_ARGS.
+ *              values[i] holds argv[i + 1]. omitted optional arguments
+ *              are zero.
+ *
+ *  @return     returns converted arguments.
+ *              if the command has no schema, NULL is returned.
+ */
+const union econ_value *econ_values(void)
+{
+    return args_current;
+}
@@ -0,0 +1,41 @@
+/** @file       args.h
+ *  @brief      Command argument schemas.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_ARGS_H__
+#define __ECON_ARGS_H__
+
+#include "econ.h"
+
+/**
+ *  converted arguments of the command running on this thread.
+ */
+extern _Thread_local const union econ_value *args_current;
+
+/**
+ *  convert @c argv by the schema of @c cmd.
+ *
+ *  values[i] receives argv[i + 1]. the first failure is reported
+ *  with econ_printf().
+ *
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int args_convert(const struct econ_command *cmd, int argc, char **argv, union econ_value *values);
+
+/**
+ *  print usage generated from the schema of @c cmd.
+ */
+void args_usage(const struct econ_command *cmd, const char *name);
+
+/**
+ *  add choices of an enum argument being completed.
+ */
+void args_complete(const struct econ_command *cmd, struct econ_completion *comp, int argc, char **argv);
+
+#endif /* __ECON_ARGS_H__ */
@@ -0,0 +1,472 @@
+/** @file       cache.c
+ *  @brief      Cached output of idempotent commands.
+ *
+ *  a cacheable command runs on a session of its own, whose sink passes
+ *  the output on to the session of the caller and keeps a copy. the
+ *  copy of a successful run is held in a LRU list bounded by entries
+ *  and bytes, keyed by the command function and the words of the line.
+ *
+ *  the cache is shared by all sessions, the device behind a command
+ *  is the same whoever asks.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-17 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "econ.h"
+#include "cache.h"
+#include "session.h"
+#include "stream.h"
+#include "utils.h"
+
+/**
+ *  hash buckets of the cache.
+ */
+#define CACHE_BUCKETS (256)
+
+/**
+ *  cached output of one command line.
+ */
+struct cache_entry {
+    int (*func)(int, char **);  /**< command function. */
+    uint32_t hash;              /**< hash of @c func and @c key. */
+    char *key;                  /**< words, each NUL terminated. */
+    size_t key_len;             /**< length of @c key. */
+    char *data;                 /**< output. */
+    size_t len;                 /**< length of @c data. */
+    uint64_t expires;           /**< monotonic time of expiry (ns), 0 for never. */
+    size_t refs;                /**< readers, and the cache while held. */
+    struct cache_entry *chain;  /**< next entry of the bucket. */
+    struct cache_entry *prev;   /**< more recently used entry. */
+    struct cache_entry *next;   /**< less recently used entry. */
+};
+
+/**
+ *  output being captured.
+ */
+struct cache_capture {
+    struct econ_session *to;    /**< session output is passed on to. */
+    char *data;                 /**< copy of the output. */
+    size_t len;                 /**< length of @c data. */
+    size_t cap;                 /**< allocated length of @c data. */
+    bool overflow;              /**< output is too large to keep. */
+};
+
+static struct {
+    pthread_mutex_t lock;                       /**< guards the cache. */
+    struct cache_entry *buckets[CACHE_BUCKETS]; /**< entries by hash. */
+    struct cache_entry *head;                   /**< most recently used. */
+    struct cache_entry *tail;                   /**< least recently used. */
+    size_t max_entries;                         /**< most entries. */
+    size_t max_bytes;                           /**< most output bytes. */
+    uint64_t generation;                        /**< bumped when all output is dropped. */
+    uint64_t generations[CACHE_BUCKETS];        /**< bumped when output of the commands
+                                                     hashed here is dropped. */
+    struct econ_cache_stats stats;              /**< counters. */
+} cache = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .max_entries = CACHE_DEFAULT_ENTRIES,
+    .max_bytes = CACHE_DEFAULT_BYTES,
+};
+
+/**
+ *  get monotonic time in nanoseconds.
+ */
+static uint64_t cache_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ *  join words into a key.
+ *
+ *  @return returns key on success.
+ *          on error, NULL is returned.
+ */
+static char *cache_key(int argc, char **argv, size_t *len)
+{
+    *len = 0;
+    for (int i = 0; i < argc; ++i) {
+        *len += strlen(argv[i]) + 1;
+    }
+    char *key = malloc(*len);
+    if (key == NULL) {
+        return NULL;
+    }
+    char *p = key;
+    for (int i = 0; i < argc; ++i) {
+        size_t n = strlen(argv[i]) + 1;
+        memcpy(p, argv[i], n);
+        p += n;
+    }
+    return key;
+}
+
+/**
+ *  hash of a command line. (FNV-1a)
+ */
+static uint32_t cache_hash(int (*func)(int, char **), const char *key, size_t len)
+{
+    uint32_t h = 2166136261u ^ (uint32_t)(uintptr_t)func;
+
+    for (size_t i = 0; i < len; ++i) {
+        h = (h ^ (unsigned char)key[i]) * 16777619u;
+    }
+    return h;
+}
+
+/**
+ *  get the invalidation generation of @c func, moving on whenever its
+ *  output is dropped.
+ */
+static uint64_t cache_generation(int (*func)(int, char **))
+{
+    return cache.generation + cache.generations[cache_hash(func, NULL, 0) % CACHE_BUCKETS];
+}
+
+static void cache_release(struct cache_entry *e)
+{
+    if (--e->refs == 0) {
+        free(e->key);
+        free(e->data);
+        free(e);
+    }
+}
+
+/**
+ *  drop @c e from the cache.
+ */
+static void cache_unlink(struct cache_entry *e)
+{
+    struct cache_entry **pp = &cache.buckets[e->hash % CACHE_BUCKETS];
+    while (*pp != e) {
+        pp = &(*pp)->chain;
+    }
+    *pp = e->chain;
+
+    if (e->prev != NULL) {
+        e->prev->next = e->next;
+    } else {
+        cache.head = e->next;
+    }
+    if (e->next != NULL) {
+        e->next->prev = e->prev;
+    } else {
+        cache.tail = e->prev;
+    }
+    --cache.stats.entries;
+    cache.stats.bytes -= e->len;
+    cache_release(e);
+}
+
+/**
+ *  make @c e the most recently used.
+ */
+static void cache_link_head(struct cache_entry *e)
+{
+    e->prev = NULL;
+    e->next = cache.head;
+    if (cache.head != NULL) {
+        cache.head->prev = e;
+    } else {
+        cache.tail = e;
+    }
+    cache.head = e;
+}
+
+/**
+ *  drop least recently used entries until within bounds.
+ */
+static void cache_trim(void)
+{
+    while ((cache.tail != NULL)
+           && ((cache.stats.entries > cache.max_entries) || (cache.stats.bytes > cache.max_bytes))) {
+        cache_unlink(cache.tail);
+        ++cache.stats.evictions;
+    }
+}
+
+static struct cache_entry *cache_find(int (*func)(int, char **), uint32_t hash, const char *key, size_t len)
+{
+    for (struct cache_entry *e = cache.buckets[hash % CACHE_BUCKETS]; e != NULL; e = e->chain) {
+        if ((e->hash == hash) && (e->func == func) && (e->key_len == len)
+            && (memcmp(e->key, key, len) == 0)) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+/**
+ *  sink of the capturing session, passes output on and keeps a copy.
+ */
+static ssize_t cache_sink(void *ctx, const void *buf, size_t len)
+{
+    struct cache_capture *cap = ctx;
+
+    if (!cap->overflow && (cap->len + len > cache.max_bytes)) {
+        cap->overflow = true;
+    }
+    if (!cap->overflow && (cap->len + len > cap->cap)) {
+        size_t size = (cap->cap > 0) ? cap->cap : 256;
+        while (size < cap->len + len) {
+            size *= 2;
+        }
+        char *data = realloc(cap->data, size);
+        if (data == NULL) {
+            cap->overflow = true;
+        } else {
+            cap->data = data;
+            cap->cap = size;
+        }
+    }
+    if (!cap->overflow) {
+        memcpy(&cap->data[cap->len], buf, len);
+        cap->len += len;
+    }
+
+    return session_write(cap->to, buf, len);
+}
+
+/**
+ *  hold the output of a successful run, started at @c generation.
+ *
+ *  output dropped while the command ran is not held, it may be stale.
+ */
+static void cache_store(const struct econ_command *cmd, uint32_t hash, char *key, size_t key_len,
+                        struct cache_capture *cap, uint64_t generation)
+{
+    struct cache_entry *e = calloc(1, sizeof(*e));
+    if (e == NULL) {
+        free(key);
+        free(cap->data);
+        return;
+    }
+    e->func = cmd->func;
+    e->hash = hash;
+    e->key = key;
+    e->key_len = key_len;
+    e->data = cap->data;
+    e->len = cap->len;
+    e->expires = (cmd->ttl > 0) ? cache_now() + cmd->ttl * 1000000ULL : 0;
+    e->refs = 1;
+
+    pthread_mutex_lock(&cache.lock);
+    if (cache_generation(e->func) != generation) {
+        pthread_mutex_unlock(&cache.lock);
+        cache_release(e);
+        return;
+    }
+    /* stored by another run in the meantime. */
+    struct cache_entry *old = cache_find(e->func, hash, key, key_len);
+    if (old != NULL) {
+        cache_unlink(old);
+    }
+    e->chain = cache.buckets[hash % CACHE_BUCKETS];
+    cache.buckets[hash % CACHE_BUCKETS] = e;
+    cache_link_head(e);
+    ++cache.stats.entries;
+    cache.stats.bytes += e->len;
+    cache_trim();
+    pthread_mutex_unlock(&cache.lock);
+}
+
+int cache_call(const struct econ_command *cmd, int argc, char **argv, cache_call_fn call)
+{
+    struct econ_session *s = econ_session_current();
+    int ret;
+
+    /* output of a command reading a pipe depends on more than its words. */
+    if (!(cmd->flags & ECON_FLAG_IDEMPOTENT) || (s == NULL) || (stream_input != NULL)
+        || (cache.max_entries == 0)) {
+        ret = call(cmd, argc, argv);
+        if (cmd->flags & ECON_FLAG_INVALIDATE) {
+            econ_cache_invalidate(NULL);
+        }
+        return ret;
+    }
+
+    size_t key_len;
+    char *key = cache_key(argc, argv, &key_len);
+    if (key == NULL) {
+        return call(cmd, argc, argv);
+    }
+    uint32_t hash = cache_hash(cmd->func, key, key_len);
+    uint64_t generation = 0;
+
+    pthread_mutex_lock(&cache.lock);
+    struct cache_entry *e = cache_find(cmd->func, hash, key, key_len);
+    if ((e != NULL) && (e->expires != 0) && (cache_now() >= e->expires)) {
+        cache_unlink(e);
+        ++cache.stats.expired;
+        e = NULL;
+    }
+    if (e != NULL) {
+        ++cache.stats.hits;
+        ++e->refs;
+        if (cache.head != e) {
+            e->prev->next = e->next;
+            if (e->next != NULL) {
+                e->next->prev = e->prev;
+            } else {
+                cache.tail = e->prev;
+            }
+            cache_link_head(e);
+        }
+    } else {
+        ++cache.stats.misses;
+        generation = cache_generation(cmd->func);
+    }
+    pthread_mutex_unlock(&cache.lock);
+
+    if (e != NULL) {
+        free(key);
+        ret = (session_write(s, e->data, e->len) < 0) ? -1 : 0;
+        pthread_mutex_lock(&cache.lock);
+        cache_release(e);
+        pthread_mutex_unlock(&cache.lock);
+        return ret;
+    }
+
+    struct cache_capture cap = {.to = s};
+    struct econ_session *capture = session_alloc(-1, -1);
+    if (capture == NULL) {
+        free(key);
+        return call(cmd, argc, argv);
+    }
+    econ_session_set_output(capture, cache_sink, &cap);
+    /* line buffered, as the session of the caller. */
+    capture->invoking = 1;
+
+    struct econ_session *saved = session_switch(capture);
+    ret = call(cmd, argc, argv);
+    session_switch(saved);
+    session_flush(capture);
+    capture->invoking = 0;
+    econ_session_destroy(capture);
+
+    if ((ret == 0) && !cap.overflow) {
+        cache_store(cmd, hash, key, key_len, &cap, generation);
+    } else {
+        free(key);
+        free(cap.data);
+    }
+
+    return ret;
+}
+
+/**
+ *  @details    configure the output cache.
+ *
+ *              entries beyond the new bounds are dropped.
+ *
+ *  @param      [in]    entries most entries, 0 to stop caching.
+ *  @param      [in]    bytes   most output bytes held.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_cache_init(size_t entries, size_t bytes)
+{
+    pthread_mutex_lock(&cache.lock);
+    cache.max_entries = entries;
+    cache.max_bytes = bytes;
+    cache_trim();
+    pthread_mutex_unlock(&cache.lock);
+
+    return 0;
+}
+
+/**
+ *  @details    drop cached output.
+ *
+ *              commands flagged @ref ECON_FLAG_INVALIDATE drop all of
+ *              it when they run, a command changing a single figure
+ *              may drop only the commands showing it.
+ *
+ *  @param      [in]    func    command function, or NULL for all commands.
+ */
+void econ_cache_invalidate(int (*func)(int, char **))
+{
+    pthread_mutex_lock(&cache.lock);
+    if (func == NULL) {
+        ++cache.generation;
+    } else {
+        ++cache.generations[cache_hash(func, NULL, 0) % CACHE_BUCKETS];
+    }
+    for (struct cache_entry *e = cache.head, *next; e != NULL; e = next) {
+        next = e->next;
+        if ((func == NULL) || (e->func == func)) {
+            cache_unlink(e);
+            ++cache.stats.invalidated;
+        }
+    }
+    pthread_mutex_unlock(&cache.lock);
+}
+
+/**
+ *  @details    get output cache counters.
+ *
+ *  @param      [out]   st      counters.
+ */
+void econ_cache_get_stats(struct econ_cache_stats *st)
+{
+    pthread_mutex_lock(&cache.lock);
+    *st = cache.stats;
+    pthread_mutex_unlock(&cache.lock);
+}
+
+/**
+ *  cache command usage.
+ *
+ *  @param      [in]    name    command name.
+ */
+void econ_cache_usage(const char *name)
+{
+    econ_printf("usage: %s [clear]\r\n", name);
+}
+
+/**
+ *  cache command.
+ *
+ *  @details    without arguments, counters are printed.
+ *              "clear" drops all cached output.
+ *  @param      [in]    argc    argument count.
+ *  @param      [in]    argv    argument values.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned.
+ */
+int econ_cache_command(int argc, char **argv)
+{
+    if ((argc == 2) && (strcmp(argv[1], "clear") == 0)) {
+        econ_cache_invalidate(NULL);
+        return 0;
+    } else if (argc != 1) {
+        return -1;
+    }
+
+    struct econ_cache_stats st;
+    econ_cache_get_stats(&st);
+    econ_printf("entries %zu/%zu, bytes %zu/%zu\r\n",
+                st.entries, cache.max_entries, st.bytes, cache.max_bytes);
+    econ_printf("hits %" PRIu64 ", misses %" PRIu64 ", evictions %" PRIu64
+                ", expired %" PRIu64 ", invalidated %" PRIu64 "\r\n",
+                st.hits, st.misses, st.evictions, st.expired, st.invalidated);
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+/** @file       cache.h
+ *  @brief      Cached output of idempotent commands.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-17 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_CACHE_H__
+#define __ECON_CACHE_H__
+
+#include "econ.h"
+
+/**
+ *  entries held by default.
+ */
+#define CACHE_DEFAULT_ENTRIES (64)
+
+/**
+ *  output bytes held by default.
+ */
+#define CACHE_DEFAULT_BYTES (256 * 1024)
+
+/**
+ *  command call serving cached output.
+ */
+typedef int (*cache_call_fn)(const struct econ_command *cmd, int argc, char **argv);
+
+/**
+ *  run @c cmd by @c call, or serve its cached output.
+ *
+ *  output of an idempotent command is captured on the way to the
+ *  current session, and kept if the command succeeds.
+ */
+int cache_call(const struct econ_command *cmd, int argc, char **argv, cache_call_fn call);
+
+#endif /* __ECON_CACHE_H__ */
@@ -0,0 +1,248 @@
+/** @file       complete.c
+ *  @brief      Completion candidates.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "econ.h"
+#include "ascii.h"
+#include "complete.h"
+#include "session.h"
+
+void completion_init(struct econ_completion *comp, const char *prefix)
+{
+    memset(comp, 0, sizeof(*comp));
+    comp->prefix = prefix;
+    comp->prefix_len = strlen(prefix);
+    comp->sorted = true;
+}
+
+void completion_free(struct econ_completion *comp)
+{
+    free(comp->pool);
+    free(comp->offs);
+    free(comp->list);
+    memset(comp, 0, sizeof(*comp));
+}
+
+int completion_push(struct econ_completion *comp, const char *candidate, size_t len)
+{
+    if (comp->pool_len + len + 1 > comp->pool_cap) {
+        size_t cap = (comp->pool_cap > 0) ? comp->pool_cap : 1024;
+        while (cap < comp->pool_len + len + 1) {
+            cap *= 2;
+        }
+        char *pool = realloc(comp->pool, cap);
+        if (pool == NULL) {
+            return -1;
+        }
+        comp->pool = pool;
+        comp->pool_cap = cap;
+    }
+    if (comp->count == comp->cap) {
+        size_t cap = (comp->cap > 0) ? comp->cap * 2 : 64;
+        size_t *offs = realloc(comp->offs, sizeof(*offs) * cap);
+        if (offs == NULL) {
+            return -1;
+        }
+        comp->offs = offs;
+        comp->cap = cap;
+    }
+
+    char *p = &comp->pool[comp->pool_len];
+    memcpy(p, candidate, len);
+    p[len] = NUL;
+    if (comp->sorted && (comp->count > 0)) {
+        comp->sorted = (strcmp(&comp->pool[comp->offs[comp->count - 1]], p) < 0);
+    }
+    comp->offs[comp->count++] = comp->pool_len;
+    comp->pool_len += len + 1;
+
+    return 0;
+}
+
+/**
+ *  @details    add completion candidate.
+ *
+ *              candidates not starting with the word being completed
+ *              are ignored, so that completers may add every choice.
+ *
+ *  @param      [in]    comp        completion.
+ *  @param      [in]    candidate   candidate. (copied)
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_completion_add(struct econ_completion *comp, const char *candidate)
+{
+    if ((comp == NULL) || (candidate == NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (strncmp(candidate, comp->prefix, comp->prefix_len) != 0) {
+        return 0;
+    }
+
+    return completion_push(comp, candidate, strlen(candidate));
+}
+
+/**
+ *  candidate with its leading bytes as a sort key.
+ */
+struct sort_item {
+    uint64_t key;       /**< first 8 bytes, big endian. */
+    const char *str;    /**< candidate. */
+};
+
+/**
+ *  sort candidates by their leading bytes, then by the rest.
+ *
+ *  a byte-wise radix sort over the keys skips the bytes shared by
+ *  every candidate (which a common prefix makes likely), and only
+ *  candidates with equal leading bytes are compared as strings.
+ */
+static int sort_candidates(struct econ_completion *comp)
+{
+    size_t count = comp->count;
+    struct sort_item *items = malloc(sizeof(*items) * (count + 1) * 2);
+    if (items == NULL) {
+        return -1;
+    }
+    struct sort_item *tmp = &items[count + 1];
+    for (size_t i = 0; i < comp->count; ++i) {
+        const unsigned char *p = (const unsigned char *)comp->list[i];
+        uint64_t key = 0;
+        for (int n = 0; n < 8; ++n) {
+            key <<= 8;
+            if (*p != NUL) {
+                key |= *p++;
+            }
+        }
+        items[i].key = key;
+        items[i].str = comp->list[i];
+    }
+
+    struct sort_item *src = items, *dst = tmp;
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t pos[256] = {0};
+        for (size_t i = 0; i < count; ++i) {
+            ++pos[(src[i].key >> shift) & 0xFF];
+        }
+        if (pos[(src[0].key >> shift) & 0xFF] == count) {
+            continue;
+        }
+        size_t sum = 0;
+        for (int b = 0; b < 256; ++b) {
+            size_t n = pos[b];
+            pos[b] = sum;
+            sum += n;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            dst[pos[(src[i].key >> shift) & 0xFF]++] = src[i];
+        }
+        struct sort_item *swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    /* equal keys: insertion sort by the rest of the strings. */
+    for (size_t i = 1; i < count; ++i) {
+        struct sort_item item = src[i];
+        size_t j = i;
+        while ((j > 0) && (src[j - 1].key == item.key) && (strcmp(src[j - 1].str, item.str) > 0)) {
+            src[j] = src[j - 1];
+            --j;
+        }
+        src[j] = item;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        comp->list[i] = src[i].str;
+    }
+    free(items);
+
+    return 0;
+}
+
+ssize_t completion_finish(struct econ_completion *comp)
+{
+    free(comp->list);
+    comp->list = malloc(sizeof(*comp->list) * (comp->count + 1));
+    if (comp->list == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < comp->count; ++i) {
+        comp->list[i] = &comp->pool[comp->offs[i]];
+    }
+    if (!comp->sorted) {
+        if (sort_candidates(comp) != 0) {
+            return -1;
+        }
+
+        size_t count = 0;
+        for (size_t i = 0; i < comp->count; ++i) {
+            if ((count == 0) || (strcmp(comp->list[count - 1], comp->list[i]) != 0)) {
+                comp->list[count++] = comp->list[i];
+            }
+        }
+        comp->count = count;
+        comp->sorted = true;
+    }
+
+    comp->width = 0;
+    for (size_t i = 0; i < comp->count; ++i) {
+        size_t len = strlen(comp->list[i]);
+        if (len > comp->width) {
+            comp->width = len;
+        }
+    }
+
+    return comp->count;
+}
+
+size_t completion_common(const struct econ_completion *comp)
+{
+    if (comp->count == 0) {
+        return 0;
+    }
+
+    /* candidates are sorted, the first and the last differ the earliest. */
+    const char *first = comp->list[0];
+    const char *last = comp->list[comp->count - 1];
+    size_t len = 0;
+    while ((first[len] != NUL) && (first[len] == last[len])) {
+        ++len;
+    }
+    return len;
+}
+
+void completion_list(struct econ_session *s, const struct econ_completion *comp, size_t columns)
+{
+    size_t width = comp->width + 2;
+    size_t cols = (columns > width) ? columns / width : 1;
+    size_t rows = (comp->count + cols - 1) / cols;
+
+    session_write(s, "\r\n", 2);
+    for (size_t row = 0; row < rows; ++row) {
+        for (size_t col = 0; col < cols; ++col) {
+            size_t idx = col * rows + row;
+            if (idx >= comp->count) {
+                break;
+            }
+            bool last = (col + 1 == cols) || (idx + rows >= comp->count);
+            if (last) {
+                session_printf(s, "%s", comp->list[idx]);
+            } else {
+                session_printf(s, "%-*s", (int)width, comp->list[idx]);
+            }
+        }
+        session_write(s, "\r\n", 2);
+    }
+}
@@ -0,0 +1,72 @@
+/** @file       complete.h
+ *  @brief      Completion candidates.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_COMPLETE_H__
+#define __ECON_COMPLETE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "econ.h"
+
+struct econ_session;
+
+/**
+ *  completion candidates.
+ *
+ *  candidates are copied into one pool, so that completers
+ *  may add strings they do not keep.
+ */
+struct econ_completion {
+    const char *prefix;     /**< word being completed. */
+    size_t prefix_len;      /**< length of @c prefix. */
+    char *pool;             /**< candidate strings. */
+    size_t pool_len;        /**< used length of @c pool. */
+    size_t pool_cap;        /**< allocated length of @c pool. */
+    size_t *offs;           /**< candidate offsets in @c pool. */
+    size_t count;           /**< number of candidates. */
+    size_t cap;             /**< allocated offsets. */
+    bool sorted;            /**< candidates were added in order. */
+    const char **list;      /**< sorted unique candidates, after completion_finish(). */
+    size_t width;           /**< longest candidate, after completion_finish(). */
+};
+
+/**
+ *  start collecting candidates of @c prefix.
+ */
+void completion_init(struct econ_completion *comp, const char *prefix);
+
+/**
+ *  release candidates.
+ */
+void completion_free(struct econ_completion *comp);
+
+/**
+ *  add @c len bytes of @c candidate known to match the prefix.
+ */
+int completion_push(struct econ_completion *comp, const char *candidate, size_t len);
+
+/**
+ *  sort and unify candidates.
+ *
+ *  returns number of candidates, or -1 on error.
+ */
+ssize_t completion_finish(struct econ_completion *comp);
+
+/**
+ *  get length of the prefix common to all candidates.
+ */
+size_t completion_common(const struct econ_completion *comp);
+
+/**
+ *  print candidates in columns fitting @c columns.
+ */
+void completion_list(struct econ_session *s, const struct econ_completion *comp, size_t columns);
+
+#endif /* __ECON_COMPLETE_H__ */
@@ -10,15 +10,13 @@
 #ifndef __ECON_DEBUG_H__
 #define __ECON_DEBUG_H__
 
-#if NODEBUG != 1
-#define DEBUG(fmt, ...)                          \
-    do {                                         \
-        fprintf(stderr, "D:%s:%d:%s$ " fmt "\r\n", \
-                __FILE__, __LINE__, __func__,    \
-                ##__VA_ARGS__);                  \
-    } while (0)
-#else
-#define DEBUG(fmt, ...)
-#endif
+#include "econ.h"
+
+/**
+ *  record a debug log event.
+ *
+ *  compiled out with NODEBUG=1.
+ */
+#define DEBUG(fmt, ...) econ_log_debug(fmt, ##__VA_ARGS__)
 
 #endif /* __ECON_DEBUG_H__ */
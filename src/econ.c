@@ -7,6 +7,7 @@
  *
  *  This code is licensed under the MIT License.
  */
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -15,210 +16,1960 @@
 #include <unistd.h>
 #include <string.h>
 #include <fcntl.h>
+#include <stdarg.h>
 #include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <termios.h>
 #include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
 
 #include "econ.h"
+#include "session.h"
 #include "ascii.h"
+#include "args.h"
+#include "cache.h"
+#include "complete.h"
+#include "jobs.h"
+#include "keys.h"
+#include "line.h"
+#include "registry.h"
+#include "stats.h"
+#include "stream.h"
+#include "suggest.h"
+#include "timer.h"
+#include "token.h"
+#include "watch.h"
 #include "debug.h"
 #include "utils.h"
 
-FILE *logger = NULL;
+/**
+ *  session used by econ_prompt().
+ */
+static _Atomic(struct econ_session *) default_session = NULL;
+
+/**
+ *  lock creating and destroying @ref default_session.
+ */
+static pthread_mutex_t default_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ *  this thread used @ref default_session, its output goes there.
+ */
+static _Thread_local bool default_user = false;
+
+/**
+ *  session of the command running on this thread.
+ */
+static _Thread_local struct econ_session *current_session = NULL;
+
+/**
+ *  command list of the line running on this thread.
+ */
+static _Thread_local struct econ_command *current_cmds = NULL;
+
+/**
+ *  write whole buffer to @c fd.
+ *
+ *  non-blocking fd is waited for writable.
+ */
+static ssize_t fd_write(int fd, const void *buf, size_t len)
+{
+    const char *p = buf;
+    size_t remain = len;
+
+    if (fd == STDOUT_FILENO) {
+        /* keep order with commands that still use stdio. */
+        fflush(stdout);
+    }
+    while (remain > 0) {
+        ssize_t written = write(fd, p, remain);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                struct pollfd pfd = {.fd = fd, .events = POLLOUT};
+                poll(&pfd, 1, -1);
+                continue;
+            }
+            return -1;
+        }
+        p += written;
+        remain -= written;
+    }
+
+    return len;
+}
+
+/**
+ *  default output sink, writes to session output fd.
+ *
+ *  with an output limit, writes only what the fd takes now,
+ *  the rest stays queued.
+ */
+static ssize_t fd_output(void *ctx, const void *buf, size_t len)
+{
+    struct econ_session *s = ctx;
+
+    if (s->out_limit == 0) {
+        return fd_write(s->out_fd, buf, len);
+    }
+    if (s->out_fd == STDOUT_FILENO) {
+        fflush(stdout);
+    }
+    for (;;) {
+        ssize_t written = write(s->out_fd, buf, len);
+        if (written >= 0) {
+            return written;
+        } else if (errno == EINTR) {
+            continue;
+        } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return 0;
+        }
+        return -1;
+    }
+}
+
+static void session_limit(struct econ_session *s, size_t from);
+
+/**
+ *  make room for @c len more bytes in the output buffer.
+ */
+static char *session_reserve(struct econ_session *s, size_t len)
+{
+    if ((s->capture != NULL) && (s->out_len > 0) && (s->out_len + len > s->out_cap)) {
+        /* hand the full buffer over rather than growing it. */
+        session_flush(s);
+    }
+    if (s->out_len + len > s->out_cap) {
+        if (s->out_pos > 0) {
+            memmove(s->out, &s->out[s->out_pos], s->out_len - s->out_pos);
+            s->out_len -= s->out_pos;
+            s->out_pos = 0;
+        }
+        if (s->out_len + len > s->out_cap) {
+            size_t cap = (s->out_cap > 0) ? s->out_cap
+                       : (s->capture != NULL) ? SESSION_FLUSH_THRESHOLD : 1024;
+            while (cap < s->out_len + len) {
+                cap *= 2;
+            }
+            char *out = realloc(s->out, cap);
+            if (out == NULL) {
+                return NULL;
+            }
+            s->out = out;
+            s->out_cap = cap;
+        }
+    }
+
+    return &s->out[s->out_len];
+}
+
+/**
+ *  flush automatically after appending @c len bytes at @c data.
+ *
+ *  command output is line buffered, like stdio on a terminal,
+ *  and large bursts are written out before they grow further.
+ */
+static void session_commit(struct econ_session *s, const char *data, size_t len)
+{
+    s->out_len += len;
+    if (s->capture != NULL) {
+        return;
+    }
+    bool eol = (s->invoking > 0) && (memchr(data, LF, len) != NULL);
+    if ((s->invoking > 0) && (s->out_limit > 0)
+        && (!s->deferred || (s->out_policy == ECON_OUTPUT_DROP))) {
+        /* may move the buffer. a deferred one waits for its owner, only dropping bounds it. */
+        session_limit(s, s->out_len - len);
+    }
+    if (s->deferred) {
+        return;
+    }
+    if (eol || (s->out_len - s->out_pos >= SESSION_FLUSH_THRESHOLD)) {
+        session_flush(s);
+    }
+}
+
+ssize_t session_write(struct econ_session *s, const void *buf, size_t len)
+{
+    char *p = session_reserve(s, len);
+    if (p == NULL) {
+        return -1;
+    }
+    memcpy(p, buf, len);
+    session_commit(s, p, len);
+
+    return len;
+}
+
+int session_flush(struct econ_session *s)
+{
+    if (s->capture != NULL) {
+        if (s->out_len > s->out_pos) {
+            if (stream_append_buffer(s->capture, s->out, s->out_pos, s->out_len - s->out_pos) != 0) {
+                return -1;
+            }
+            s->out = NULL;
+            s->out_cap = 0;
+        }
+        s->out_pos = s->out_len = 0;
+        return 0;
+    }
+    if (s->xoff) {
+        /* held until DC1. */
+        return 0;
+    }
+    while (s->out_pos < s->out_len) {
+        ssize_t written = s->output(s->output_ctx, &s->out[s->out_pos], s->out_len - s->out_pos);
+        ++s->stats.writes;
+        if (written < 0) {
+            s->out_pos = s->out_len = 0;
+            return -1;
+        } else if (written == 0) {
+            /* sink is not writable now, keep the rest. */
+            return 0;
+        }
+        s->out_pos += written;
+        s->stats.out_bytes += written;
+    }
+    s->out_pos = s->out_len = 0;
+
+    return 0;
+}
+
+static int session_vprintf(struct econ_session *s, const char *format, va_list ap)
+{
+    va_list aq;
+
+    if (s == NULL) {
+        char tmp[256];
+        char *buf = tmp;
+
+        va_copy(aq, ap);
+        int len = vsnprintf(tmp, sizeof(tmp), format, aq);
+        va_end(aq);
+        if (len >= (int)sizeof(tmp)) {
+            buf = malloc(len + 1);
+            if (buf == NULL) {
+                return -1;
+            }
+            vsnprintf(buf, len + 1, format, ap);
+        }
+        ssize_t ret = (len < 0) ? -1 : fd_write(STDOUT_FILENO, buf, len);
+        if (buf != tmp) {
+            free(buf);
+        }
+        return (ret < 0) ? -1 : len;
+    }
+
+    /* format straight into the output buffer. */
+    size_t room = 256;
+    for (;;) {
+        char *p = session_reserve(s, room);
+        if (p == NULL) {
+            return -1;
+        }
+        va_copy(aq, ap);
+        int len = vsnprintf(p, room, format, aq);
+        va_end(aq);
+        if (len < 0) {
+            return -1;
+        } else if (len < (int)room) {
+            session_commit(s, p, len);
+            return len;
+        }
+        room = len + 1;
+    }
+}
+
+int session_printf(struct econ_session *s, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    int ret = session_vprintf(s, format, ap);
+    va_end(ap);
+
+    return ret;
+}
+
+/**
+ *  get monotonic time in milliseconds.
+ */
+static uint64_t session_ms(void)
+{
+    return stats_now() / 1000000;
+}
+
+/**
+ *  take flow control keys, and ETX while output waits,
+ *  out of @c len bytes just read into the input ring.
+ */
+static void session_filter(struct econ_session *s, size_t len)
+{
+    size_t to = s->in_tail;
+
+    for (size_t from = s->in_tail; from < s->in_tail + len; ++from) {
+        char c = s->in[from % sizeof(s->in)];
+
+        if ((s->flow & ECON_FLOW_XONXOFF) && ((c == DC1) || (c == DC3))) {
+            s->xoff = (c == DC3);
+        } else if (s->draining && (c == ETX)) {
+            s->interrupted = true;
+        } else {
+            s->in[to++ % sizeof(s->in)] = c;
+        }
+    }
+    s->in_tail = to;
+}
+
+/**
+ *  read available input into the input ring.
+ *
+ *  @return     returns read length.
+ *              if no input is available or input reached end of file, 0 returned.
+ */
+static size_t session_fill(struct econ_session *s)
+{
+    size_t used = s->in_tail - s->in_head;
+    size_t room = sizeof(s->in) - used;
+    size_t tail = s->in_tail % sizeof(s->in);
+    struct iovec iov[2];
+    int iovcnt = 1;
+    ssize_t len;
+
+    if (room == 0) {
+        return 0;
+    }
+    iov[0].iov_base = &s->in[tail];
+    iov[0].iov_len = sizeof(s->in) - tail;
+    if (iov[0].iov_len >= room) {
+        iov[0].iov_len = room;
+    } else {
+        iov[1].iov_base = s->in;
+        iov[1].iov_len = room - iov[0].iov_len;
+        iovcnt = 2;
+    }
+
+    do {
+        len = readv(s->in_fd, iov, iovcnt);
+    } while ((len < 0) && (errno == EINTR));
+    ++s->stats.reads;
+    if (len <= 0) {
+        s->eof = s->eof || (len == 0);
+        return 0;
+    }
+    s->stats.in_bytes += len;
+    s->in_ms = session_ms();
+    if ((s->flow & ECON_FLOW_XONXOFF) || s->draining) {
+        session_filter(s, len);
+    } else {
+        s->in_tail += len;
+    }
+
+    return len;
+}
+
+size_t session_rows(struct econ_session *s)
+{
+    struct winsize ws;
+
+    if ((ioctl(s->out_fd, TIOCGWINSZ, &ws) == 0) && (ws.ws_row > 2)) {
+        return ws.ws_row;
+    }
+    return SESSION_DEFAULT_ROWS;
+}
+
+/**
+ *  drop queued output.
+ */
+static void session_discard(struct econ_session *s)
+{
+    s->stats.dropped += s->out_len - s->out_pos;
+    s->out_pos = s->out_len = 0;
+}
+
+/**
+ *  wait for room in the output fd, or for keys.
+ *
+ *  keys are read into the input ring, so that flow control keys
+ *  and ETX take effect while the output waits.
+ *
+ *  @param      [in]    s       session.
+ *  @param      [in]    out     wait for room too.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ *              @c EAGAIN is set when nothing can end the wait.
+ */
+static int session_wait(struct econ_session *s, bool out)
+{
+    struct pollfd pfds[2];
+    nfds_t n = 0;
+
+    if (out && !s->xoff && (s->output == fd_output) && (s->out_fd >= 0)) {
+        pfds[n++] = (struct pollfd){.fd = s->out_fd, .events = POLLOUT};
+    }
+    bool in = (s->in_fd >= 0) && !s->eof && (s->in_tail - s->in_head < sizeof(s->in));
+    if (in) {
+        pfds[n++] = (struct pollfd){.fd = s->in_fd, .events = POLLIN};
+    }
+    if (n == 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    ++s->stats.stalls;
+    /* a lone ESC is reported when it times out. */
+    int timeout = (in) ? key_timeout(&s->dec, session_ms()) : -1;
+    if (poll(pfds, n, timeout) < 0) {
+        return (errno == EINTR) ? 0 : -1;
+    }
+    if (in && (pfds[n - 1].revents != 0)) {
+        s->draining = true;
+        if ((session_fill(s) == 0) && (pfds[n - 1].revents & (POLLHUP | POLLERR))) {
+            s->eof = true;
+        }
+        s->draining = false;
+    }
+
+    return 0;
+}
+
+/**
+ *  flush until at most @c below bytes stay queued.
+ *
+ *  output is dropped once ETX is typed.
+ *
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+static int session_drain(struct econ_session *s, size_t below)
+{
+    if (s->out_limit == 0) {
+        return session_flush(s);
+    }
+    for (;;) {
+        if (session_flush(s) != 0) {
+            return -1;
+        }
+        if (s->interrupted) {
+            session_discard(s);
+            return 0;
+        } else if (s->out_len - s->out_pos <= below) {
+            return 0;
+        } else if (session_wait(s, true) != 0) {
+            return -1;
+        }
+    }
+}
+
+/**
+ *  decode the next key of the input ring.
+ *
+ *  a lone ESC is reported before a byte which came too late to follow
+ *  it, or once it has waited long enough.
+ *
+ *  @return     returns the key.
+ *              if the ring holds no whole key, KEY_NONE is returned.
+ */
+static int session_decode(struct econ_session *s)
+{
+    while (s->in_head != s->in_tail) {
+        int key = key_expire(&s->dec, s->in_ms);
+        if (key == KEY_NONE) {
+            key = key_decode(&s->dec, s->in[s->in_head++ % sizeof(s->in)], s->in_ms);
+        }
+        if (key != KEY_NONE) {
+            return key;
+        }
+    }
+    return key_expire(&s->dec, session_ms());
+}
+
+/**
+ *  wait for a key.
+ *
+ *  @return     returns the key.
+ *              if none can come, or ETX is typed, -1 is returned.
+ */
+static int session_key(struct econ_session *s)
+{
+    for (;;) {
+        int key = session_decode(s);
+        if (key != KEY_NONE) {
+            return key;
+        }
+        if (s->interrupted || (session_wait(s, false) != 0)) {
+            return -1;
+        }
+    }
+}
+
+/**
+ *  append @c len bytes without applying the output policy.
+ */
+static void session_put(struct econ_session *s, const char *data, size_t len)
+{
+    char *p = session_reserve(s, len);
+    if (p != NULL) {
+        memcpy(p, data, len);
+        s->out_len += len;
+    }
+}
+
+/**
+ *  show --More-- after a full page, and wait for a key.
+ *
+ *  space shows the next page, CR one more line,
+ *  'q' or ETX drops the rest of the command output.
+ */
+static void session_more(struct econ_session *s)
+{
+    static const char more[] = "--More--";
+    static const char erase[] = "\r\033[K";
+
+    session_put(s, more, sizeof(more) - 1);
+    session_drain(s, 0);
+    int key = session_key(s);
+    session_put(s, erase, sizeof(erase) - 1);
+    if (key == 'q') {
+        s->interrupted = true;
+    } else if ((key == CR) || (key == LF)) {
+        s->page_lines = s->page_rows - 2;
+    } else {
+        /* also when no key can come. */
+        s->page_lines = 0;
+    }
+    if (s->interrupted) {
+        session_flush(s);
+        session_discard(s);
+    }
+}
+
+size_t session_page_fill(struct econ_session *s, const char *data, size_t len)
+{
+    const char *end = data + len;
+
+    for (const char *p = data; (p = memchr(p, LF, end - p)) != NULL;) {
+        ++p;
+        if (++s->page_lines >= s->page_rows - 1) {
+            return p - data;
+        }
+    }
+    return len;
+}
+
+bool session_page_full(const struct econ_session *s)
+{
+    return s->page_lines >= s->page_rows - 1;
+}
+
+/**
+ *  stop at every page of command output appended from @c from.
+ */
+static void session_page(struct econ_session *s, size_t from)
+{
+    while (from < s->out_len) {
+        from += session_page_fill(s, &s->out[from], s->out_len - from);
+        if (!session_page_full(s)) {
+            break;
+        }
+
+        /* out to the end of the page, the rest waits for the key. */
+        size_t rest_len = s->out_len - from;
+        char *rest = NULL;
+        if (rest_len > 0) {
+            if ((rest = malloc(rest_len)) == NULL) {
+                break;
+            }
+            memcpy(rest, &s->out[from], rest_len);
+        }
+        s->out_len = from;
+        session_more(s);
+        if (s->interrupted) {
+            s->stats.dropped += rest_len;
+        } else {
+            from = s->out_len;
+            if (rest_len > 0) {
+                session_put(s, rest, rest_len);
+            }
+        }
+        free(rest);
+    }
+}
+
+/**
+ *  apply the output policy to command output appended from @c from.
+ */
+static void session_limit(struct econ_session *s, size_t from)
+{
+    if (s->interrupted) {
+        /* the rest of the command output is not wanted. */
+        s->stats.dropped += s->out_len - from;
+        s->out_len = from;
+        return;
+    }
+    if (s->out_policy == ECON_OUTPUT_MORE) {
+        session_page(s, from);
+    }
+
+    size_t queued = s->out_len - s->out_pos;
+    if ((queued > s->out_limit) && (s->out_policy == ECON_OUTPUT_DROP)) {
+        /* what the sink takes now is not dropped. */
+        session_flush(s);
+        queued = s->out_len - s->out_pos;
+    }
+    if (queued <= s->out_limit) {
+        return;
+    }
+    if (s->out_policy == ECON_OUTPUT_DROP) {
+        s->stats.dropped += queued - s->out_limit;
+        s->dropped += queued - s->out_limit;
+        s->out_len = s->out_pos + s->out_limit;
+    } else {
+        /* down to half, not to wake for every line. */
+        session_drain(s, s->out_limit / 2);
+    }
+}
+
+/**
+ *  watch the output fd for room while output is queued.
+ */
+static void session_watch(struct econ_session *s)
+{
+    bool want = (s->out_len > s->out_pos) && !s->xoff && (s->output == fd_output)
+                && (s->out_limit > 0) && (s->out_fd >= 0) && (s->epfd >= 0);
+    struct epoll_event ev;
+    int ret;
+
+    if (want == s->want_out) {
+        return;
+    }
+    if (s->out_fd == s->in_fd) {
+        ev.events = EPOLLIN | EPOLLET | ((want) ? EPOLLOUT : 0);
+        ev.data.fd = s->in_fd;
+        ret = epoll_ctl(s->epfd, EPOLL_CTL_MOD, s->in_fd, &ev);
+    } else {
+        ev.events = EPOLLOUT;
+        ev.data.fd = s->out_fd;
+        ret = epoll_ctl(s->epfd, (want) ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, s->out_fd, &ev);
+    }
+    if (ret == 0) {
+        s->want_out = want;
+    }
+}
+
+/**
+ *  move cursor to @c pos with the fewest bytes.
+ */
+static void session_move(struct econ_session *s, size_t pos)
+{
+    struct line_buffer *lb = &s->edit;
+    size_t cursor = line_cursor(lb);
+
+    if (pos > line_length(lb)) {
+        pos = line_length(lb);
+    }
+    if (pos + 1 == cursor) {
+        session_write(s, "\b", 1);
+    } else if (pos < cursor) {
+        session_printf(s, "\033[%zuD", cursor - pos);
+    } else if (pos > cursor + 3) {
+        session_printf(s, "\033[%zuC", pos - cursor);
+    } else if (pos > cursor) {
+        /* re-echo is shorter than a cursor sequence. */
+        session_write(s, line_tail(lb), pos - cursor);
+    }
+    line_move(lb, pos);
+}
+
+/**
+ *  replace the edit line with @c text.
+ *
+ *  the screen cursor must be at the start of the line.
+ */
+static void session_rewrite(struct econ_session *s, const char *text, size_t len)
+{
+    line_clear(&s->edit);
+    if (line_insert(&s->edit, text, len) == 0) {
+        session_write(s, text, len);
+    }
+    session_write(s, "\033[K", 3);
+}
+
+/**
+ *  redraw prompt and the whole edit line.
+ */
+static void session_redraw(struct econ_session *s)
+{
+    char *text = line_text(&s->edit);
+
+    session_printf(s, "\r%s %s\033[K", s->prompt, (text) ?: "");
+}
+
+/**
+ *  insert @c len bytes at the cursor and echo them.
+ */
+static void session_insert(struct econ_session *s, const char *text, size_t len)
+{
+    struct line_buffer *lb = &s->edit;
+
+    if (line_length(lb) + len > SESSION_LINE_MAX) {
+        session_write(s, "\a", 1);
+        return;
+    }
+    if (line_cursor(lb) != line_length(lb)) {
+        if (len == 1) {
+            session_write(s, "\033[@", 3);
+        } else {
+            session_printf(s, "\033[%zu@", len);
+        }
+    }
+    if (line_insert(lb, text, len) == 0) {
+        session_write(s, text, len);
+    }
+}
+
+size_t session_columns(struct econ_session *s)
+{
+    struct winsize ws;
+
+    if ((ioctl(s->out_fd, TIOCGWINSZ, &ws) == 0) && (ws.ws_col > 0)) {
+        return ws.ws_col;
+    }
+    return SESSION_DEFAULT_COLUMNS;
+}
+
+/**
+ *  complete the word before the cursor.
+ *
+ *  the common part of candidates is inserted,
+ *  candidates are listed by the second TAB in a row.
+ *
+ *  @param      [in]    s       session.
+ *  @param      [in]    again   previous key was also TAB.
+ */
+static void session_complete(struct econ_session *s, bool again)
+{
+    struct line_buffer *lb = &s->edit;
+    size_t cursor = line_cursor(lb);
+    char *argv[SESSION_COMPLETE_ARGS];
+    struct econ_completion comp;
+
+    if (s->registry == NULL) {
+        session_write(s, "\a", 1);
+        return;
+    }
+
+    /* text before the cursor is contiguous at the head of the gap buffer. */
+    char *text = malloc(cursor + 2);
+    if (text == NULL) {
+        return;
+    }
+    memcpy(text, lb->buf, cursor);
+    text[cursor] = NUL;
+    bool open;
+    int argc = token_split(text, cursor, argv, lengthof(argv) - 1, &open);
+    if (argc < 0) {
+        session_write(s, "\a", 1);
+        free(text);
+        return;
+    }
+    if (!open) {
+        text[cursor + 1] = NUL;
+        argv[argc++] = &text[cursor + 1];
+    }
+    /* complete the last command of a pipeline. */
+    int first = argc - 1;
+    while ((first > 0) && (argv[first - 1] != token_pipe)) {
+        --first;
+    }
+
+    completion_init(&comp, argv[argc - 1]);
+    if ((econ_registry_complete(s->registry, argc - first, &argv[first], &comp) != 0)
+        || (completion_finish(&comp) <= 0)) {
+        session_write(s, "\a", 1);
+    } else {
+        size_t common = completion_common(&comp);
+
+        if (common > comp.prefix_len) {
+            session_insert(s, &comp.list[0][comp.prefix_len], common - comp.prefix_len);
+        }
+        if (comp.count == 1) {
+            if ((line_cursor(lb) == line_length(lb)) || (line_at(lb, line_cursor(lb)) != SP)) {
+                session_insert(s, " ", 1);
+            }
+        } else if (common == comp.prefix_len) {
+            if (again) {
+                size_t pos = line_cursor(lb);
+                completion_list(s, &comp, session_columns(s));
+                session_redraw(s);
+                session_move(s, pos);
+            } else {
+                session_write(s, "\a", 1);
+            }
+        }
+    }
+    completion_free(&comp);
+    free(text);
+}
+
+/**
+ *  copy history entry @c seq into the scratch buffer.
+ *
+ *  @return     returns entry length on success.
+ *              on error, -1 is returned.
+ */
+static ssize_t session_fetch(struct econ_session *s, int64_t seq)
+{
+    for (;;) {
+        ssize_t len = econ_history_get(s->history, seq, s->hist_buf, s->hist_size);
+        if ((len < 0) || ((size_t)len < s->hist_size)) {
+            return len;
+        }
+        char *buf = realloc(s->hist_buf, len + 1);
+        if (buf == NULL) {
+            return -1;
+        }
+        s->hist_buf = buf;
+        s->hist_size = len + 1;
+    }
+}
+
+/**
+ *  recall older (@c dir < 0) or newer (@c dir > 0) history entry.
+ */
+static void session_recall(struct econ_session *s, int dir)
+{
+    int64_t first, last, pos;
+
+    if ((s->history == NULL) || (econ_history_range(s->history, &first, &last) == 0)) {
+        return;
+    }
+    if (s->hist_pos < 0) {
+        if (dir > 0) {
+            return;
+        }
+        pos = last;
+    } else {
+        pos = s->hist_pos + dir;
+        if (pos < first) {
+            session_write(s, "\a", 1);
+            return;
+        }
+    }
+
+    session_move(s, 0);
+    if (s->hist_pos < 0) {
+        /* keep the line being typed, it comes back below the newest entry. */
+        char *text = line_text(&s->edit);
+        size_t len = line_length(&s->edit);
+        char *saved = realloc(s->hist_saved, len + 1);
+        if ((text == NULL) || (saved == NULL)) {
+            return;
+        }
+        memcpy(saved, text, len + 1);
+        s->hist_saved = saved;
+        s->hist_saved_len = len;
+    }
+
+    ssize_t len;
+    if (pos > last) {
+        session_rewrite(s, s->hist_saved, s->hist_saved_len);
+        s->hist_pos = -1;
+    } else if ((len = session_fetch(s, pos)) >= 0) {
+        session_rewrite(s, s->hist_buf, len);
+        s->hist_pos = pos;
+    } else {
+        session_redraw(s);
+    }
+}
+
+/**
+ *  show reverse-i-search state.
+ */
+static void session_search_show(struct econ_session *s)
+{
+    session_printf(s, "\r(%sreverse-i-search)'%.*s': %s\033[K",
+                   s->search_failed ? "failed " : "", (int)s->query_len, s->query,
+                   (s->match >= 0) ? s->hist_buf : "");
+}
+
+/**
+ *  search the query at or before @c from.
+ *
+ *  with @c skip_same, entries equal to the current match are passed over.
+ */
+static void session_search(struct econ_session *s, int64_t from, bool skip_same)
+{
+    char *current = NULL;
+    int64_t first = 0;
+    int64_t found;
+
+    s->query[s->query_len] = NUL;
+    if (skip_same && (s->match >= 0)) {
+        size_t len = strlen(s->hist_buf) + 1;
+        current = malloc(len);
+        if (current != NULL) {
+            memcpy(current, s->hist_buf, len);
+        }
+    }
+    econ_history_range(s->history, &first, NULL);
+    while (1) {
+        found = econ_history_search(s->history, s->query, from);
+        s->search_failed = (found < 0) || (session_fetch(s, found) < 0);
+        if (s->search_failed || (current == NULL) || (strcmp(current, s->hist_buf) != 0)) {
+            break;
+        }
+        /* -1 would wrap to the newest. */
+        from = found - 1;
+        if (from < first) {
+            s->search_failed = true;
+            break;
+        }
+    }
+
+    if (!s->search_failed) {
+        s->match = found;
+    } else if (current != NULL) {
+        strcpy(s->hist_buf, current);
+    }
+    free(current);
+    session_search_show(s);
+}
+
+/**
+ *  handle one key of reverse-i-search.
+ *
+ *  @return     returns true if the key is consumed.
+ */
+static bool session_search_input(struct econ_session *s, int key)
+{
+    switch (key) {
+    case DC2: /* ^R, older match */
+        if (s->match >= 0) {
+            int64_t first = 0;
+            econ_history_range(s->history, &first, NULL);
+            if (s->match - 1 < first) {
+                /* the match is the oldest, -1 would wrap to the newest. */
+                s->search_failed = true;
+                session_write(s, "\a", 1);
+                session_search_show(s);
+                return true;
+            }
+        }
+        session_search(s, (s->match >= 0) ? s->match - 1 : -1, true);
+        return true;
+    case BS:
+    case DEL:
+        if (s->query_len > 0) {
+            --s->query_len;
+        }
+        s->match = -1;
+        session_search(s, -1, false);
+        return true;
+    case BEL: /* ^G, cancel */
+        s->searching = false;
+        session_redraw(s);
+        return true;
+    default:
+        if ((SP <= key) && (key < DEL)) {
+            if (s->query_len < sizeof(s->query) - 1) {
+                s->query[s->query_len++] = key;
+            }
+            session_search(s, s->match, false);
+            return true;
+        }
+        break;
+    }
+
+    /* any other key accepts the match and is handled as usual. */
+    s->searching = false;
+    if (s->match >= 0) {
+        line_clear(&s->edit);
+        line_insert(&s->edit, s->hist_buf, strlen(s->hist_buf));
+    }
+    session_redraw(s);
+
+    return false;
+}
+
+/**
+ *  handle one key of line editing.
+ *
+ *  every edit costs a few bytes on the wire, the line is never redrawn:
+ *  inserting in the middle uses ICH, deleting uses DCH.
+ *
+ *  @param      [in]    s       session.
+ *  @param      [in]    key     decoded key.
+ *  @return     returns true if the line is terminated.
+ */
+static bool session_input(struct econ_session *s, int key)
+{
+    struct line_buffer *lb = &s->edit;
+    int c = key;
+    bool tabbed = s->tabbed;
+
+    ++s->stats.keys;
+    s->tabbed = (key == TAB);
+    if (s->searching && session_search_input(s, key)) {
+        return false;
+    }
+    if ((c == LF) && s->cr) {
+        /* second half of CR LF. */
+        s->cr = false;
+        return false;
+    }
+    s->cr = (c == CR);
+    if (c == CR) {
+        c = LF;
+    }
+    if (c == LF) {
+        session_write(s, "\r\n", 2);
+        if (s->history != NULL) {
+            char *text = line_text(lb);
+            if (text != NULL) {
+                econ_history_add(s->history, text);
+            }
+        }
+        return true;
+    }
+
+    if ((SP <= c) && (c < DEL)) {
+        char ch = c;
+
+        session_insert(s, &ch, 1);
+        return false;
+    }
+
+    size_t cursor = line_cursor(lb);
+    switch (c) {
+    case TAB:
+        session_complete(s, tabbed);
+        break;
+    case KEY_DELETE:
+        if (line_delete_after(lb)) {
+            session_write(s, "\033[P", 3);
+        }
+        break;
+    case KEY_UP:
+        session_recall(s, -1);
+        break;
+    case KEY_DOWN:
+        session_recall(s, 1);
+        break;
+    case DC2: /* ^R */
+        if (s->history != NULL) {
+            s->searching = true;
+            s->search_failed = false;
+            s->query_len = 0;
+            s->match = -1;
+            session_search_show(s);
+        }
+        break;
+    case KEY_RIGHT:
+        session_move(s, cursor + 1);
+        break;
+    case KEY_LEFT:
+        if (cursor > 0) {
+            session_move(s, cursor - 1);
+        }
+        break;
+    case KEY_RIGHT | KEY_CTRL:
+    case KEY_RIGHT | KEY_ALT: {
+        size_t pos = cursor, length = line_length(lb);
+        while ((pos < length) && (line_at(lb, pos) == SP)) {
+            ++pos;
+        }
+        while ((pos < length) && (line_at(lb, pos) != SP)) {
+            ++pos;
+        }
+        session_move(s, pos);
+        break;
+    }
+    case KEY_LEFT | KEY_CTRL:
+    case KEY_LEFT | KEY_ALT: {
+        size_t pos = cursor;
+        while ((pos > 0) && (line_at(lb, pos - 1) == SP)) {
+            --pos;
+        }
+        while ((pos > 0) && (line_at(lb, pos - 1) != SP)) {
+            --pos;
+        }
+        session_move(s, pos);
+        break;
+    }
+    case KEY_HOME:
+        session_move(s, 0);
+        break;
+    case KEY_END:
+        session_move(s, line_length(lb));
+        break;
+    case BS:
+    case DEL: /* backspace */
+        if (line_delete_before(lb)) {
+            session_write(s, "\b\033[P", 4);
+        }
+        break;
+    default:
+        break;
+    }
+
+    return false;
+}
+
+struct econ_session *session_alloc(int in_fd, int out_fd)
+{
+    struct econ_session *s = calloc(1, sizeof(*s));
+    if (s == NULL) {
+        return NULL;
+    }
+    s->in_fd = in_fd;
+    s->out_fd = out_fd;
+    s->epfd = -1;
+    s->notify_fd = -1;
+    s->hist_pos = -1;
+    s->match = -1;
+    key_decoder_init(&s->dec);
+    s->output = fd_output;
+    s->output_ctx = s;
+
+    if (in_fd >= 0) {
+        int val = fcntl(in_fd, F_GETFL, 0);
+        if ((val & O_NONBLOCK) == 0) {
+            fcntl(in_fd, F_SETFL, val | O_NONBLOCK);
+        }
+    }
+
+    return s;
+}
+
+/**
+ *  @details    create a console session on @c in_fd and @c out_fd.
+ *
+ *              @c in_fd and @c out_fd are switched to non-blocking mode.
+ *              output of commands is queued up to 64 KiB, and commands
+ *              wait for room beyond, see econ_session_set_flow().
+ *              the session does not close @c in_fd and @c out_fd.
+ *
+ *  @param      [in]    in_fd   input fd.
+ *  @param      [in]    out_fd  output fd.
+ *  @return     returns session on success.
+ *              on error, NULL is returned, and @c errno set.
+ */
+struct econ_session *econ_session_create(int in_fd, int out_fd)
+{
+    struct econ_session *s = session_alloc(in_fd, out_fd);
+    if (s == NULL) {
+        return NULL;
+    }
+
+    s->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (s->epfd < 0) {
+        perror("epoll_create1");
+        free(s);
+        return NULL;
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = in_fd;
+    if (epoll_ctl(s->epfd, EPOLL_CTL_ADD, ev.data.fd, &ev) != 0) {
+        int saved = errno;
+        perror("epoll_ctl");
+        close(s->epfd);
+        free(s);
+        errno = saved;
+        return NULL;
+    }
+    struct econ_output_config config = {
+        .limit = SESSION_OUTPUT_LIMIT,
+        .policy = ECON_OUTPUT_BLOCK,
+        .flow = 0,
+    };
+    econ_session_set_flow(s, &config);
+
+    return s;
+}
+
+/**
+ *  @details    destroy the session.
+ *
+ *  @param      [in]    s       session.
+ */
+void econ_session_destroy(struct econ_session *s)
+{
+    if (s == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&default_lock);
+    if (atomic_load(&default_session) == s) {
+        atomic_store(&default_session, NULL);
+    }
+    pthread_mutex_unlock(&default_lock);
+    if (s->out_limit > 0) {
+        /* a paused terminal would keep it forever. */
+        s->xoff = false;
+        session_drain(s, 0);
+    }
+    session_jobs_release(s);
+    watch_release(s);
+    session_timers_release(s);
+    if (s->epfd >= 0) {
+        close(s->epfd);
+    }
+    if (s->registry_cmds != NULL) {
+        econ_registry_destroy(s->registry);
+    }
+    line_free(&s->edit);
+    free(s->hist_buf);
+    free(s->hist_saved);
+    free(s->out);
+    free(s);
+}
+
+/**
+ *  @details    replace the output sink of the session.
+ *
+ *  @param      [in]    s       session.
+ *  @param      [in]    output  output sink, or NULL for the output fd.
+ *  @param      [in]    ctx     context passed to @c output.
+ */
+void econ_session_set_output(struct econ_session *s, econ_output_fn output, void *ctx)
+{
+    if (output == NULL) {
+        s->output = fd_output;
+        s->output_ctx = s;
+    } else {
+        s->output = output;
+        s->output_ctx = ctx;
+    }
+}
+
+void session_begin(struct econ_session *s, const char *prompt)
+{
+    s->prompt = (prompt) ?: "econ>";
+    line_clear(&s->edit);
+    s->hist_pos = -1;
+    s->searching = false;
+
+    session_printf(s, "%s ", s->prompt);
+}
+
+/**
+ *  test whether keys typed while a foreground job ran are to be handled.
+ */
+static bool session_ahead(const struct econ_session *s)
+{
+    return (s->ahead_head != s->ahead_tail) && !session_jobs_busy(s) && (s->watch == NULL);
+}
+
+/**
+ *  wake up for a lone ESC, which session_poll() then reports.
+ */
+static void session_esc(struct econ_timer *t, void *ctx)
+{
+    (void)t;
+    (void)ctx;
+}
+
+int session_poll(struct econ_session *s)
+{
+    do {
+        for (;;) {
+            int key;
+
+            if (session_ahead(s)) {
+                key = s->ahead[s->ahead_head++ % lengthof(s->ahead)];
+            } else if ((key = session_decode(s)) == KEY_NONE) {
+                break;
+            }
+
+            if (session_jobs_busy(s)) {
+                if (s->more || (key == ETX) || (key == SUB)) {
+                    session_jobs_key(s, key);
+                } else if (s->ahead_tail - s->ahead_head < lengthof(s->ahead)) {
+                    /* handled when the foreground job finishes. */
+                    s->ahead[s->ahead_tail++ % lengthof(s->ahead)] = key;
+                } else {
+                    session_write(s, "\a", 1);
+                }
+            } else if (s->watch != NULL) {
+                watch_key(s, key);
+            } else if (session_input(s, key)) {
+                return 1;
+            }
+        }
+    } while (session_fill(s) > 0);
+    if (s->eof) {
+        return (line_length(&s->edit) > 0) ? 1 : -1;
+    }
+
+    int timeout = key_timeout(&s->dec, session_ms());
+    if ((timeout >= 0) && (s->epfd >= 0)) {
+        if (s->esc_timer == NULL) {
+            s->esc_timer = econ_timer_add(s, timeout, 0, session_esc, NULL);
+        } else {
+            econ_timer_set(s->esc_timer, timeout, 0);
+        }
+    }
+
+    return 0;
+}
+
+void session_refresh(struct econ_session *s)
+{
+    size_t pos = line_cursor(&s->edit);
+
+    if (s->searching) {
+        session_search_show(s);
+    } else {
+        session_redraw(s);
+        session_move(s, pos);
+    }
+}
+
+int session_parse(struct econ_session *s, char **argv, size_t length)
+{
+    char *line = line_text(&s->edit);
+    if (line == NULL) {
+        return -1;
+    }
+
+    int argc = token_split(line, line_length(&s->edit), argv, length, NULL);
+    if (argc < 0) {
+        session_printf(s, "%s\r\n", token_error(errno));
+        return 0;
+    }
+    return argc;
+}
+
+/**
+ *  @details    attach a history to the session.
+ *
+ *              a history may be shared by any number of sessions.
+ *
+ *  @param      [in]    s       session.
+ *  @param      [in]    h       history, or NULL to detach.
+ */
+void econ_session_set_history(struct econ_session *s, struct econ_history *h)
+{
+    s->history = h;
+}
+
+/**
+ *  @details    attach a command registry used for completion.
+ *
+ *              without one, the session indexes the command list
+ *              last given to econ_session_invoke().
+ *
+ *  @param      [in]    s       session.
+ *  @param      [in]    reg     registry, or NULL to detach.
+ */
+void econ_session_set_registry(struct econ_session *s, struct econ_registry *reg)
+{
+    if (s->registry_cmds != NULL) {
+        econ_registry_destroy(s->registry);
+        s->registry_cmds = NULL;
+    }
+    s->registry = reg;
+}
+
+/**
+ *  index @c cmds for completion unless a registry is attached.
+ *
+ *  the index is rebuilt only when another command list is given.
+ */
+static void session_index(struct econ_session *s, struct econ_command *cmds)
+{
+    if ((s == NULL) || (cmds == s->registry_cmds)
+        || ((s->registry != NULL) && (s->registry_cmds == NULL))) {
+        return;
+    }
+
+    struct econ_registry *reg = econ_registry_create(cmds);
+    if (reg == NULL) {
+        return;
+    }
+    econ_session_set_registry(s, reg);
+    s->registry_cmds = cmds;
+}
+
+/**
+ *  write what can be written now, and watch for what cannot.
+ */
+static void session_advance(struct econ_session *s)
+{
+    /* whole echo of this input burst goes out at once. */
+    session_flush(s);
+    if ((s->out_len == s->out_pos) && session_jobs_pending(s)) {
+        /* output of jobs held back for room. */
+        session_jobs_drain(s);
+        session_flush(s);
+    }
+    session_watch(s);
+}
+
+/**
+ *  handle polled events other than input.
+ *
+ *  @return returns true if input or output hung up.
+ */
+static bool session_events(struct econ_session *s, int nevs)
+{
+    bool hangup = false;
+
+    for (int i = 0; i < nevs; ++i) {
+        int fd = s->events[i].data.fd;
+        uint32_t events = s->events[i].events;
+
+        if (fd == session_jobs_fd(s)) {
+            session_jobs_drain(s);
+            continue;
+        }
+        if ((fd == s->out_fd) && (events & EPOLLOUT)) {
+            session_flush(s);
+            events &= ~EPOLLOUT;
+            if ((fd != s->in_fd) || (events == 0)) {
+                continue;
+            }
+        }
+        if ((fd != s->in_fd) && (fd != s->out_fd)) {
+            /* may be a timer removed by an earlier one. */
+            session_timer_fire(s, fd);
+            continue;
+        }
+        if (!(events & EPOLLIN) || (fd != s->in_fd)) {
+            DEBUG("events: %x, fd: %d", events, fd);
+            hangup = true;
+        }
+    }
+
+    return hangup;
+}
+
+/**
+ *  show @c prompt, or keep it for when the foreground job finishes.
+ */
+static void session_open(struct econ_session *s, const char *prompt)
+{
+    if (session_jobs_busy(s) || (s->watch != NULL)) {
+        /* shown when the foreground job or the watch finishes. */
+        s->prompt = (prompt) ?: "econ>";
+    } else {
+        session_begin(s, prompt);
+    }
+    s->line_open = true;
+}
+
+/**
+ *  @details    input handling with show prompt.
+ *
+ *  @param      [in]    s       session.
+ *  @param      [in]    prompt  prompt string.
+ *  @param      [out]   argv    argument vector. (valid until next prompt)
+ *  @param      [in]    length  argument vector length.
+ *  @return     returns argument count on success.
+ *              on error, -1 returned, and @c errno set.
+ *              @c ENODATA is set when input reached end of file.
+ */
+int econ_session_prompt(struct econ_session *s, const char *prompt, char **argv, size_t length)
+{
+    bool has_eol = false;
+    uint64_t woken = 0;
+    uint64_t wakeups = 0;
+
+    if (!s->line_open) {
+        session_open(s, prompt);
+    }
+    while (!has_eol) {
+        int ret = session_poll(s);
+        if (ret > 0) {
+            break;
+        } else if (ret < 0) {
+            s->line_open = false;
+            session_drain(s, 0);
+            errno = ENODATA;
+            return -1;
+        }
+
+        session_advance(s);
+        if (woken != 0) {
+            stats_record(stats_echo, stats_now() - woken);
+            woken = 0;
+        }
+        int nevs = epoll_wait(s->epfd, s->events, lengthof(s->events), -1);
+        woken = stats_now();
+        ++wakeups;
+        if (nevs < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            break;
+        }
+        has_eol = session_events(s, nevs);
+    }
+
+    s->line_open = false;
+    session_flush(s);
+    if (woken != 0) {
+        stats_record(stats_echo, stats_now() - woken);
+    }
+    stats_record(stats_wakeups, wakeups);
+
+    return session_parse(s, argv, length);
+}
+
+/**
+ *  @details    get the fd polling the session.
+ *
+ *              it is readable whenever econ_session_step() has work to
+ *              do: input, output room, job output or a timer.
+ *
+ *  @param      [in]    s       session.
+ *  @return     returns fd on success.
+ *              on error, -1 is returned.
+ */
+int econ_session_fd(const struct econ_session *s)
+{
+    return s->epfd;
+}
+
+/**
+ *  @details    input handling with show prompt, without waiting.
+ *
+ *              the first call of a line shows the prompt. each call
+ *              handles what is ready, so a host loop calls it whenever
+ *              econ_session_fd() polls readable.
+ *
+ *  @param      [in]    s       session.
+ *  @param      [in]    prompt  prompt string.
+ *  @param      [out]   argv    argument vector. (valid until next prompt)
+ *  @param      [in]    length  argument vector length.
+ *  @return     returns argument count when a line is completed.
+ *              otherwise, -1 returned, and @c errno set.
+ *              @c EAGAIN is set when the line is not completed yet.
+ *              @c ENODATA is set when input reached end of file.
+ */
+int econ_session_step(struct econ_session *s, const char *prompt, char **argv, size_t length)
+{
+    if (!s->line_open) {
+        session_open(s, prompt);
+    }
+
+    int nevs = epoll_wait(s->epfd, s->events, lengthof(s->events), 0);
+    bool has_eol = (nevs > 0) && session_events(s, nevs);
+
+    int ret = session_poll(s);
+    if ((ret == 0) && !has_eol) {
+        session_advance(s);
+        errno = EAGAIN;
+        return -1;
+    }
+
+    s->line_open = false;
+    if (ret < 0) {
+        session_drain(s, 0);
+        errno = ENODATA;
+        return -1;
+    }
+    session_flush(s);
+
+    return session_parse(s, argv, length);
+}
+
+/**
+ *  get the default session, creating it on first use.
+ *
+ *  output of commands outside of a session goes to it on this thread
+ *  from now on.
+ */
+static struct econ_session *default_get(void)
+{
+    struct econ_session *s = atomic_load(&default_session);
+
+    if (s == NULL) {
+        pthread_mutex_lock(&default_lock);
+        s = atomic_load(&default_session);
+        if (s == NULL) {
+            s = econ_session_create(STDIN_FILENO, STDOUT_FILENO);
+            atomic_store(&default_session, s);
+        }
+        pthread_mutex_unlock(&default_lock);
+    }
+    default_user = default_user || (s != NULL);
+
+    return s;
+}
+
+/**
+ *  @details    input handling with show prompt on the default session.
+ *
+ *  @param      [in]    prompt  prompt string.
+ *  @param      [out]   argv    argument vector.
+ *  @param      [in]    length  argument vector length.
+ *  @return     returns argument count on success.
+ *              on error, -1 returned, and @c errno set.
+ */
+int econ_prompt(const char *prompt, char **argv, size_t length)
+{
+    struct econ_session *s = default_get();
+    if (s == NULL) {
+        return -1;
+    }
+
+    return econ_session_prompt(s, prompt, argv, length);
+}
+
+/**
+ *  @details    get the fd polling the default session.
+ *
+ *  @return     returns fd on success.
+ *              on error, -1 returned, and @c errno set.
+ */
+int econ_fd(void)
+{
+    struct econ_session *s = default_get();
+    if (s == NULL) {
+        return -1;
+    }
+
+    return econ_session_fd(s);
+}
+
+/**
+ *  @details    input handling with show prompt on the default session,
+ *              without waiting.
+ *
+ *  @param      [in]    prompt  prompt string.
+ *  @param      [out]   argv    argument vector.
+ *  @param      [in]    length  argument vector length.
+ *  @return     returns argument count when a line is completed.
+ *              otherwise, -1 returned, and @c errno set.
+ */
+int econ_step(const char *prompt, char **argv, size_t length)
+{
+    struct econ_session *s = default_get();
+    if (s == NULL) {
+        return -1;
+    }
+
+    return econ_session_step(s, prompt, argv, length);
+}
+
+/**
+ *  how commands are run.
+ */
+enum {
+    INVOKE_SYNC,        /**< always on the calling thread. */
+    INVOKE_AUTO,        /**< long-running commands as foreground jobs. */
+    INVOKE_BACKGROUND,  /**< as a background job. */
+};
+
+/**
+ *  strip a trailing @ref token_background from @c argv.
+ *
+ *  @return     returns @ref INVOKE_BACKGROUND if stripped,
+ *              otherwise @ref INVOKE_AUTO.
+ */
+static int invoke_mode(int *argc, char **argv)
+{
+    if ((*argc > 0) && (argv[*argc - 1] == token_background)) {
+        --*argc;
+        return INVOKE_BACKGROUND;
+    }
+    return INVOKE_AUTO;
+}
 
 /**
- *  stdin polling fd.
+ *  call @c cmd, converting arguments by its schema first.
+ *
+ *  usage is printed when the call fails.
  */
-int epfd = -1;
+static int command_call(const struct econ_command *cmd, int argc, char **argv)
+{
+    union econ_value values[ECON_ARGS_MAX];
+    const union econ_value *saved = args_current;
+    int ret = -1;
+
+    if ((cmd->args == NULL) || (args_convert(cmd, argc, argv, values) == 0)) {
+        args_current = (cmd->args != NULL) ? values : NULL;
+        ret = cmd->func(argc, argv);
+        args_current = saved;
+    }
+    if (ret != 0) {
+        if (cmd->usage != NULL) {
+            cmd->usage(argv[0]);
+        } else if (cmd->args != NULL) {
+            args_usage(cmd, argv[0]);
+        }
+    }
+
+    return ret;
+}
 
 /**
- *  get length of array.
+ *  find command @c name of @c cmds.
+ *
+ *  a list with a lookup of its own is not scanned.
  */
-#define lengthof(array) (sizeof(array)/sizeof(array[0]))
+static struct econ_command *command_find(struct econ_command *cmds, const char *name)
+{
+    if (cmds[0].lookup != NULL) {
+        return (struct econ_command *)cmds[0].lookup(cmds, name);
+    }
+    for (int i = 0; cmds[i].command != NULL; ++i) {
+        if (strcmp(cmds[i].command, name) == 0) {
+            return &cmds[i];
+        }
+    }
+
+    return NULL;
+}
 
 /**
- *  parse arguments.
+ *  invoke @c argv command from @c cmds, or from @c reg if @c cmds is NULL.
  *
- *  @param  [in,out]    buf     input buffer.
- *  @param  [out]       argv    command argument vector.
- *  @param  [in]        length  command argument vector length.
- *  @return returns argument count on success.
+ *  @c depth words before @c argv name the parent commands.
  */
-static int parse_argument(char *buf, char **argv, size_t length)
+static int invoke_commands(int argc, char **argv, struct econ_command *cmds,
+                           struct econ_registry *reg, int mode, int depth)
 {
-    int count = 0;
-    bool is_word = false;
+    bool listing = (argc == 0) || (strcmp(argv[0], SUGGEST_LIST_WORD) == 0);
 
-    for (int i = 0; buf[i] != NUL; ++i) {
-        int c = buf[i];
+    if (!listing) {
+        const struct econ_command *cmd = (cmds != NULL) ? command_find(cmds, argv[0])
+                                                        : econ_registry_find(reg, argv[0]);
 
-        if ((c != SP) && (c != TAB) && (c != LF)) {
-            if (!is_word) {
-                argv[count++] = &buf[i];
+        if (cmd != NULL) {
+            if (cmd->sub_cmds != NULL) {
+                if (cmds == NULL) {
+                    return invoke_commands(argc - 1, &argv[1], NULL, econ_registry_sub(reg, argv[0]),
+                                           mode, depth + 1);
+                }
+                return invoke_commands(argc - 1, &argv[1], cmd->sub_cmds, NULL, mode, depth + 1);
+            } else if (cmd->func != NULL) {
+                struct econ_session *s = econ_session_current();
+                struct stats_hist *stat = stats_path(cmd, argv - depth, depth + 1);
+                if ((mode != INVOKE_SYNC) && (s != NULL) && !job_running()
+                    && ((mode == INVOKE_BACKGROUND) || (cmd->flags & ECON_FLAG_ASYNC))) {
+                    return job_submit(s, cmd, argc, argv, (mode == INVOKE_BACKGROUND), stat);
+                }
+                uint64_t start = stats_now();
+                int ret = cache_call(cmd, argc, argv, command_call);
+                stats_record(stat, stats_now() - start);
+                return ret;
             }
-            is_word = true;
-        } else {
-            buf[i] = NUL;
-            if (is_word && (count >= length)) {
-                break;
+        }
+    }
+
+    if (!listing) {
+        /* a whole table is slow over a serial line, and rarely helps. */
+        struct suggestion near[SUGGEST_MAX];
+        size_t n = (cmds != NULL) ? suggest_commands(cmds, argv[0], near, lengthof(near))
+                                  : registry_suggest_find(reg, argv[0], near, lengthof(near));
+        suggest_print(argv[0], near, n);
+        errno = ENOENT;
+        return -1;
+    }
+
+    if (cmds != NULL) {
+        int col_length = 0;
+        for (int i = 0; cmds[i].command != NULL; ++i) {
+            int length = strlen(cmds[i].command);
+            if (length > col_length) {
+                col_length = length;
             }
-            is_word = false;
         }
+        econ_printf("\navailable list.\r\n");
+        for (int i = 0; cmds[i].command != NULL; ++i) {
+            struct econ_command *cmd = &cmds[i];
+
+            econ_printf("* %-*s: %s\r\n", col_length + 1, cmd->command, cmd->help);
+        }
+    } else {
+        econ_registry_help(reg);
+    }
+    if (argc > 0) {
+        /* asked for. */
+        return 0;
     }
 
-    return count;
+    errno = ENOENT;
+    return -1;
 }
 
 /**
- *  @details    input handling with show prompt.
+ *  run commands joined by '|', each reading the output of the previous one.
  *
- *  @param      [in]    prompt  prompt string.
- *  @param      [out]   argv    argument vector.
- *  @param      [in]    length  argument vector length.
- *  @return     returns argument count on success.
- *              on error, -1 returned, and @c errno set.
+ *  commands run one after another on the calling thread. output of each
+ *  is kept in the buffers it was formatted into, and these buffers become
+ *  the input stream of the next command without being copied.
+ *
+ *  @return     returns result of the last command.
  */
-int econ_prompt(const char *prompt, char **argv, size_t length)
+static int invoke_pipeline(int argc, char **argv, struct econ_command *cmds, struct econ_registry *reg)
 {
-    bool has_eol = false;
-    char buf[BUFSIZ] = {0};
-    int count = 0,
-        cursor = 0;
+    struct econ_session *saved = current_session;
+    struct econ_stream *saved_input = stream_input;
+    struct econ_stream *in = NULL;
+    int ret = 0;
 
-    if (epfd < 0) {
-        int val = fcntl(STDIN_FILENO, F_GETFL, 0);
-        if ((val & O_NONBLOCK) == 0) {
-            fcntl(STDIN_FILENO, F_SETFL, val | O_NONBLOCK);
+    for (int start = 0, end; start <= argc; start = end + 1) {
+        struct econ_session *capture = NULL;
+
+        for (end = start; (end < argc) && (argv[end] != token_pipe); ++end) {
+            continue;
+        }
+        if (end < argc) {
+            capture = session_alloc(-1, -1);
+            if ((capture == NULL) || ((capture->capture = stream_create()) == NULL)) {
+                econ_session_destroy(capture);
+                ret = -1;
+                break;
+            }
+            current_session = capture;
         }
 
-        epfd = epoll_create1(0);
-        if (epfd < 0) {
-            perror("epoll_create1");
-            return -1;
+        stream_input = in;
+        ret = invoke_commands(end - start, &argv[start], cmds, reg, INVOKE_SYNC, 0);
+        stream_input = saved_input;
+        current_session = saved;
+
+        stream_destroy(in);
+        in = NULL;
+        if (capture == NULL) {
+            break;
         }
-        struct epoll_event ev;
-        ev.events = EPOLLIN | EPOLLET;
-        ev.data.fd = STDIN_FILENO;
-        if (epoll_ctl(epfd, EPOLL_CTL_ADD,ev.data.fd, &ev) != 0) {
-            perror("epoll_ctl");
-            close(epfd);
-            epfd = -1;
-            return -1;
+        session_flush(capture);
+        in = capture->capture;
+        econ_session_destroy(capture);
+    }
+    stream_destroy(in);
+
+    return ret;
+}
+
+/**
+ *  invoke a command line, which may be a pipeline, from @c cmds or @c reg.
+ */
+static int invoke_line(int argc, char **argv, struct econ_command *cmds, struct econ_registry *reg, int mode)
+{
+    struct econ_command *saved = current_cmds;
+    int ret;
+
+    current_cmds = cmds;
+    for (int i = 0; i < argc; ++i) {
+        if (argv[i] == token_pipe) {
+            ret = invoke_pipeline(argc, argv, cmds, reg);
+            current_cmds = saved;
+            return ret;
         }
     }
+    ret = invoke_commands(argc, argv, cmds, reg, mode, 0);
+    current_cmds = saved;
 
-    prompt = (prompt) ?: "econ>";
+    return ret;
+}
 
-    printf("%s ", prompt);
-    fflush(stdout);
-    do {
-        static struct epoll_event events[10];
-        int nevs = epoll_wait(epfd, events, lengthof(events), -1);
-        if (nevs < 0) {
-            perror("epoll_wait");
-            break;
+struct econ_command *session_commands(void)
+{
+    return current_cmds;
+}
+
+struct econ_session *session_switch(struct econ_session *s)
+{
+    struct econ_session *saved = current_session;
+
+    current_session = s;
+    return saved;
+}
+
+int session_run(struct econ_session *s, const struct econ_command *cmd, int argc, char **argv)
+{
+    struct econ_session *saved = current_session;
+
+    current_session = s;
+    ++s->invoking;
+    int ret = command_call(cmd, argc, argv);
+    --s->invoking;
+    current_session = saved;
+    if (!s->deferred) {
+        session_flush(s);
+    }
+
+    return ret;
+}
+
+int session_invoke(struct econ_session *s, int argc, char **argv, struct econ_command *cmds)
+{
+    struct econ_session *saved = current_session;
+
+    current_session = s;
+    ++s->invoking;
+    int ret = invoke_line(argc, argv, cmds, NULL, INVOKE_SYNC);
+    --s->invoking;
+    current_session = saved;
+
+    return ret;
+}
+
+/**
+ *  invoke @c argv command from @c cmds or @c reg as a line of session @c s.
+ *
+ *  the output policy is applied, and the output is flushed at the end.
+ */
+static int invoke_session(struct econ_session *s, int argc, char **argv,
+                          struct econ_command *cmds, struct econ_registry *reg)
+{
+    struct econ_session *saved = current_session;
+    int mode = invoke_mode(&argc, argv);
+
+    if ((s->invoking == 0) && (s->out_limit > 0)) {
+        s->interrupted = false;
+        s->page_lines = 0;
+        if (s->out_policy == ECON_OUTPUT_MORE) {
+            s->page_rows = session_rows(s);
         }
-        for (int i = 0; i < nevs; ++i) {
-            if ((events[i].events & EPOLLIN) && (events[i].data.fd == STDIN_FILENO)) {
-                int c;
-                while ((c = getchar()) != EOF) {
-                    if ((0x00 <= c) && (c < 0xFF)) {
-                        if (c == CR) {
-                            c = LF;
-                        }
-                        if (c == LF) {
-                            buf[count] = NUL;
-                            putchar(CR);
-                            putchar(LF);
-                            has_eol = true;
-                        } else {
-                            if ((SP <= c) && (c < DEL)) {
-                                if (cursor == count) {
-                                    putchar(c);
-                                } else {
-                                    for (int i = count; i > cursor; --i) {
-                                        buf[i] = buf[i - 1];
-                                    }
-                                }
-                                buf[cursor++] = c;
-                                ++count;
-                                if (cursor != count) {
-                                    printf("\r%s %s\033[%dD", prompt, buf, count - cursor);
-                                }
-                            } else {
-                                switch (c) {
-                                case ESC:
-                                    getchar(); /* skip '[' */
-                                    c = getchar();
-                                    switch (c) {
-                                    case '3': /* delete */
-                                        getchar(); /* skip '~' */
-                                        if (cursor < count) {
-                                            for (int i = cursor; i < count; ++i) {
-                                                buf[i] = buf[i + 1];
-                                            }
-                                            --count;
-                                            printf("\r%s %s\033[K\033[%dD", prompt, buf, count - cursor);
-                                        }
-                                        break;
-                                    case 'A': /* up */
-                                        break;
-                                    case 'B': /* down */
-                                        break;
-                                    case 'C': /* right */
-                                        if (++cursor > count) {
-                                            cursor = count;
-                                        } else {
-                                            printf("\033[1C");
-                                        }
-                                        break;
-                                    case 'D': /* left */
-                                        if (--cursor < 0) {
-                                            cursor = 0;
-                                        } else {
-                                            printf("\033[1D");
-                                        }
-                                        break;
-                                    default:
-                                        break;
-                                    }
-                                    break;
-                                case DEL: /* backspace */
-                                    if (cursor == count) {
-                                        if (count > 0) {
-                                            --count;
-                                            --cursor;
-                                            buf[cursor] = NUL;
-                                            printf("\033[1D\033[K");
-                                        }
-                                    } else {
-                                        --cursor;
-                                        for (int i = cursor; i < count; ++i) {
-                                            buf[i] = buf[i + 1];
-                                        }
-                                        --count;
-                                        printf("\r%s %s\033[K\033[%dD", prompt, buf, count - cursor);
-                                    }
-                                    break;
-                                default:
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
-            } else {
-                DEBUG("events: %x, fd: %d", events[i].events, events[i].data.fd);
-                has_eol = true;
-            }
+    }
+    current_session = s;
+    ++s->invoking;
+    int ret = invoke_line(argc, argv, cmds, reg, mode);
+    --s->invoking;
+    current_session = saved;
+    if (s->invoking == 0) {
+        if (s->interrupted) {
+            session_write(s, "^C\r\n", 4);
+            s->interrupted = false;
+        }
+        if (s->dropped > 0) {
+            session_printf(s, "[%" PRIu64 " bytes of output dropped]\r\n", s->dropped);
+            s->dropped = 0;
         }
-    } while (!has_eol);
+    }
+    if (!s->deferred) {
+        session_flush(s);
+    }
 
-    return parse_argument(buf, argv, length);
+    return ret;
 }
 
 /**
  *  @details    invoke @c argv command from @c cmds.
  *
+ *              outside of a command, the command runs on the default
+ *              session on a thread which called econ_prompt(),
+ *              econ_step() or econ_fd(), and writes straight to stdout
+ *              on other threads.
+ *              with an unquoted '&' ending the line, or for a command
+ *              flagged @ref ECON_FLAG_ASYNC, the command runs as a job
+ *              of the current session.
+ *              commands joined by '|' run as a pipeline, always
+ *              on the calling thread.
+ *
  *  @param      [in]    argc    command argument count.
  *  @param      [in]    argv    command argument values.
  *  @param      [in]    cmds    command list.
@@ -227,38 +1978,410 @@ int econ_prompt(const char *prompt, char **argv, size_t length)
  */
 int econ_invoke(int argc, char **argv, struct econ_command *cmds)
 {
-    int col_length = 0;
-    for (int i = 0; cmds[i].command != NULL; ++i) {
-        struct econ_command *cmd = &cmds[i];
-        size_t length = strlen(cmd->command);
+    struct econ_session *s = econ_session_current();
 
-        if ((argc > 0) && (strcmp(cmd->command, argv[0]) == 0)) {
-            if (cmd->sub_cmds != NULL) {
-                return econ_invoke(argc - 1, &argv[1], cmd->sub_cmds);
-            } else if (cmd->func != NULL) {
-                int ret = cmd->func(argc, argv);
-                if ((ret != 0) && (cmd->usage != NULL)) {
-                    cmd->usage(argv[0]);
-                }
-                return ret;
+    if (s == NULL) {
+        /* written straight to stdout. */
+        int mode = invoke_mode(&argc, argv);
+        return invoke_line(argc, argv, cmds, NULL, mode);
+    }
+    if (current_session == NULL) {
+        session_index(s, cmds);
+    }
+    return invoke_session(s, argc, argv, cmds, NULL);
+}
+
+int invoke_registry(struct econ_registry *reg, int argc, char **argv)
+{
+    struct econ_session *s = econ_session_current();
+
+    if (s == NULL) {
+        /* written straight to stdout. */
+        int mode = invoke_mode(&argc, argv);
+        return invoke_line(argc, argv, NULL, reg, mode);
+    }
+    return invoke_session(s, argc, argv, NULL, reg);
+}
+
+/**
+ *  @details    invoke @c argv command from @c cmds on session @c s.
+ *
+ *              output of the command written by econ_printf() or
+ *              econ_write() goes to the output sink of @c s.
+ *              with an unquoted '&' ending the line, or for a command
+ *              flagged @ref ECON_FLAG_ASYNC, the command runs as a job and
+ *              this function returns without waiting for it.
+ *              commands joined by '|' run as a pipeline, always
+ *              on the calling thread.
+ *
+ *  @param      [in]    s       session.
+ *  @param      [in]    argc    command argument count.
+ *  @param      [in]    argv    command argument values.
+ *  @param      [in]    cmds    command list.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_session_invoke(struct econ_session *s, int argc, char **argv, struct econ_command *cmds)
+{
+    session_index(s, cmds);
+
+    return invoke_session(s, argc, argv, cmds, NULL);
+}
+
+/**
+ *  batch input block size.
+ */
+#define BATCH_BLOCK_SIZE (64 * 1024)
+
+/**
+ *  most arguments of a batch line.
+ */
+#define BATCH_MAX_ARGS (64)
+
+/**
+ *  run one batch line terminated in place.
+ *
+ *  blank lines and lines starting with '#' are skipped.
+ *
+ *  @return     returns 0 on success.
+ *              on error, the command result is returned.
+ */
+static int batch_line(struct econ_session *s, char *line, size_t len, size_t lineno,
+                      struct econ_command *cmds, struct econ_batch_stats *stats)
+{
+    char *argv[BATCH_MAX_ARGS];
+
+    if ((len > 0) && (line[len - 1] == CR)) {
+        line[--len] = NUL;
+    }
+    while ((len > 0) && ((*line == SP) || (*line == TAB))) {
+        ++line;
+        --len;
+    }
+    if (*line == '#') {
+        return 0;
+    }
+    int argc = token_split(line, len, argv, lengthof(argv), NULL);
+    if (argc < 0) {
+        ++stats->errors;
+        if (stats->first_error == 0) {
+            stats->first_error = lineno;
+        }
+        session_flush(s);
+        fprintf(stderr, "econ: line %zu: %s\n", lineno, token_error(errno));
+        return -1;
+    } else if (argc == 0) {
+        return 0;
+    }
+
+    ++stats->commands;
+    invoke_mode(&argc, argv);
+    int ret = invoke_line(argc, argv, cmds, NULL, INVOKE_SYNC);
+    if (ret != 0) {
+        ++stats->errors;
+        if (stats->first_error == 0) {
+            stats->first_error = lineno;
+        }
+        /* keep order of command output and the error. */
+        session_flush(s);
+        fprintf(stderr, "econ: line %zu: %s: failed (%d)\n", lineno, argv[0], ret);
+    } else if (s->out_len - s->out_pos >= SESSION_FLUSH_THRESHOLD) {
+        session_flush(s);
+    }
+
+    return ret;
+}
+
+/**
+ *  @details    run commands read from @c fd without line editing.
+ *
+ *              input is read in large blocks and split into lines in place,
+ *              nothing is echoed. output of commands goes to the current
+ *              session, or to stdout in blocks outside of a session.
+ *              every command runs to completion in order, a trailing '&'
+ *              is ignored.
+ *              a failed command is reported to stderr with its line number.
+ *
+ *  @param      [in]    fd      input fd. (a script file or a pipe)
+ *  @param      [in]    cmds    command list.
+ *  @param      [in]    flags   @ref ECON_BATCH_STOP_ON_ERROR or 0.
+ *  @param      [out]   stats   counters, or NULL.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ *              @c ECANCELED is set when any command failed.
+ */
+int econ_run_stream(int fd, struct econ_command *cmds, int flags, struct econ_batch_stats *stats)
+{
+    struct econ_batch_stats st = {0};
+    struct econ_session *s = current_session, *own = NULL;
+    size_t cap = BATCH_BLOCK_SIZE, len = 0;
+    bool skipping = false, stop = false;
+    int error = 0;
+
+    if ((fd < 0) || (cmds == NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+    char *buf = malloc(cap + 1);
+    if (buf == NULL) {
+        return -1;
+    }
+    if (s == NULL) {
+        own = s = session_alloc(-1, STDOUT_FILENO);
+        if (s == NULL) {
+            free(buf);
+            return -1;
+        }
+        s->deferred = true;
+    }
+
+    struct econ_session *saved = current_session;
+    current_session = s;
+    ++s->invoking;
+    while (!stop) {
+        ssize_t n = read(fd, &buf[len], cap - len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                struct pollfd pfd = {.fd = fd, .events = POLLIN};
+                poll(&pfd, 1, -1);
+                continue;
+            }
+            error = errno;
+            break;
+        }
+
+        char *line = buf;
+        char *from = &buf[len];
+        char *lf;
+        len += n;
+        while (!stop && ((lf = memchr(from, LF, &buf[len] - from)) != NULL)) {
+            *lf = NUL;
+            ++st.lines;
+            if (skipping) {
+                skipping = false;
+            } else if ((batch_line(s, line, lf - line, st.lines, cmds, &st) != 0)
+                       && (flags & ECON_BATCH_STOP_ON_ERROR)) {
+                stop = true;
+            }
+            line = from = lf + 1;
+        }
+        if (n == 0) {
+            /* last line without LF. */
+            if (!stop && !skipping && (line < &buf[len])) {
+                buf[len] = NUL;
+                ++st.lines;
+                batch_line(s, line, &buf[len] - line, st.lines, cmds, &st);
             }
+            break;
         }
 
-        if (length > col_length) {
-            col_length = length;
+        /* keep the partial line at the head. */
+        len -= line - buf;
+        memmove(buf, line, len);
+        if (len == cap) {
+            if (cap >= SESSION_LINE_MAX) {
+                ++st.errors;
+                if (st.first_error == 0) {
+                    st.first_error = st.lines + 1;
+                }
+                session_flush(s);
+                fprintf(stderr, "econ: line %zu: line too long\n", st.lines + 1);
+                stop = (flags & ECON_BATCH_STOP_ON_ERROR);
+                skipping = true;
+                len = 0;
+                continue;
+            }
+            char *grown = realloc(buf, cap * 2 + 1);
+            if (grown == NULL) {
+                error = ENOMEM;
+                break;
+            }
+            buf = grown;
+            cap *= 2;
+        }
+        if (own != NULL) {
+            session_flush(s);
         }
     }
+    --s->invoking;
+    current_session = saved;
 
-    if (argc > 0) {
-        printf("%s: command not found\r\n", argv[0]);
+    if (own != NULL) {
+        session_flush(own);
+        econ_session_destroy(own);
     }
-    printf("\navailable list.\r\n");
-    for (int i = 0; cmds[i].command != NULL; ++i) {
-        struct econ_command *cmd = &cmds[i];
+    free(buf);
+    if (stats != NULL) {
+        *stats = st;
+    }
+    if (error != 0) {
+        errno = error;
+        return -1;
+    } else if (st.errors > 0) {
+        errno = ECANCELED;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ *  @details    write out buffered output of the session.
+ *
+ *  @param      [in]    s       session.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_session_flush(struct econ_session *s)
+{
+    return session_drain(s, 0);
+}
+
+/**
+ *  @details    configure the output queue of the session.
+ *
+ *              output of commands is queued up to @c limit bytes, and
+ *              written as the output fd takes it while keys are still
+ *              handled. when the queue is full, the command waits for
+ *              room, its newest output is dropped, or the output pages
+ *              through --More--, by @c policy. ETX typed while a command
+ *              waits drops the rest of its output, and econ_cancelled()
+ *              tells the command.
+ *
+ *              with @ref ECON_FLOW_XONXOFF, DC3 typed pauses output and
+ *              DC1 resumes it. with @ref ECON_FLOW_RTSCTS, the output
+ *              terminal is set to hardware flow control, and output
+ *              queues while CTS is off.
+ *
+ *              waiting needs the output fd sink, with another sink a
+ *              full queue grows instead. a limit of 0 writes output
+ *              through, waiting for the fd as it goes.
+ *
+ *  @param      [in]    s       session.
+ *  @param      [in]    config  configuration.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_session_set_flow(struct econ_session *s, const struct econ_output_config *config)
+{
+    if ((config->policy < ECON_OUTPUT_BLOCK) || (config->policy > ECON_OUTPUT_MORE)
+        || (config->flow & ~(ECON_FLOW_XONXOFF | ECON_FLOW_RTSCTS))) {
+        errno = EINVAL;
+        return -1;
+    }
+    if ((config->flow & ECON_FLOW_RTSCTS) && (s->out_fd >= 0)) {
+        struct termios term;
 
-        printf("* %-*s: %s\r\n", col_length + 1, cmd->command, cmd->help);
+        if (tcgetattr(s->out_fd, &term) != 0) {
+            return -1;
+        }
+        term.c_cflag |= CRTSCTS;
+        if (tcsetattr(s->out_fd, TCSADRAIN, &term) != 0) {
+            return -1;
+        }
+    }
+    if ((config->limit > 0) && (s->out_fd >= 0)) {
+        int val = fcntl(s->out_fd, F_GETFL, 0);
+        if ((val & O_NONBLOCK) == 0) {
+            fcntl(s->out_fd, F_SETFL, val | O_NONBLOCK);
+        }
+    }
+    if (config->limit == 0) {
+        session_drain(s, 0);
     }
+    s->out_limit = config->limit;
+    s->out_policy = config->policy;
+    s->flow = config->flow;
+    if (!(s->flow & ECON_FLOW_XONXOFF)) {
+        s->xoff = false;
+    }
+    session_watch(s);
 
-    errno = ENOENT;
-    return -1;
+    return 0;
+}
+
+/**
+ *  @details    get output and input counters of the session.
+ *
+ *  @param      [in]    s       session.
+ *  @param      [out]   stats   counters.
+ */
+void econ_session_get_stats(const struct econ_session *s, struct econ_session_stats *stats)
+{
+    *stats = s->stats;
+}
+
+/**
+ *  @details    reset counters of the session.
+ *
+ *  @param      [in]    s       session.
+ */
+void econ_session_reset_stats(struct econ_session *s)
+{
+    memset(&s->stats, 0, sizeof(s->stats));
+}
+
+/**
+ *  @details    get the session of the running command.
+ *
+ *  @return     returns session of the running command,
+ *              or the default session outside of econ_session_invoke()
+ *              on a thread which called econ_prompt(), econ_step()
+ *              or econ_fd().
+ *              otherwise, NULL is returned.
+ */
+struct econ_session *econ_session_current(void)
+{
+    if (current_session != NULL) {
+        return current_session;
+    }
+    return default_user ? atomic_load(&default_session) : NULL;
+}
+
+/**
+ *  @details    write to the current session.
+ *
+ *  @param      [in]    buf     data.
+ *  @param      [in]    len     data length.
+ *  @return     returns written length on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+ssize_t econ_write(const void *buf, size_t len)
+{
+    struct econ_session *s = econ_session_current();
+
+    return (s != NULL) ? session_write(s, buf, len) : fd_write(STDOUT_FILENO, buf, len);
+}
+
+/**
+ *  @details    write out buffered output of the current session.
+ *
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_flush(void)
+{
+    struct econ_session *s = econ_session_current();
+
+    return (s != NULL) ? session_drain(s, 0) : 0;
+}
+
+/**
+ *  @details    formatted write to the current session.
+ *
+ *  @param      [in]    format  format string.
+ *  @return     returns written length on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_printf(const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    int ret = session_vprintf(econ_session_current(), format, ap);
+    va_end(ap);
+
+    return ret;
 }
@@ -0,0 +1,208 @@
+/** @file       filters.c
+ *  @brief      Built-in pipeline filters.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#include "econ.h"
+#include "ascii.h"
+
+/**
+ *  default line count of `head`.
+ */
+#define HEAD_DEFAULT_LINES (10)
+
+/**
+ *  find @c pattern in @c len bytes of @c line.
+ */
+static bool line_match(const char *line, size_t len, const char *pattern, size_t plen,
+                       bool ignore_case)
+{
+    if (!ignore_case) {
+        return memmem(line, len, pattern, plen) != NULL;
+    }
+    for (size_t i = 0; i + plen <= len; ++i) {
+        if (strncasecmp(&line[i], pattern, plen) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void econ_grep_usage(const char *name)
+{
+    econ_printf("usage: ... | %s [-v] [-i] [-c] pattern\r\n", name);
+}
+
+/**
+ *  @details    `grep` command, pass lines containing a pattern.
+ *
+ *              matching lines are passed on without being copied.
+ *
+ *  @param      [in]    argc    command argument count.
+ *  @param      [in]    argv    command argument values.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned.
+ */
+int econ_grep_command(int argc, char **argv)
+{
+    struct econ_stream *in = econ_input();
+    bool invert = false, ignore_case = false, count_only = false;
+    const char *pattern = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-v") == 0) {
+            invert = true;
+        } else if (strcmp(argv[i], "-i") == 0) {
+            ignore_case = true;
+        } else if (strcmp(argv[i], "-c") == 0) {
+            count_only = true;
+        } else if (pattern == NULL) {
+            pattern = argv[i];
+        } else {
+            return -1;
+        }
+    }
+    if ((in == NULL) || (pattern == NULL)) {
+        return -1;
+    }
+
+    size_t plen = strlen(pattern);
+    size_t matched = 0;
+    const char *line;
+    ssize_t len;
+    while ((len = econ_stream_peek_line(in, &line)) > 0) {
+        size_t text_len = (line[len - 1] == LF) ? len - 1 : len;
+        if (line_match(line, text_len, pattern, plen, ignore_case) != invert) {
+            ++matched;
+            if (!count_only) {
+                econ_stream_forward(in, len);
+                continue;
+            }
+        }
+        econ_stream_skip(in, len);
+    }
+    if (count_only) {
+        econ_printf("%zu\r\n", matched);
+    }
+
+    return 0;
+}
+
+void econ_head_usage(const char *name)
+{
+    econ_printf("usage: ... | %s [-n lines]\r\n", name);
+}
+
+/**
+ *  @details    `head` command, pass the first lines.
+ *
+ *  @param      [in]    argc    command argument count.
+ *  @param      [in]    argv    command argument values.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned.
+ */
+int econ_head_command(int argc, char **argv)
+{
+    struct econ_stream *in = econ_input();
+    long lines = HEAD_DEFAULT_LINES;
+
+    if ((argc == 3) && (strcmp(argv[1], "-n") == 0)) {
+        lines = strtol(argv[2], NULL, 0);
+    } else if ((argc == 2) && (argv[1][0] == '-') && isdigit((unsigned char)argv[1][1])) {
+        lines = strtol(&argv[1][1], NULL, 0);
+    } else if (argc != 1) {
+        return -1;
+    }
+    if ((in == NULL) || (lines < 0)) {
+        return -1;
+    }
+
+    const char *line;
+    ssize_t len;
+    for (long n = 0; (n < lines) && ((len = econ_stream_peek_line(in, &line)) > 0); ++n) {
+        econ_stream_forward(in, len);
+    }
+    econ_stream_skip(in, econ_stream_length(in));
+
+    return 0;
+}
+
+void econ_wc_usage(const char *name)
+{
+    econ_printf("usage: ... | %s [-l] [-w] [-c]\r\n", name);
+}
+
+/**
+ *  @details    `wc` command, count lines, words and bytes.
+ *
+ *  @param      [in]    argc    command argument count.
+ *  @param      [in]    argv    command argument values.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned.
+ */
+int econ_wc_command(int argc, char **argv)
+{
+    struct econ_stream *in = econ_input();
+    bool show_lines = false, show_words = false, show_bytes = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-l") == 0) {
+            show_lines = true;
+        } else if (strcmp(argv[i], "-w") == 0) {
+            show_words = true;
+        } else if (strcmp(argv[i], "-c") == 0) {
+            show_bytes = true;
+        } else {
+            return -1;
+        }
+    }
+    if (in == NULL) {
+        return -1;
+    }
+    if (!show_lines && !show_words && !show_bytes) {
+        show_lines = show_words = show_bytes = true;
+    }
+
+    size_t lines = 0, words = 0, bytes = 0;
+    const char *line;
+    ssize_t len;
+    while ((len = econ_stream_peek_line(in, &line)) > 0) {
+        bool in_word = false;
+        for (ssize_t i = 0; i < len; ++i) {
+            bool space = isspace((unsigned char)line[i]);
+            words += (!space && !in_word);
+            in_word = !space;
+        }
+        lines += (line[len - 1] == LF);
+        bytes += len;
+        econ_stream_skip(in, len);
+    }
+
+    const char *sep = "";
+    if (show_lines) {
+        econ_printf("%zu", lines);
+        sep = " ";
+    }
+    if (show_words) {
+        econ_printf("%s%zu", sep, words);
+        sep = " ";
+    }
+    if (show_bytes) {
+        econ_printf("%s%zu", sep, bytes);
+    }
+    econ_printf("\r\n");
+
+    return 0;
+}
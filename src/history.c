@@ -0,0 +1,419 @@
+/** @file       history.c
+ *  @brief      Persistent command history.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "econ.h"
+#include "ascii.h"
+#include "debug.h"
+
+/**
+ *  history file magic. ("ECHI")
+ */
+#define HISTORY_MAGIC (0x49484345)
+
+/**
+ *  history file layout version.
+ */
+#define HISTORY_VERSION (1)
+
+/**
+ *  default number of entries.
+ */
+#define HISTORY_DEFAULT_ENTRIES (1024)
+
+/**
+ *  data bytes reserved per entry.
+ */
+#define HISTORY_BYTES_PER_ENTRY (128)
+
+/**
+ *  history file header.
+ *
+ *  the file is mapped shared, every field is accessed under @c lock.
+ */
+struct history_header {
+    uint32_t magic;         /**< HISTORY_MAGIC. */
+    uint32_t version;       /**< HISTORY_VERSION. */
+    uint64_t size;          /**< file size. */
+    uint32_t nslots;        /**< number of index slots, power of 2. */
+    uint32_t lock;          /**< pid of the lock holder, 0 if unlocked. */
+    uint64_t data_size;     /**< size of the data ring. */
+    uint64_t seq;           /**< sequence number of the next entry. */
+    uint64_t data_head;     /**< write position of the data ring. (monotonic) */
+};
+
+/**
+ *  index slot of one entry.
+ */
+struct history_slot {
+    uint64_t seq;           /**< entry sequence number + 1, 0 if empty. */
+    uint64_t pos;           /**< data position. (monotonic) */
+    uint64_t grams;         /**< bigram signature for search. */
+    uint32_t len;           /**< entry length. */
+    uint32_t reserved;      /**< reserved. */
+};
+
+/**
+ *  command history.
+ */
+struct econ_history {
+    struct history_header *hdr; /**< mapped header. */
+    struct history_slot *slots; /**< mapped index. */
+    char *data;                 /**< mapped data ring. */
+    size_t map_size;            /**< mapped size. */
+};
+
+/**
+ *  bigram signature, every adjacent pair of the text sets one bit.
+ *
+ *  an entry can contain a query only if it has all bits of the query,
+ *  which rejects most entries without touching their text.
+ */
+static uint64_t bigrams(const char *text, size_t len)
+{
+    uint64_t grams = 0;
+
+    for (size_t i = 1; i < len; ++i) {
+        unsigned a = (unsigned char)text[i - 1];
+        unsigned b = (unsigned char)text[i];
+        grams |= 1ULL << (((a * 33) ^ b) & 63);
+    }
+    return grams;
+}
+
+static void history_lock(struct econ_history *h)
+{
+    uint32_t self = getpid();
+    uint32_t owner = 0;
+    unsigned spins = 0;
+
+    while (!__atomic_compare_exchange_n(&h->hdr->lock, &owner, self, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        if ((++spins % 1024) == 0) {
+            if ((owner != self) && (kill(owner, 0) != 0) && (errno == ESRCH)) {
+                /* holder died, take the lock over. */
+                DEBUG("stale history lock: %u", owner);
+                __atomic_compare_exchange_n(&h->hdr->lock, &owner, 0, false,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+            }
+            sched_yield();
+        }
+        owner = 0;
+    }
+}
+
+static void history_unlock(struct econ_history *h)
+{
+    __atomic_store_n(&h->hdr->lock, 0, __ATOMIC_RELEASE);
+}
+
+static bool entry_valid(const struct econ_history *h, uint64_t seq)
+{
+    const struct history_header *hdr = h->hdr;
+    const struct history_slot *slot = &h->slots[seq & (hdr->nslots - 1)];
+
+    return (seq < hdr->seq)
+        && (slot->seq == seq + 1)
+        && (hdr->data_head - slot->pos <= hdr->data_size);
+}
+
+/**
+ *  oldest entry still held, the validity is monotonic in @c seq.
+ */
+static uint64_t oldest_entry(const struct econ_history *h)
+{
+    uint64_t lo = (h->hdr->seq > h->hdr->nslots) ? h->hdr->seq - h->hdr->nslots : 0;
+    uint64_t hi = h->hdr->seq;
+
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (entry_valid(h, mid)) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+static void header_init(struct history_header *hdr, size_t size, uint32_t nslots, size_t data_size)
+{
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->magic = HISTORY_MAGIC;
+    hdr->version = HISTORY_VERSION;
+    hdr->size = size;
+    hdr->nslots = nslots;
+    hdr->data_size = data_size;
+}
+
+/**
+ *  @details    open a history holding @c entries lines.
+ *
+ *              with @c path, the history is kept in a fixed size file
+ *              mapped shared, it survives restarts and is shared by every
+ *              process opening the same file. an existing file keeps its
+ *              own geometry. without @c path, the history lives in memory.
+ *
+ *  @param      [in]    path    history file, or NULL.
+ *  @param      [in]    entries number of entries, 0 for default.
+ *  @return     returns history on success.
+ *              on error, NULL is returned, and @c errno set.
+ */
+struct econ_history *econ_history_open(const char *path, size_t entries)
+{
+    uint32_t nslots = 1;
+    while (nslots < ((entries > 0) ? entries : HISTORY_DEFAULT_ENTRIES)) {
+        nslots <<= 1;
+    }
+    size_t data_size = (size_t)nslots * HISTORY_BYTES_PER_ENTRY;
+    size_t size = sizeof(struct history_header) + sizeof(struct history_slot) * nslots + data_size;
+
+    struct econ_history *h = calloc(1, sizeof(*h));
+    if (h == NULL) {
+        return NULL;
+    }
+
+    void *map = MAP_FAILED;
+    bool init = true;
+    if (path == NULL) {
+        map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    } else {
+        int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            free(h);
+            return NULL;
+        }
+        /* serialize creation against other processes. */
+        flock(fd, LOCK_EX);
+
+        struct stat st;
+        struct history_header hdr;
+        if ((fstat(fd, &st) == 0)
+            && (pread(fd, &hdr, sizeof(hdr), 0) == sizeof(hdr))
+            && (hdr.magic == HISTORY_MAGIC)
+            && (hdr.version == HISTORY_VERSION)
+            && (hdr.size == (uint64_t)st.st_size)
+            && (hdr.nslots > 0) && ((hdr.nslots & (hdr.nslots - 1)) == 0)
+            && (hdr.size == sizeof(hdr) + sizeof(struct history_slot) * hdr.nslots + hdr.data_size)) {
+            size = hdr.size;
+            nslots = hdr.nslots;
+            data_size = hdr.data_size;
+            init = false;
+        } else if ((ftruncate(fd, 0) != 0) || (ftruncate(fd, size) != 0)) {
+            int saved = errno;
+            close(fd);
+            free(h);
+            errno = saved;
+            return NULL;
+        }
+        map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if ((map != MAP_FAILED) && init) {
+            header_init(map, size, nslots, data_size);
+        }
+        flock(fd, LOCK_UN);
+        close(fd);
+    }
+    if (map == MAP_FAILED) {
+        int saved = errno;
+        free(h);
+        errno = saved;
+        return NULL;
+    }
+    if ((path == NULL) && init) {
+        header_init(map, size, nslots, data_size);
+    }
+
+    h->hdr = map;
+    h->slots = (struct history_slot *)&h->hdr[1];
+    h->data = (char *)&h->slots[nslots];
+    h->map_size = size;
+
+    return h;
+}
+
+/**
+ *  @details    close the history.
+ *
+ *  @param      [in]    h       history.
+ */
+void econ_history_close(struct econ_history *h)
+{
+    if (h == NULL) {
+        return;
+    }
+    munmap(h->hdr, h->map_size);
+    free(h);
+}
+
+/**
+ *  @details    append @c line to the history.
+ *
+ *              empty lines and repeats of the newest entry are not added.
+ *
+ *  @param      [in]    h       history.
+ *  @param      [in]    line    line.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_history_add(struct econ_history *h, const char *line)
+{
+    size_t len = strlen(line);
+
+    if (len == 0) {
+        return 0;
+    }
+
+    history_lock(h);
+
+    struct history_header *hdr = h->hdr;
+    if (len + 1 > hdr->data_size / 4) {
+        len = hdr->data_size / 4 - 1;
+    }
+    if ((hdr->seq > 0) && entry_valid(h, hdr->seq - 1)) {
+        struct history_slot *last = &h->slots[(hdr->seq - 1) & (hdr->nslots - 1)];
+        if ((last->len == len) && (memcmp(&h->data[last->pos % hdr->data_size], line, len) == 0)) {
+            history_unlock(h);
+            return 0;
+        }
+    }
+
+    uint64_t pos = hdr->data_head;
+    uint64_t offset = pos % hdr->data_size;
+    if (offset + len + 1 > hdr->data_size) {
+        /* entries never wrap, skip the end of the ring. */
+        pos += hdr->data_size - offset;
+        offset = 0;
+    }
+    memcpy(&h->data[offset], line, len);
+    h->data[offset + len] = NUL;
+
+    struct history_slot *slot = &h->slots[hdr->seq & (hdr->nslots - 1)];
+    slot->seq = hdr->seq + 1;
+    slot->pos = pos;
+    slot->len = len;
+    slot->grams = bigrams(line, len);
+    hdr->data_head = pos + len + 1;
+    ++hdr->seq;
+
+    history_unlock(h);
+
+    return 0;
+}
+
+/**
+ *  @details    get sequence numbers of the oldest and the newest entries.
+ *
+ *  @param      [in]    h       history.
+ *  @param      [out]   first   oldest entry, or NULL.
+ *  @param      [out]   last    newest entry, or NULL.
+ *  @return     returns number of entries.
+ */
+size_t econ_history_range(struct econ_history *h, int64_t *first, int64_t *last)
+{
+    history_lock(h);
+    uint64_t oldest = oldest_entry(h);
+    uint64_t next = h->hdr->seq;
+    history_unlock(h);
+
+    if (first != NULL) {
+        *first = oldest;
+    }
+    if (last != NULL) {
+        *last = (int64_t)next - 1;
+    }
+    return next - oldest;
+}
+
+/**
+ *  @details    copy entry @c seq into @c buf.
+ *
+ *  @param      [in]    h       history.
+ *  @param      [in]    seq     entry sequence number.
+ *  @param      [out]   buf     buffer, always terminated if @c size > 0.
+ *  @param      [in]    size    buffer size.
+ *  @return     returns entry length, may be greater than or equal to @c size.
+ *              on error, -1 is returned, and @c errno set.
+ */
+ssize_t econ_history_get(struct econ_history *h, int64_t seq, char *buf, size_t size)
+{
+    if (seq < 0) {
+        errno = ENOENT;
+        return -1;
+    }
+
+    history_lock(h);
+    if (!entry_valid(h, seq)) {
+        history_unlock(h);
+        errno = ENOENT;
+        return -1;
+    }
+    const struct history_slot *slot = &h->slots[seq & (h->hdr->nslots - 1)];
+    size_t len = slot->len;
+    if (size > 0) {
+        size_t copy = (len < size) ? len : size - 1;
+        memcpy(buf, &h->data[slot->pos % h->hdr->data_size], copy);
+        buf[copy] = NUL;
+    }
+    history_unlock(h);
+
+    return len;
+}
+
+/**
+ *  @details    search the newest entry containing @c query, at or before @c from.
+ *
+ *  @param      [in]    h       history.
+ *  @param      [in]    query   substring to search.
+ *  @param      [in]    from    newest entry to look at, -1 for the newest of all.
+ *  @return     returns sequence number of the found entry.
+ *              if not found, -1 is returned.
+ */
+int64_t econ_history_search(struct econ_history *h, const char *query, int64_t from)
+{
+    size_t qlen = strlen(query);
+    uint64_t grams = bigrams(query, qlen);
+    int64_t found = -1;
+
+    history_lock(h);
+
+    const struct history_header *hdr = h->hdr;
+    int64_t oldest = oldest_entry(h);
+    if ((from < 0) || (from >= (int64_t)hdr->seq)) {
+        from = (int64_t)hdr->seq - 1;
+    }
+    for (int64_t seq = from; seq >= oldest; --seq) {
+        const struct history_slot *slot = &h->slots[seq & (hdr->nslots - 1)];
+
+        if (((slot->grams & grams) != grams) || (slot->len < qlen)) {
+            continue;
+        }
+        if (memmem(&h->data[slot->pos % hdr->data_size], slot->len, query, qlen) != NULL) {
+            found = seq;
+            break;
+        }
+    }
+
+    history_unlock(h);
+
+    return found;
+}
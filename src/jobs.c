@@ -0,0 +1,791 @@
+/** @file       jobs.c
+ *  @brief      Asynchronous command jobs.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "econ.h"
+#include "ascii.h"
+#include "jobs.h"
+#include "session.h"
+
+/**
+ *  job states.
+ */
+enum {
+    JOB_QUEUED,     /**< waiting for a worker. */
+    JOB_RUNNING,    /**< running on a worker. */
+    JOB_DONE,       /**< finished, not reported yet. */
+};
+
+/**
+ *  command running on the worker pool.
+ */
+struct job {
+    int id;                     /**< job number shown to the user. */
+    struct econ_session *owner; /**< session, NULL once detached. */
+    struct econ_session *out;   /**< output-only session of the command. */
+    struct econ_command cmd;    /**< copy of the command. */
+    struct stats_hist *stat;    /**< run time histogram, or NULL. */
+    int argc;                   /**< argument count. */
+    char **argv;                /**< arguments, strings follow the vector. */
+    char *line;                 /**< command line for listing. */
+    int state;                  /**< job state. */
+    atomic_bool cancel;         /**< cancel is requested. */
+    int result;                 /**< command result. */
+    char *pending;              /**< output not moved to the owner yet. */
+    size_t pending_len;         /**< length of @c pending. */
+    size_t pending_cap;         /**< allocated length of @c pending. */
+    size_t limit;               /**< most bytes of @c pending, 0 for no limit. */
+    int policy;                 /**< output policy of the owner. */
+    uint64_t dropped;           /**< output bytes dropped, not reported yet. */
+    bool discard;               /**< drop all further output. */
+    struct job *next;           /**< next job of the owner. */
+    struct job *queue_next;     /**< next queued job. */
+};
+
+/**
+ *  jobs of one session.
+ */
+struct session_jobs {
+    int evfd;           /**< notification fd. */
+    bool own_evfd;      /**< @c evfd is created for this table. */
+    struct job *list;   /**< jobs in number order. */
+    struct job *fg;     /**< foreground job, or NULL. */
+    bool waiting;       /**< `wait` is in progress. */
+    int wait_id;        /**< job waited for, 0 for all. */
+};
+
+/**
+ *  worker pool shared by all sessions.
+ *
+ *  one lock guards the queue, job states and pending output,
+ *  it is held only for list updates and copies.
+ */
+static struct {
+    pthread_mutex_t lock;       /**< pool lock. */
+    pthread_cond_t cond;        /**< queue is not empty or stopping. */
+    pthread_cond_t room;        /**< pending output is moved on, or cancelled. */
+    pthread_t *threads;         /**< workers. */
+    size_t workers;             /**< number of workers. */
+    size_t limit;               /**< most jobs queued or running. */
+    size_t active;              /**< jobs queued or running. */
+    struct job *head;           /**< queue head. */
+    struct job *tail;           /**< queue tail. */
+    bool started;               /**< workers are running. */
+    bool stopping;              /**< workers are asked to exit. */
+} pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .room = PTHREAD_COND_INITIALIZER,
+    .workers = JOB_DEFAULT_WORKERS,
+    .limit = JOB_DEFAULT_LIMIT,
+};
+
+/**
+ *  job running on this thread.
+ */
+static _Thread_local struct job *current_job = NULL;
+
+static void job_free(struct job *job)
+{
+    econ_session_destroy(job->out);
+    free(job->argv);
+    free(job->line);
+    free(job->pending);
+    free(job);
+}
+
+static void job_notify(struct session_jobs *jobs)
+{
+    uint64_t val = 1;
+
+    if (write(jobs->evfd, &val, sizeof(val)) < 0) {
+        perror("write");
+    }
+}
+
+/**
+ *  output sink of a job, keeps output for the owner to pick up.
+ *
+ *  beyond the output limit of the owner, the job waits until the owner
+ *  moves output on, or its output is dropped, by the owner's policy.
+ */
+static ssize_t job_output(void *ctx, const void *buf, size_t len)
+{
+    struct job *job = ctx;
+
+    pthread_mutex_lock(&pool.lock);
+    while ((job->owner != NULL) && (job->limit > 0) && (job->pending_len > 0)
+           && (job->pending_len + len > job->limit) && !job->discard
+           && !atomic_load(&job->cancel) && !pool.stopping) {
+        if (job->policy == ECON_OUTPUT_DROP) {
+            job->dropped += len;
+            pthread_mutex_unlock(&pool.lock);
+            return len;
+        }
+        pthread_cond_wait(&pool.room, &pool.lock);
+    }
+    if (job->discard) {
+        job->dropped += len;
+    } else if (job->owner != NULL) {
+        if (job->pending_len + len > job->pending_cap) {
+            size_t cap = (job->pending_cap > 0) ? job->pending_cap : 1024;
+            while (cap < job->pending_len + len) {
+                cap *= 2;
+            }
+            char *pending = realloc(job->pending, cap);
+            if (pending == NULL) {
+                pthread_mutex_unlock(&pool.lock);
+                return -1;
+            }
+            job->pending = pending;
+            job->pending_cap = cap;
+        }
+        memcpy(&job->pending[job->pending_len], buf, len);
+        job->pending_len += len;
+        job_notify(job->owner->jobs);
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    return len;
+}
+
+static void *worker_main(void *arg)
+{
+    pthread_mutex_lock(&pool.lock);
+    for (;;) {
+        while ((pool.head == NULL) && !pool.stopping) {
+            pthread_cond_wait(&pool.cond, &pool.lock);
+        }
+        struct job *job = pool.head;
+        if (job == NULL) {
+            break;
+        }
+        pool.head = job->queue_next;
+        if (pool.head == NULL) {
+            pool.tail = NULL;
+        }
+        job->state = JOB_RUNNING;
+        pthread_mutex_unlock(&pool.lock);
+
+        current_job = job;
+        uint64_t start = stats_now();
+        int ret = session_run(job->out, &job->cmd, job->argc, job->argv);
+        stats_record(job->stat, stats_now() - start);
+        current_job = NULL;
+
+        pthread_mutex_lock(&pool.lock);
+        job->result = ret;
+        job->state = JOB_DONE;
+        --pool.active;
+        if (job->owner != NULL) {
+            job_notify(job->owner->jobs);
+        } else {
+            job_free(job);
+        }
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    return NULL;
+}
+
+/**
+ *  start workers, called with the pool lock held.
+ */
+static int pool_start(void)
+{
+    pool.threads = calloc(pool.workers, sizeof(*pool.threads));
+    if (pool.threads == NULL) {
+        return -1;
+    }
+    pool.stopping = false;
+    for (size_t i = 0; i < pool.workers; ++i) {
+        int err = pthread_create(&pool.threads[i], NULL, worker_main, NULL);
+        if (err != 0) {
+            /* run with the workers created so far. */
+            pool.workers = i;
+            if (i == 0) {
+                free(pool.threads);
+                pool.threads = NULL;
+                errno = err;
+                return -1;
+            }
+            break;
+        }
+    }
+    pool.started = true;
+
+    return 0;
+}
+
+static struct session_jobs *jobs_create(struct econ_session *s)
+{
+    struct session_jobs *jobs = calloc(1, sizeof(*jobs));
+    if (jobs == NULL) {
+        return NULL;
+    }
+
+    if (s->notify_fd >= 0) {
+        jobs->evfd = s->notify_fd;
+    } else {
+        jobs->evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (jobs->evfd < 0) {
+            perror("eventfd");
+            free(jobs);
+            return NULL;
+        }
+        jobs->own_evfd = true;
+        if (s->epfd >= 0) {
+            struct epoll_event ev;
+            ev.events = EPOLLIN;
+            ev.data.fd = jobs->evfd;
+            if (epoll_ctl(s->epfd, EPOLL_CTL_ADD, jobs->evfd, &ev) != 0) {
+                perror("epoll_ctl");
+                close(jobs->evfd);
+                free(jobs);
+                return NULL;
+            }
+        }
+    }
+    s->jobs = jobs;
+
+    return jobs;
+}
+
+/**
+ *  copy arguments into one block and join them for listing.
+ */
+static int job_copy_args(struct job *job, int argc, char **argv)
+{
+    size_t size = sizeof(char *) * (argc + 1);
+
+    for (int i = 0; i < argc; ++i) {
+        size += strlen(argv[i]) + 1;
+    }
+    job->argv = malloc(size);
+    job->line = malloc(size);
+    if ((job->argv == NULL) || (job->line == NULL)) {
+        return -1;
+    }
+
+    char *p = (char *)&job->argv[argc + 1];
+    char *l = job->line;
+    for (int i = 0; i < argc; ++i) {
+        size_t len = strlen(argv[i]);
+        job->argv[i] = memcpy(p, argv[i], len + 1);
+        p += len + 1;
+        if (i > 0) {
+            *l++ = SP;
+        }
+        memcpy(l, argv[i], len);
+        l += len;
+    }
+    *l = NUL;
+    job->argv[argc] = NULL;
+    job->argc = argc;
+
+    return 0;
+}
+
+int job_submit(struct econ_session *s, const struct econ_command *cmd,
+               int argc, char **argv, bool background, struct stats_hist *stat)
+{
+    struct session_jobs *jobs = (s->jobs) ?: jobs_create(s);
+    if (jobs == NULL) {
+        return -1;
+    }
+
+    struct job *job = calloc(1, sizeof(*job));
+    if (job == NULL) {
+        return -1;
+    }
+    job->cmd = *cmd;
+    job->stat = stat;
+    job->limit = s->out_limit;
+    job->policy = s->out_policy;
+    job->out = session_alloc(-1, -1);
+    if ((job->out == NULL) || (job_copy_args(job, argc, argv) != 0)) {
+        job_free(job);
+        return -1;
+    }
+    econ_session_set_output(job->out, job_output, job);
+    atomic_init(&job->cancel, false);
+
+    pthread_mutex_lock(&pool.lock);
+    if ((!pool.started && (pool_start() != 0)) || (pool.active >= pool.limit)) {
+        int err = (pool.started) ? EAGAIN : errno;
+        pthread_mutex_unlock(&pool.lock);
+        job_free(job);
+        session_printf(s, "%s: too many jobs\r\n", argv[0]);
+        errno = err;
+        return -1;
+    }
+
+    /* lowest number above every job still listed, like a shell. */
+    struct job **tail = &jobs->list;
+    int id = 1;
+    for (; *tail != NULL; tail = &(*tail)->next) {
+        id = (*tail)->id + 1;
+    }
+    job->id = id;
+    job->owner = s;
+    *tail = job;
+    if (pool.tail != NULL) {
+        pool.tail->queue_next = job;
+    } else {
+        pool.head = job;
+    }
+    pool.tail = job;
+    ++pool.active;
+    if (!background) {
+        jobs->fg = job;
+    }
+    pthread_cond_signal(&pool.cond);
+    pthread_mutex_unlock(&pool.lock);
+
+    if (background) {
+        session_printf(s, "[%d] %s\r\n", id, job->line);
+    }
+
+    return 0;
+}
+
+bool job_running(void)
+{
+    return current_job != NULL;
+}
+
+bool session_jobs_busy(const struct econ_session *s)
+{
+    return (s->jobs != NULL) && ((s->jobs->fg != NULL) || s->jobs->waiting);
+}
+
+void session_jobs_key(struct econ_session *s, int key)
+{
+    struct session_jobs *jobs = s->jobs;
+    bool more = s->more;
+
+    pthread_mutex_lock(&pool.lock);
+    if (more) {
+        session_write(s, "\r\033[K", 4);
+        s->more = false;
+        job_notify(jobs);
+    }
+    if ((key == ETX) || (more && (key == 'q'))) {
+        session_write(s, "^C\r\n", 4);
+        if (jobs->fg != NULL) {
+            /* the job stays in the foreground until it notices. */
+            atomic_store(&jobs->fg->cancel, true);
+            if (more) {
+                jobs->fg->discard = true;
+                s->stats.dropped += jobs->fg->pending_len;
+                jobs->fg->pending_len = 0;
+            }
+            pthread_cond_broadcast(&pool.room);
+        } else {
+            jobs->waiting = false;
+        }
+    } else if (more && ((key == CR) || (key == LF))) {
+        s->page_lines = s->page_rows - 2;
+    } else if (more) {
+        s->page_lines = 0;
+    } else if ((key == SUB) && (jobs->fg != NULL)) {
+        session_printf(s, "^Z\r\n[%d] %s &\r\n", jobs->fg->id, jobs->fg->line);
+        jobs->fg = NULL;
+    }
+    bool busy = session_jobs_busy(s);
+    pthread_mutex_unlock(&pool.lock);
+
+    if (!busy) {
+        session_begin(s, s->prompt);
+    }
+}
+
+void session_jobs_drain(struct econ_session *s)
+{
+    struct session_jobs *jobs = s->jobs;
+    struct job *done = NULL;
+    bool wrote = false, ended = false;
+
+    if (jobs == NULL) {
+        return;
+    }
+    if (jobs->own_evfd) {
+        uint64_t val;
+        if ((read(jobs->evfd, &val, sizeof(val)) < 0) && (errno != EAGAIN)) {
+            perror("read");
+        }
+    }
+    if (s->watch != NULL) {
+        /* the screen is the watch's, drained when it finishes. */
+        return;
+    }
+
+    /* no more than the owner's output queue takes. */
+    size_t room = SIZE_MAX;
+    if (s->out_limit > 0) {
+        size_t queued = s->out_len - s->out_pos;
+        room = (queued < s->out_limit) ? s->out_limit - queued : 0;
+    }
+
+    bool at_prompt = !session_jobs_busy(s) && (s->prompt != NULL);
+    bool moved = false;
+    pthread_mutex_lock(&pool.lock);
+    for (struct job **pp = &jobs->list; *pp != NULL;) {
+        struct job *job = *pp;
+        bool paging = (job == jobs->fg) && (s->out_policy == ECON_OUTPUT_MORE) && (s->out_limit > 0);
+
+        if ((job->pending_len > 0) && (room > 0) && !(paging && s->more)) {
+            size_t len = (job->pending_len < room) ? job->pending_len : room;
+            if (paging) {
+                len = session_page_fill(s, job->pending, len);
+            }
+            if (at_prompt && !wrote) {
+                session_write(s, "\r\033[K", 4);
+            }
+            session_write(s, job->pending, len);
+            if (at_prompt && (len == job->pending_len) && (job->pending[len - 1] != LF)) {
+                session_write(s, "\r\n", 2);
+            }
+            job->pending_len -= len;
+            memmove(job->pending, &job->pending[len], job->pending_len);
+            room -= len;
+            if (paging && session_page_full(s)) {
+                session_write(s, "--More--", 8);
+                s->more = true;
+            }
+            wrote = moved = true;
+        }
+        if ((job->dropped > 0) && (job->pending_len == 0)) {
+            if (at_prompt && !wrote) {
+                session_write(s, "\r\033[K", 4);
+            }
+            if (!job->discard) {
+                session_printf(s, "[%d] %" PRIu64 " bytes of output dropped\r\n", job->id, job->dropped);
+            }
+            s->stats.dropped += job->dropped;
+            job->dropped = 0;
+            wrote = true;
+        }
+        if ((job->state != JOB_DONE) || (job->pending_len > 0)) {
+            pp = &job->next;
+            continue;
+        }
+
+        if (job == jobs->fg) {
+            jobs->fg = NULL;
+            ended = true;
+        } else {
+            if (at_prompt && !wrote) {
+                session_write(s, "\r\033[K", 4);
+            }
+            if (job->result == 0) {
+                session_printf(s, "[%d] Done  %s\r\n", job->id, job->line);
+            } else if (atomic_load(&job->cancel)) {
+                session_printf(s, "[%d] Cancelled  %s\r\n", job->id, job->line);
+            } else {
+                session_printf(s, "[%d] Exit %d  %s\r\n", job->id, job->result, job->line);
+            }
+            wrote = true;
+        }
+        *pp = job->next;
+        job->next = done;
+        done = job;
+    }
+    if (moved) {
+        pthread_cond_broadcast(&pool.room);
+    }
+    if (jobs->waiting) {
+        bool alive = false;
+        for (struct job *job = jobs->list; job != NULL; job = job->next) {
+            alive = alive || (jobs->wait_id == 0) || (job->id == jobs->wait_id);
+        }
+        if (!alive) {
+            jobs->waiting = false;
+            ended = true;
+        }
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    while (done != NULL) {
+        struct job *next = done->next;
+        job_free(done);
+        done = next;
+    }
+
+    if (ended && !session_jobs_busy(s)) {
+        session_begin(s, s->prompt);
+    } else if (wrote && at_prompt) {
+        session_refresh(s);
+    }
+}
+
+int session_jobs_fd(const struct econ_session *s)
+{
+    return (s->jobs != NULL) ? s->jobs->evfd : -1;
+}
+
+bool session_jobs_pending(const struct econ_session *s)
+{
+    bool pending = false;
+
+    if ((s->jobs == NULL) || s->more) {
+        return false;
+    }
+    pthread_mutex_lock(&pool.lock);
+    for (struct job *job = s->jobs->list; (job != NULL) && !pending; job = job->next) {
+        pending = (job->pending_len > 0);
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    return pending;
+}
+
+void session_jobs_release(struct econ_session *s)
+{
+    struct session_jobs *jobs = s->jobs;
+    struct job *done = NULL;
+
+    if (jobs == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    while (jobs->list != NULL) {
+        struct job *job = jobs->list;
+        jobs->list = job->next;
+        if (job->state == JOB_DONE) {
+            job->next = done;
+            done = job;
+        } else {
+            /* nobody reads the output any more, the worker frees it. */
+            job->owner = NULL;
+            atomic_store(&job->cancel, true);
+        }
+    }
+    pthread_cond_broadcast(&pool.room);
+    pthread_mutex_unlock(&pool.lock);
+
+    while (done != NULL) {
+        struct job *next = done->next;
+        job_free(done);
+        done = next;
+    }
+    if (jobs->own_evfd) {
+        close(jobs->evfd);
+    }
+    free(jobs);
+    s->jobs = NULL;
+}
+
+/**
+ *  @details    configure the worker pool.
+ *
+ *              must be called before the first job is started.
+ *
+ *  @param      [in]    workers number of worker threads, 0 for default.
+ *  @param      [in]    limit   most jobs queued or running at once, 0 for default.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_jobs_init(size_t workers, size_t limit)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&pool.lock);
+    if (pool.started) {
+        errno = EBUSY;
+        ret = -1;
+    } else {
+        pool.workers = (workers > 0) ? workers : JOB_DEFAULT_WORKERS;
+        pool.limit = (limit > 0) ? limit : JOB_DEFAULT_LIMIT;
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    return ret;
+}
+
+/**
+ *  @details    stop the worker pool.
+ *
+ *              running jobs are asked to cancel, and waited for.
+ *              the pool starts again with the next job.
+ */
+void econ_jobs_shutdown(void)
+{
+    pthread_mutex_lock(&pool.lock);
+    if (!pool.started) {
+        pthread_mutex_unlock(&pool.lock);
+        return;
+    }
+    for (struct job *job = pool.head; job != NULL; job = job->queue_next) {
+        atomic_store(&job->cancel, true);
+    }
+    pool.stopping = true;
+    pthread_cond_broadcast(&pool.cond);
+    pthread_cond_broadcast(&pool.room);
+    pthread_mutex_unlock(&pool.lock);
+
+    for (size_t i = 0; i < pool.workers; ++i) {
+        pthread_join(pool.threads[i], NULL);
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    free(pool.threads);
+    pool.threads = NULL;
+    pool.started = false;
+    pthread_mutex_unlock(&pool.lock);
+}
+
+/**
+ *  @details    check whether the running job is asked to stop.
+ *
+ *              long-running commands poll this and return early.
+ *
+ *  @return     returns non-zero if the job should stop.
+ *              outside of a job, non-zero is returned once ETX is
+ *              typed while output of the command waited.
+ */
+int econ_cancelled(void)
+{
+    struct econ_session *s;
+
+    if (current_job != NULL) {
+        return atomic_load(&current_job->cancel);
+    }
+    /* ETX typed while the output of the command waited. */
+    return ((s = econ_session_current()) != NULL) && s->interrupted;
+}
+
+/**
+ *  find job @c argv[1] of the session, or the newest one.
+ */
+static struct job *job_find(struct session_jobs *jobs, int argc, char **argv)
+{
+    struct job *found = NULL;
+    int id = 0;
+
+    if (argc > 1) {
+        id = atoi((argv[1][0] == '%') ? &argv[1][1] : argv[1]);
+    }
+    for (struct job *job = jobs->list; job != NULL; job = job->next) {
+        if ((id == 0) || (job->id == id)) {
+            found = job;
+        }
+    }
+    return found;
+}
+
+/**
+ *  @details    `jobs` command, list jobs of the session.
+ *
+ *  @param      [in]    argc    command argument count.
+ *  @param      [in]    argv    command argument values.
+ *  @return     returns 0 on success.
+ */
+int econ_jobs_command(int argc, char **argv)
+{
+    struct econ_session *s = econ_session_current();
+
+    if ((s == NULL) || (s->jobs == NULL) || job_running()) {
+        return 0;
+    }
+
+    static const char *const states[] = {"Queued", "Running", "Done"};
+    pthread_mutex_lock(&pool.lock);
+    for (struct job *job = s->jobs->list; job != NULL; job = job->next) {
+        econ_printf("[%d] %-8s %s\r\n", job->id, states[job->state], job->line);
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    return 0;
+}
+
+/**
+ *  @details    `fg [n]` command, bring a job to the foreground.
+ *
+ *              Ctrl-C cancels the job, Ctrl-Z sends it back.
+ *
+ *  @param      [in]    argc    command argument count.
+ *  @param      [in]    argv    command argument values.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned.
+ */
+int econ_fg_command(int argc, char **argv)
+{
+    struct econ_session *s = econ_session_current();
+
+    if ((s == NULL) || (s->jobs == NULL) || job_running()) {
+        econ_printf("%s: no such job\r\n", argv[0]);
+        return -1;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    struct job *job = job_find(s->jobs, argc, argv);
+    if (job != NULL) {
+        s->jobs->fg = job;
+        econ_printf("%s\r\n", job->line);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    if (job == NULL) {
+        econ_printf("%s: no such job\r\n", argv[0]);
+        return -1;
+    }
+    /* the job may have finished already. */
+    job_notify(s->jobs);
+
+    return 0;
+}
+
+/**
+ *  @details    `wait [n]` command, wait for jobs to finish.
+ *
+ *              Ctrl-C stops waiting, the jobs keep running.
+ *
+ *  @param      [in]    argc    command argument count.
+ *  @param      [in]    argv    command argument values.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned.
+ */
+int econ_wait_command(int argc, char **argv)
+{
+    struct econ_session *s = econ_session_current();
+
+    if ((s == NULL) || (s->jobs == NULL) || job_running()) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    struct job *job = job_find(s->jobs, argc, argv);
+    if (job != NULL) {
+        s->jobs->waiting = true;
+        s->jobs->wait_id = (argc > 1) ? job->id : 0;
+    }
+    pthread_mutex_unlock(&pool.lock);
+    if ((job == NULL) && (argc > 1)) {
+        econ_printf("%s: no such job\r\n", argv[0]);
+        return -1;
+    }
+    if (job != NULL) {
+        job_notify(s->jobs);
+    }
+
+    return 0;
+}
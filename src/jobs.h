@@ -0,0 +1,77 @@
+/** @file       jobs.h
+ *  @brief      Asynchronous command jobs.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_JOBS_H__
+#define __ECON_JOBS_H__
+
+#include <stdbool.h>
+
+#include "econ.h"
+#include "stats.h"
+
+/**
+ *  default number of worker threads.
+ */
+#define JOB_DEFAULT_WORKERS (4)
+
+/**
+ *  default number of jobs queued or running at once.
+ */
+#define JOB_DEFAULT_LIMIT (64)
+
+/**
+ *  run @c cmd as a job of session @c s.
+ *
+ *  a foreground job keeps the prompt hidden until it finishes,
+ *  a background job is reported when it finishes.
+ *  run time is recorded to @c stat, which may be NULL.
+ */
+int job_submit(struct econ_session *s, const struct econ_command *cmd,
+               int argc, char **argv, bool background, struct stats_hist *stat);
+
+/**
+ *  the calling thread is running a job.
+ */
+bool job_running(void);
+
+/**
+ *  session is waiting for a foreground job or for `wait`.
+ */
+bool session_jobs_busy(const struct econ_session *s);
+
+/**
+ *  handle one key while the session is busy.
+ *
+ *  only ETX and SUB, or any key at --More--, come here.
+ */
+void session_jobs_key(struct econ_session *s, int key);
+
+/**
+ *  move output and completion of jobs into the session output.
+ *
+ *  the prompt is shown again when the session is no longer busy.
+ */
+void session_jobs_drain(struct econ_session *s);
+
+/**
+ *  jobs of the session have output not moved into the session output.
+ */
+bool session_jobs_pending(const struct econ_session *s);
+
+/**
+ *  get fd readable when jobs of the session have news, or -1.
+ */
+int session_jobs_fd(const struct econ_session *s);
+
+/**
+ *  detach jobs from a session being destroyed.
+ */
+void session_jobs_release(struct econ_session *s);
+
+#endif /* __ECON_JOBS_H__ */
@@ -0,0 +1,200 @@
+/** @file       keys.c
+ *  @brief      Terminal input decoder.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <string.h>
+
+#include "ascii.h"
+#include "keys.h"
+#include "utils.h"
+
+/**
+ *  decoder states.
+ */
+enum {
+    STATE_GROUND,   /**< plain input. */
+    STATE_ESC,      /**< after ESC. */
+    STATE_CSI,      /**< after ESC [. */
+    STATE_SS3,      /**< after ESC O. */
+};
+
+/**
+ *  keys of final bytes shared by CSI and SS3.
+ */
+static int final_key(unsigned char c)
+{
+    switch (c) {
+    case 'A':
+        return KEY_UP;
+    case 'B':
+        return KEY_DOWN;
+    case 'C':
+        return KEY_RIGHT;
+    case 'D':
+        return KEY_LEFT;
+    case 'H':
+        return KEY_HOME;
+    case 'F':
+        return KEY_END;
+    case 'P':
+    case 'Q':
+    case 'R':
+    case 'S':
+        return KEY_F1 + (c - 'P');
+    default:
+        return KEY_NONE;
+    }
+}
+
+/**
+ *  keys of "CSI n ~" sequences.
+ */
+static int tilde_key(int n)
+{
+    static const int vt_keys[] = {
+        [1] = KEY_HOME,
+        [2] = KEY_INSERT,
+        [3] = KEY_DELETE,
+        [4] = KEY_END,
+        [5] = KEY_PGUP,
+        [6] = KEY_PGDN,
+        [7] = KEY_HOME,
+        [8] = KEY_END,
+        [11] = KEY_F1,
+        [12] = KEY_F1 + 1,
+        [13] = KEY_F1 + 2,
+        [14] = KEY_F1 + 3,
+        [15] = KEY_F1 + 4,
+        [17] = KEY_F1 + 5,
+        [18] = KEY_F1 + 6,
+        [19] = KEY_F1 + 7,
+        [20] = KEY_F1 + 8,
+        [21] = KEY_F1 + 9,
+        [23] = KEY_F1 + 10,
+        [24] = KEY_F1 + 11,
+    };
+
+    if ((n <= 0) || (n >= (int)lengthof(vt_keys)) || (vt_keys[n] == 0)) {
+        return KEY_NONE;
+    }
+    return vt_keys[n];
+}
+
+/**
+ *  xterm modifier parameter (1 + bits of shift, alt, ctrl).
+ */
+static int modifiers(int param)
+{
+    int mods = 0;
+
+    if (param > 1) {
+        --param;
+        mods |= (param & 1) ? KEY_SHIFT : 0;
+        mods |= (param & 2) ? KEY_ALT : 0;
+        mods |= (param & 4) ? KEY_CTRL : 0;
+    }
+    return mods;
+}
+
+void key_decoder_init(struct key_decoder *dec)
+{
+    memset(dec, 0, sizeof(*dec));
+    dec->state = STATE_GROUND;
+}
+
+int key_decode(struct key_decoder *dec, unsigned char c, uint64_t ms)
+{
+    int key;
+
+    switch (dec->state) {
+    case STATE_GROUND:
+        if (c == ESC) {
+            dec->state = STATE_ESC;
+            dec->esc_ms = ms;
+            return KEY_NONE;
+        }
+        return c;
+
+    case STATE_ESC:
+        if (c == '[') {
+            dec->state = STATE_CSI;
+            dec->nparams = 0;
+            memset(dec->params, 0, sizeof(dec->params));
+            return KEY_NONE;
+        } else if (c == 'O') {
+            dec->state = STATE_SS3;
+            return KEY_NONE;
+        } else if (c == ESC) {
+            /* ESC ESC, report the first one alone. */
+            dec->esc_ms = ms;
+            return ESC;
+        }
+        dec->state = STATE_GROUND;
+        return KEY_ALT | c;
+
+    case STATE_SS3:
+        dec->state = STATE_GROUND;
+        return final_key(c);
+
+    case STATE_CSI:
+        if (('0' <= c) && (c <= '9')) {
+            if (dec->nparams == 0) {
+                dec->nparams = 1;
+            }
+            int *param = &dec->params[dec->nparams - 1];
+            if (*param < 10000) {
+                *param = *param * 10 + (c - '0');
+            }
+            return KEY_NONE;
+        } else if (c == ';') {
+            if (dec->nparams == 0) {
+                dec->nparams = 1;
+            }
+            if (dec->nparams < KEY_MAX_PARAMS) {
+                ++dec->nparams;
+            }
+            return KEY_NONE;
+        } else if ((0x20 <= c) && (c < 0x40)) {
+            /* private markers and intermediates are not used by keys. */
+            return KEY_NONE;
+        }
+
+        dec->state = STATE_GROUND;
+        if (c == '~') {
+            key = tilde_key(dec->params[0]);
+        } else {
+            key = final_key(c);
+        }
+        if ((key != KEY_NONE) && (dec->nparams > 1)) {
+            key |= modifiers(dec->params[1]);
+        }
+        return key;
+
+    default:
+        dec->state = STATE_GROUND;
+        return KEY_NONE;
+    }
+}
+
+int key_expire(struct key_decoder *dec, uint64_t ms)
+{
+    if ((dec->state != STATE_ESC) || (ms - dec->esc_ms < KEY_ESC_TIMEOUT_MS)) {
+        return KEY_NONE;
+    }
+    /* typed alone, not the start of a sequence. */
+    dec->state = STATE_GROUND;
+    return ESC;
+}
+
+int key_timeout(const struct key_decoder *dec, uint64_t ms)
+{
+    if (dec->state != STATE_ESC) {
+        return -1;
+    }
+    return (ms - dec->esc_ms < KEY_ESC_TIMEOUT_MS) ? (int)(dec->esc_ms + KEY_ESC_TIMEOUT_MS - ms) : 0;
+}
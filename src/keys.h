@@ -0,0 +1,91 @@
+/** @file       keys.h
+ *  @brief      Terminal input decoder.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_KEYS_H__
+#define __ECON_KEYS_H__
+
+#include <stdint.h>
+
+/**
+ *  decoded keys.
+ *
+ *  plain bytes are decoded as themselves (0x00 - 0xFF),
+ *  function keys are above, optionally or'ed with modifiers.
+ */
+enum KeyCode {
+    KEY_NONE   = -1,     /**< no key decoded yet. */
+    KEY_UP     = 0x100,  /**< cursor up. */
+    KEY_DOWN,            /**< cursor down. */
+    KEY_RIGHT,           /**< cursor right. */
+    KEY_LEFT,            /**< cursor left. */
+    KEY_HOME,            /**< home. */
+    KEY_END,             /**< end. */
+    KEY_INSERT,          /**< insert. */
+    KEY_DELETE,          /**< delete. */
+    KEY_PGUP,            /**< page up. */
+    KEY_PGDN,            /**< page down. */
+    KEY_F1,              /**< function key 1, F2 - F12 follow. */
+    KEY_F12    = KEY_F1 + 11,
+
+    KEY_SHIFT  = 0x1000, /**< shift modifier. */
+    KEY_ALT    = 0x2000, /**< alt (meta) modifier. */
+    KEY_CTRL   = 0x4000, /**< control modifier. */
+    KEY_MODS   = KEY_SHIFT | KEY_ALT | KEY_CTRL,
+};
+
+/**
+ *  maximum number of CSI parameters kept.
+ */
+#define KEY_MAX_PARAMS (4)
+
+/**
+ *  milliseconds a lone ESC waits for the rest of a sequence.
+ */
+#define KEY_ESC_TIMEOUT_MS (50)
+
+/**
+ *  incremental VT100/xterm input decoder.
+ *
+ *  state survives between calls, so escape sequences split
+ *  across reads are decoded correctly.
+ */
+struct key_decoder {
+    int state;                      /**< decoder state. */
+    int params[KEY_MAX_PARAMS];     /**< CSI parameters. */
+    int nparams;                    /**< number of CSI parameters. */
+    uint64_t esc_ms;                /**< arrival of the ESC waiting for more. */
+};
+
+/**
+ *  reset decoder state.
+ */
+void key_decoder_init(struct key_decoder *dec);
+
+/**
+ *  feed one byte, which arrived at @c ms milliseconds.
+ *
+ *  returns decoded key, or KEY_NONE if the sequence is incomplete or ignored.
+ */
+int key_decode(struct key_decoder *dec, unsigned char c, uint64_t ms);
+
+/**
+ *  report the ESC waiting since @ref KEY_ESC_TIMEOUT_MS before @c ms as a key.
+ *
+ *  returns ESC, or KEY_NONE if none waits as long.
+ */
+int key_expire(struct key_decoder *dec, uint64_t ms);
+
+/**
+ *  milliseconds from @c ms until key_expire() reports the waiting ESC.
+ *
+ *  returns -1 if no ESC waits.
+ */
+int key_timeout(const struct key_decoder *dec, uint64_t ms);
+
+#endif /* __ECON_KEYS_H__ */
@@ -0,0 +1,120 @@
+/** @file       line.c
+ *  @brief      Gap buffer for line editing.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "ascii.h"
+#include "line.h"
+
+/**
+ *  initial storage size.
+ */
+#define LINE_INITIAL_SIZE (256)
+
+/**
+ *  grow storage to hold @c len more bytes (and a terminator).
+ */
+static int line_reserve(struct line_buffer *lb, size_t len)
+{
+    size_t gap_len = lb->gap_end - lb->gap;
+
+    if (gap_len > len) {
+        return 0;
+    }
+
+    size_t size = (lb->size > 0) ? lb->size : LINE_INITIAL_SIZE;
+    while (size - line_length(lb) <= len) {
+        size *= 2;
+    }
+    char *buf = realloc(lb->buf, size);
+    if (buf == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    size_t tail_len = lb->size - lb->gap_end;
+    memmove(&buf[size - tail_len], &buf[lb->gap_end], tail_len);
+    lb->buf = buf;
+    lb->gap_end = size - tail_len;
+    lb->size = size;
+
+    return 0;
+}
+
+void line_free(struct line_buffer *lb)
+{
+    free(lb->buf);
+    memset(lb, 0, sizeof(*lb));
+}
+
+void line_clear(struct line_buffer *lb)
+{
+    lb->gap = 0;
+    lb->gap_end = lb->size;
+}
+
+int line_insert(struct line_buffer *lb, const char *text, size_t len)
+{
+    if (line_reserve(lb, len) != 0) {
+        return -1;
+    }
+    memcpy(&lb->buf[lb->gap], text, len);
+    lb->gap += len;
+
+    return 0;
+}
+
+bool line_delete_before(struct line_buffer *lb)
+{
+    if (lb->gap == 0) {
+        return false;
+    }
+    --lb->gap;
+    return true;
+}
+
+bool line_delete_after(struct line_buffer *lb)
+{
+    if (lb->gap_end == lb->size) {
+        return false;
+    }
+    ++lb->gap_end;
+    return true;
+}
+
+void line_move(struct line_buffer *lb, size_t pos)
+{
+    if (pos > line_length(lb)) {
+        pos = line_length(lb);
+    }
+    if (pos < lb->gap) {
+        size_t len = lb->gap - pos;
+        memmove(&lb->buf[lb->gap_end - len], &lb->buf[pos], len);
+        lb->gap -= len;
+        lb->gap_end -= len;
+    } else if (pos > lb->gap) {
+        size_t len = pos - lb->gap;
+        memmove(&lb->buf[lb->gap], &lb->buf[lb->gap_end], len);
+        lb->gap += len;
+        lb->gap_end += len;
+    }
+}
+
+char *line_text(struct line_buffer *lb)
+{
+    if (line_reserve(lb, 0) != 0) {
+        return NULL;
+    }
+    line_move(lb, line_length(lb));
+    lb->buf[lb->gap] = NUL;
+
+    return lb->buf;
+}
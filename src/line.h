@@ -0,0 +1,99 @@
+/** @file       line.h
+ *  @brief      Gap buffer for line editing.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_LINE_H__
+#define __ECON_LINE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ *  edit line.
+ *
+ *  text before the cursor is kept at the head of @c buf and text after
+ *  the cursor at the tail, so that editing at the cursor costs O(1)
+ *  and moving the cursor costs the distance moved.
+ */
+struct line_buffer {
+    char *buf;          /**< storage. */
+    size_t size;        /**< storage size. */
+    size_t gap;         /**< gap start, also the cursor position. */
+    size_t gap_end;     /**< gap end. */
+};
+
+/**
+ *  release storage.
+ */
+void line_free(struct line_buffer *lb);
+
+/**
+ *  make the line empty.
+ */
+void line_clear(struct line_buffer *lb);
+
+/**
+ *  get line length.
+ */
+static inline size_t line_length(const struct line_buffer *lb)
+{
+    return lb->size - (lb->gap_end - lb->gap);
+}
+
+/**
+ *  get cursor position.
+ */
+static inline size_t line_cursor(const struct line_buffer *lb)
+{
+    return lb->gap;
+}
+
+/**
+ *  get character at @c pos.
+ */
+static inline char line_at(const struct line_buffer *lb, size_t pos)
+{
+    return (pos < lb->gap) ? lb->buf[pos] : lb->buf[pos + (lb->gap_end - lb->gap)];
+}
+
+/**
+ *  get text after the cursor. (not terminated)
+ */
+static inline const char *line_tail(const struct line_buffer *lb)
+{
+    return &lb->buf[lb->gap_end];
+}
+
+/**
+ *  insert @c len bytes at the cursor.
+ */
+int line_insert(struct line_buffer *lb, const char *text, size_t len);
+
+/**
+ *  delete the character before the cursor.
+ */
+bool line_delete_before(struct line_buffer *lb);
+
+/**
+ *  delete the character after the cursor.
+ */
+bool line_delete_after(struct line_buffer *lb);
+
+/**
+ *  move the cursor to @c pos.
+ */
+void line_move(struct line_buffer *lb, size_t pos);
+
+/**
+ *  get whole line as a terminated string.
+ *
+ *  the cursor is moved to the end of line.
+ */
+char *line_text(struct line_buffer *lb);
+
+#endif /* __ECON_LINE_H__ */
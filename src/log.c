@@ -0,0 +1,1294 @@
+/** @file       log.c
+ *  @brief      Asynchronous binary logger.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/syscall.h>
+
+#include "econ.h"
+#include "ascii.h"
+#include "utils.h"
+
+/**
+ *  per-thread ring size. (power of 2)
+ */
+#define LOG_RING_SIZE (64 * 1024)
+
+/**
+ *  longest string argument kept in a record.
+ */
+#define LOG_STRING_MAX (255)
+
+/**
+ *  background flush interval.
+ */
+#define LOG_FLUSH_INTERVAL_MS (100)
+
+/**
+ *  output is written when this much is encoded.
+ */
+#define LOG_BATCH_SIZE (64 * 1024)
+
+/**
+ *  longest decoded line.
+ */
+#define LOG_LINE_MAX (1024)
+
+/**
+ *  file magic.
+ */
+static const char log_magic[8] = {'E', 'C', 'O', 'N', 'L', 'O', 'G', '1'};
+
+/**
+ *  argument types.
+ */
+enum {
+    ARG_INT,
+    ARG_LONG,
+    ARG_LLONG,
+    ARG_INTMAX,
+    ARG_SIZE,
+    ARG_PTRDIFF,
+    ARG_DOUBLE,
+    ARG_LDOUBLE,
+    ARG_STRING,
+    ARG_POINTER,
+};
+
+/**
+ *  state of argument types in a site.
+ */
+enum {
+    SITE_NEW,
+    SITE_PARSING,
+    SITE_READY,
+};
+
+/**
+ *  output record tags.
+ */
+enum {
+    TAG_SITE = 'S',     /**< call site, written before its first event. */
+    TAG_EVENT = 'E',    /**< log event. */
+    TAG_DROP = 'D',     /**< events dropped by a full ring. */
+};
+
+/**
+ *  ring record kinds.
+ */
+enum {
+    RECORD_PAD,         /**< unused space up to the end of ring. */
+    RECORD_EVENT,       /**< log event. */
+};
+
+/**
+ *  ring record header, followed by encoded arguments.
+ *
+ *  integers, floats and pointers take 8 bytes each, strings a 2 bytes
+ *  length and the characters. records are padded to 8 bytes.
+ */
+struct log_record {
+    uint32_t size;                      /**< record size. */
+    uint16_t kind;                      /**< record kind. */
+    uint16_t args_len;                  /**< encoded arguments length. */
+    const struct econ_log_site *site;   /**< call site. */
+    uint64_t time;                      /**< monotonic time in nanoseconds. */
+};
+
+/**
+ *  single producer, single consumer ring of a thread.
+ */
+struct log_ring {
+    _Alignas(64) atomic_size_t head;    /**< written by the owner thread. */
+    _Alignas(64) atomic_size_t tail;    /**< written by the flusher. */
+    atomic_uint_fast64_t dropped;       /**< events lost to a full ring. */
+    atomic_bool dead;                   /**< owner thread exited. */
+    pid_t tid;                          /**< owner thread id. */
+    struct log_ring *next;              /**< next ring. */
+    _Alignas(8) unsigned char buf[LOG_RING_SIZE];
+};
+
+/**
+ *  encoded output.
+ */
+struct log_writer {
+    int fd;             /**< output, or -1 to keep in memory. */
+    unsigned char *buf; /**< encoded records. */
+    size_t len;         /**< encoded length. */
+    size_t cap;         /**< buffer capacity. */
+    uint32_t sites;     /**< sites already written. */
+};
+
+/**
+ *  logger state.
+ *
+ *  @c lock guards everything here. producers take it only to register
+ *  their ring.
+ */
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_once_t once;
+    pthread_key_t key;
+    struct log_ring *rings;         /**< registered rings. */
+    struct econ_log_site **sites;   /**< sites by id - 1. */
+    size_t nsites;
+    size_t sites_cap;
+    struct log_writer file;         /**< background output. */
+    char *path;                     /**< background output path. */
+    pthread_t thread;               /**< background flusher. */
+    bool running;
+} logger = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .once = PTHREAD_ONCE_INIT,
+    .file = {.fd = -1},
+};
+
+/**
+ *  ring of this thread.
+ */
+static _Thread_local struct log_ring *local_ring = NULL;
+
+/**
+ *  conversion specification.
+ */
+struct log_spec {
+    const char *begin;  /**< the '%'. */
+    const char *end;    /**< next to the conversion character. */
+    char length[3];     /**< length modifier. */
+    char conv;          /**< conversion character. */
+    int ntypes;         /**< arguments taken. */
+    unsigned char types[3];
+};
+
+/**
+ *  find the next conversion specification from @c p.
+ *
+ *  @return     returns next to the specification, or NULL at end of format.
+ */
+static const char *log_spec_next(const char *p, struct log_spec *spec)
+{
+    while ((p = strchr(p, '%')) != NULL) {
+        spec->begin = p++;
+        if (*p == '%') {
+            ++p;
+            continue;
+        }
+        spec->ntypes = 0;
+        p += strspn(p, "-+ #0'");
+        if (*p == '*') {
+            spec->types[spec->ntypes++] = ARG_INT;
+            ++p;
+        } else {
+            p += strspn(p, "0123456789");
+        }
+        if (*p == '.') {
+            ++p;
+            if (*p == '*') {
+                spec->types[spec->ntypes++] = ARG_INT;
+                ++p;
+            } else {
+                p += strspn(p, "0123456789");
+            }
+        }
+        size_t len = strspn(p, "hljztL");
+        if (len > 2) {
+            len = 2;
+        }
+        memcpy(spec->length, p, len);
+        spec->length[len] = NUL;
+        p += len;
+        if (*p == NUL) {
+            return NULL;
+        }
+        spec->conv = *p++;
+        spec->end = p;
+
+        int type;
+        switch (spec->conv) {
+        case 'c':
+            type = ARG_INT;
+            break;
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+            switch (spec->length[0]) {
+            case 'l':
+                type = (spec->length[1] == 'l') ? ARG_LLONG : ARG_LONG;
+                break;
+            case 'j':
+                type = ARG_INTMAX;
+                break;
+            case 'z':
+                type = ARG_SIZE;
+                break;
+            case 't':
+                type = ARG_PTRDIFF;
+                break;
+            default:
+                type = ARG_INT;
+                break;
+            }
+            break;
+        case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+            type = (spec->length[0] == 'L') ? ARG_LDOUBLE : ARG_DOUBLE;
+            break;
+        case 's':
+            type = (spec->length[0] == 'l') ? ARG_POINTER : ARG_STRING;
+            break;
+        case 'm':
+            return p;
+        default:
+            type = ARG_POINTER;
+            break;
+        }
+        spec->types[spec->ntypes++] = type;
+        return p;
+    }
+    return NULL;
+}
+
+/**
+ *  get argument types of @c format.
+ *
+ *  @return     returns number of arguments.
+ */
+static int log_parse(const char *format, unsigned char *types)
+{
+    struct log_spec spec;
+    int nargs = 0;
+
+    for (const char *p = format; (p = log_spec_next(p, &spec)) != NULL; ) {
+        for (int i = 0; (i < spec.ntypes) && (nargs < ECON_LOG_MAX_ARGS); ++i) {
+            types[nargs++] = spec.types[i];
+        }
+    }
+    return nargs;
+}
+
+/**
+ *  get argument types of @c site, parsing the format on first use.
+ */
+static const unsigned char *log_site_types(struct econ_log_site *site, unsigned char *local, int *nargs)
+{
+    int state = __atomic_load_n(&site->state, __ATOMIC_ACQUIRE);
+
+    if (state == SITE_READY) {
+        *nargs = site->nargs;
+        return site->types;
+    }
+
+    *nargs = log_parse(site->format, local);
+    state = SITE_NEW;
+    if (__atomic_compare_exchange_n(&site->state, &state, SITE_PARSING, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        memcpy(site->types, local, *nargs);
+        site->nargs = *nargs;
+        __atomic_store_n(&site->state, SITE_READY, __ATOMIC_RELEASE);
+    }
+    return local;
+}
+
+/**
+ *  mark the ring of an exiting thread.
+ */
+static void log_ring_exit(void *arg)
+{
+    struct log_ring *ring = arg;
+
+    local_ring = NULL;
+    atomic_store_explicit(&ring->dead, true, memory_order_release);
+}
+
+static void log_init_once(void)
+{
+    pthread_key_create(&logger.key, log_ring_exit);
+}
+
+/**
+ *  create and register ring of this thread.
+ */
+static struct log_ring *log_ring_create(void)
+{
+    struct log_ring *ring;
+
+    pthread_once(&logger.once, log_init_once);
+    if (posix_memalign((void **)&ring, 64, sizeof(*ring)) != 0) {
+        return NULL;
+    }
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->dropped, 0);
+    atomic_init(&ring->dead, false);
+    ring->tid = (pid_t)syscall(SYS_gettid);
+
+    pthread_mutex_lock(&logger.lock);
+    ring->next = logger.rings;
+    logger.rings = ring;
+    pthread_mutex_unlock(&logger.lock);
+
+    pthread_setspecific(logger.key, ring);
+    local_ring = ring;
+    return ring;
+}
+
+/**
+ *  reserve @c size contiguous bytes in @c ring.
+ *
+ *  @return     returns reserved space, or NULL if the ring is full.
+ */
+static unsigned char *log_ring_reserve(struct log_ring *ring, size_t size, size_t *head)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t off;
+
+    *head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    off = *head & (LOG_RING_SIZE - 1);
+    size_t pad = (LOG_RING_SIZE - off < size) ? (LOG_RING_SIZE - off) : 0;
+    if (LOG_RING_SIZE - (*head - tail) < pad + size) {
+        return NULL;
+    }
+    if (pad > 0) {
+        struct log_record *rec = (struct log_record *)&ring->buf[off];
+        rec->size = pad;
+        rec->kind = RECORD_PAD;
+        *head += pad;
+        off = 0;
+    }
+    return &ring->buf[off];
+}
+
+void econ_log_record(struct econ_log_site *site, ...)
+{
+    struct log_ring *ring = local_ring;
+    unsigned char local[ECON_LOG_MAX_ARGS];
+    const unsigned char *types;
+    struct timespec ts;
+    va_list ap;
+    int nargs;
+
+    if ((ring == NULL) && ((ring = log_ring_create()) == NULL)) {
+        return;
+    }
+    types = log_site_types(site, local, &nargs);
+
+    /* strings are copied, so their lengths are needed before reserving. */
+    size_t args_len = nargs * sizeof(uint64_t);
+    if (memchr(types, ARG_STRING, nargs) != NULL) {
+        args_len = 0;
+        va_start(ap, site);
+        for (int i = 0; i < nargs; ++i) {
+            if (types[i] == ARG_STRING) {
+                const char *str = va_arg(ap, const char *);
+                args_len += sizeof(uint16_t) + strnlen((str != NULL) ? str : "(null)", LOG_STRING_MAX);
+                continue;
+            } else if (types[i] == ARG_LDOUBLE) {
+                (void)va_arg(ap, long double);
+            } else if (types[i] == ARG_DOUBLE) {
+                (void)va_arg(ap, double);
+            } else if (types[i] == ARG_INT) {
+                (void)va_arg(ap, int);
+            } else if ((types[i] == ARG_LLONG) || (types[i] == ARG_INTMAX)) {
+                (void)va_arg(ap, long long);
+            } else {
+                (void)va_arg(ap, void *);
+            }
+            args_len += sizeof(uint64_t);
+        }
+        va_end(ap);
+    }
+
+    size_t head;
+    size_t size = (sizeof(struct log_record) + args_len + 7) & ~(size_t)7;
+    unsigned char *p = log_ring_reserve(ring, size, &head);
+    if (p == NULL) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    struct log_record *rec = (struct log_record *)p;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    rec->size = size;
+    rec->kind = RECORD_EVENT;
+    rec->args_len = args_len;
+    rec->site = site;
+    rec->time = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    p += sizeof(*rec);
+
+    va_start(ap, site);
+    for (int i = 0; i < nargs; ++i) {
+        uint64_t v;
+
+        switch (types[i]) {
+        case ARG_STRING: {
+            const char *str = va_arg(ap, const char *);
+            if (str == NULL) {
+                str = "(null)";
+            }
+            uint16_t len = strnlen(str, LOG_STRING_MAX);
+            memcpy(p, &len, sizeof(len));
+            memcpy(p + sizeof(len), str, len);
+            p += sizeof(len) + len;
+            continue;
+        }
+        case ARG_INT:
+            v = (int64_t)va_arg(ap, int);
+            break;
+        case ARG_LONG:
+            v = (int64_t)va_arg(ap, long);
+            break;
+        case ARG_LLONG:
+            v = (int64_t)va_arg(ap, long long);
+            break;
+        case ARG_INTMAX:
+            v = (int64_t)va_arg(ap, intmax_t);
+            break;
+        case ARG_SIZE:
+            v = (uint64_t)va_arg(ap, size_t);
+            break;
+        case ARG_PTRDIFF:
+            v = (int64_t)va_arg(ap, ptrdiff_t);
+            break;
+        case ARG_DOUBLE: {
+            double d = va_arg(ap, double);
+            memcpy(&v, &d, sizeof(v));
+            break;
+        }
+        case ARG_LDOUBLE: {
+            double d = (double)va_arg(ap, long double);
+            memcpy(&v, &d, sizeof(v));
+            break;
+        }
+        default:
+            v = (uintptr_t)va_arg(ap, void *);
+            break;
+        }
+        memcpy(p, &v, sizeof(v));
+        p += sizeof(v);
+    }
+    va_end(ap);
+
+    atomic_store_explicit(&ring->head, head + size, memory_order_release);
+}
+
+/**
+ *  write whole buffer to @c fd.
+ */
+static int log_write_all(int fd, const void *buf, size_t len)
+{
+    const char *p = buf;
+
+    while (len > 0) {
+        ssize_t ret = write(fd, p, len);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += ret;
+        len -= ret;
+    }
+    return 0;
+}
+
+/**
+ *  write out encoded records of a file writer.
+ */
+static int log_writer_flush(struct log_writer *w)
+{
+    int ret = 0;
+
+    if ((w->fd >= 0) && (w->len > 0)) {
+        ret = log_write_all(w->fd, w->buf, w->len);
+        w->len = 0;
+    }
+    return ret;
+}
+
+/**
+ *  append @c len bytes to writer.
+ */
+static int log_put(struct log_writer *w, const void *data, size_t len)
+{
+    if (w->len + len > w->cap) {
+        size_t cap = (w->cap > 0) ? w->cap : LOG_BATCH_SIZE;
+        while (cap < w->len + len) {
+            cap *= 2;
+        }
+        unsigned char *buf = realloc(w->buf, cap);
+        if (buf == NULL) {
+            errno = ENOMEM;
+            return -1;
+        }
+        w->buf = buf;
+        w->cap = cap;
+    }
+    memcpy(&w->buf[w->len], data, len);
+    w->len += len;
+    return 0;
+}
+
+static int log_put_u8(struct log_writer *w, uint8_t v)
+{
+    return log_put(w, &v, sizeof(v));
+}
+
+static int log_put_u16(struct log_writer *w, uint16_t v)
+{
+    return log_put(w, &v, sizeof(v));
+}
+
+static int log_put_u32(struct log_writer *w, uint32_t v)
+{
+    return log_put(w, &v, sizeof(v));
+}
+
+static int log_put_u64(struct log_writer *w, uint64_t v)
+{
+    return log_put(w, &v, sizeof(v));
+}
+
+static int log_put_string(struct log_writer *w, const char *str)
+{
+    size_t len = strnlen(str, UINT16_MAX);
+
+    return log_put_u16(w, len) | log_put(w, str, len);
+}
+
+/**
+ *  start writer output with the file header.
+ */
+static int log_writer_init(struct log_writer *w, int fd)
+{
+    struct timespec real;
+    struct timespec mono;
+
+    memset(w, 0, sizeof(*w));
+    w->fd = fd;
+    clock_gettime(CLOCK_REALTIME, &real);
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    int64_t offset = ((int64_t)real.tv_sec - mono.tv_sec) * 1000000000LL
+                     + (real.tv_nsec - mono.tv_nsec);
+
+    return log_put(w, log_magic, sizeof(log_magic)) | log_put_u64(w, offset);
+}
+
+/**
+ *  write sites up to @c id not yet written by @c w.
+ */
+static int log_put_sites(struct log_writer *w, uint32_t id)
+{
+    unsigned char local[ECON_LOG_MAX_ARGS];
+    int ret = 0;
+
+    for (; w->sites < id; ++w->sites) {
+        struct econ_log_site *site = logger.sites[w->sites];
+        int nargs;
+        const unsigned char *types = log_site_types(site, local, &nargs);
+
+        ret |= log_put_u8(w, TAG_SITE);
+        ret |= log_put_u32(w, site->id);
+        ret |= log_put_u8(w, site->level);
+        ret |= log_put_u32(w, site->line);
+        ret |= log_put_string(w, site->file);
+        ret |= log_put_string(w, site->func);
+        ret |= log_put_string(w, site->format);
+        ret |= log_put_u8(w, nargs);
+        ret |= log_put(w, types, nargs);
+    }
+    return ret;
+}
+
+/**
+ *  give @c site an output id.
+ */
+static int log_register_site(struct econ_log_site *site)
+{
+    if (logger.nsites == logger.sites_cap) {
+        size_t cap = (logger.sites_cap > 0) ? logger.sites_cap * 2 : 64;
+        struct econ_log_site **sites = realloc(logger.sites, cap * sizeof(*sites));
+        if (sites == NULL) {
+            errno = ENOMEM;
+            return -1;
+        }
+        logger.sites = sites;
+        logger.sites_cap = cap;
+    }
+    logger.sites[logger.nsites++] = site;
+    site->id = logger.nsites;
+    return 0;
+}
+
+/**
+ *  move records of all rings to @c w.
+ *
+ *  called with @c logger.lock held.
+ */
+static int log_drain(struct log_writer *w)
+{
+    struct log_ring **link = &logger.rings;
+    int ret = 0;
+
+    while (*link != NULL) {
+        struct log_ring *ring = *link;
+        bool dead = atomic_load_explicit(&ring->dead, memory_order_acquire);
+        size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+        while ((tail != head) && (ret == 0)) {
+            struct log_record *rec = (struct log_record *)&ring->buf[tail & (LOG_RING_SIZE - 1)];
+
+            if (rec->kind == RECORD_EVENT) {
+                struct econ_log_site *site = (struct econ_log_site *)rec->site;
+                if ((site->id == 0) && (log_register_site(site) != 0)) {
+                    ret = -1;
+                    break;
+                }
+                ret |= log_put_sites(w, site->id);
+                ret |= log_put_u8(w, TAG_EVENT);
+                ret |= log_put_u32(w, site->id);
+                ret |= log_put_u32(w, ring->tid);
+                ret |= log_put_u64(w, rec->time);
+                ret |= log_put_u16(w, rec->args_len);
+                ret |= log_put(w, rec + 1, rec->args_len);
+            }
+            tail += rec->size;
+            if (w->len >= LOG_BATCH_SIZE) {
+                ret |= log_writer_flush(w);
+            }
+        }
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+
+        uint64_t dropped = atomic_exchange_explicit(&ring->dropped, 0, memory_order_relaxed);
+        if (dropped > 0) {
+            ret |= log_put_u8(w, TAG_DROP);
+            ret |= log_put_u32(w, ring->tid);
+            ret |= log_put_u64(w, dropped);
+        }
+
+        if (dead && (tail == head)) {
+            *link = ring->next;
+            free(ring);
+        } else {
+            link = &ring->next;
+        }
+    }
+    return ret | log_writer_flush(w);
+}
+
+/**
+ *  background flusher.
+ */
+static void *log_flusher(void *arg)
+{
+    pthread_mutex_lock(&logger.lock);
+    while (logger.running) {
+        struct timespec deadline;
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += LOG_FLUSH_INTERVAL_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            ++deadline.tv_sec;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&logger.cond, &logger.lock, &deadline);
+        if (log_drain(&logger.file) != 0) {
+            perror("log");
+        }
+    }
+    pthread_mutex_unlock(&logger.lock);
+
+    return NULL;
+}
+
+/**
+ *  open background output.
+ *
+ *  @details    records are written to @c path in batches by a background
+ *              thread, every @ref LOG_FLUSH_INTERVAL_MS milliseconds.
+ *              records made before are written first.
+ *  @param      [in]    path    output file path.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_log_open(const char *path)
+{
+    int ret = -1;
+
+    pthread_mutex_lock(&logger.lock);
+    if (logger.running) {
+        errno = EBUSY;
+        goto unlock;
+    }
+    size_t len = strlen(path);
+    logger.path = malloc(len + 1);
+    if (logger.path == NULL) {
+        errno = ENOMEM;
+        goto unlock;
+    }
+    memcpy(logger.path, path, len + 1);
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        goto free_path;
+    }
+    if ((log_writer_init(&logger.file, fd) != 0) || (log_writer_flush(&logger.file) != 0)) {
+        goto close_fd;
+    }
+    logger.running = true;
+    int err = pthread_create(&logger.thread, NULL, log_flusher, NULL);
+    if (err != 0) {
+        logger.running = false;
+        errno = err;
+        goto close_fd;
+    }
+    pthread_mutex_unlock(&logger.lock);
+
+    return 0;
+
+close_fd:
+    free(logger.file.buf);
+    logger.file.buf = NULL;
+    logger.file.fd = -1;
+    close(fd);
+free_path:
+    free(logger.path);
+    logger.path = NULL;
+unlock:
+    pthread_mutex_unlock(&logger.lock);
+
+    return ret;
+}
+
+/**
+ *  write pending records and close background output.
+ *
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_log_close(void)
+{
+    pthread_mutex_lock(&logger.lock);
+    if (!logger.running) {
+        pthread_mutex_unlock(&logger.lock);
+        errno = EBADF;
+        return -1;
+    }
+    logger.running = false;
+    pthread_cond_signal(&logger.cond);
+    pthread_mutex_unlock(&logger.lock);
+    pthread_join(logger.thread, NULL);
+
+    pthread_mutex_lock(&logger.lock);
+    int ret = log_drain(&logger.file);
+    close(logger.file.fd);
+    free(logger.file.buf);
+    memset(&logger.file, 0, sizeof(logger.file));
+    logger.file.fd = -1;
+    free(logger.path);
+    logger.path = NULL;
+    pthread_mutex_unlock(&logger.lock);
+
+    return ret;
+}
+
+/**
+ *  write pending records to background output now.
+ *
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_log_flush(void)
+{
+    int ret;
+
+    pthread_mutex_lock(&logger.lock);
+    if (logger.running) {
+        ret = log_drain(&logger.file);
+    } else {
+        errno = EBADF;
+        ret = -1;
+    }
+    pthread_mutex_unlock(&logger.lock);
+
+    return ret;
+}
+
+/**
+ *  decoded site.
+ */
+struct log_site_entry {
+    int level;
+    uint32_t line;
+    char *file;
+    char *func;
+    char *format;
+    int nargs;
+    unsigned char types[ECON_LOG_MAX_ARGS];
+};
+
+/**
+ *  decoder state.
+ */
+struct log_decoder {
+    bool header;                    /**< file header is read. */
+    int64_t offset;                 /**< realtime minus monotonic time. */
+    struct log_site_entry *sites;   /**< sites by id - 1. */
+    size_t nsites;
+    void (*output)(void *, const char *);   /**< line output. */
+    void *ctx;                      /**< output context. */
+};
+
+/**
+ *  input cursor.
+ */
+struct log_cursor {
+    const unsigned char *p;
+    const unsigned char *end;
+};
+
+static bool log_get(struct log_cursor *c, void *data, size_t len)
+{
+    if ((size_t)(c->end - c->p) < len) {
+        return false;
+    }
+    memcpy(data, c->p, len);
+    c->p += len;
+    return true;
+}
+
+static bool log_get_string(struct log_cursor *c, char **str)
+{
+    uint16_t len;
+
+    if (!log_get(c, &len, sizeof(len)) || ((size_t)(c->end - c->p) < len)) {
+        return false;
+    }
+    if (str != NULL) {
+        *str = malloc(len + 1);
+        if (*str != NULL) {
+            memcpy(*str, c->p, len);
+            (*str)[len] = NUL;
+        }
+    }
+    c->p += len;
+    return true;
+}
+
+/**
+ *  truncate integer argument to the type of its conversion.
+ */
+static long long log_integer(uint64_t v, const struct log_spec *spec, bool sign)
+{
+    const char *len = spec->length;
+
+    if (strcmp(len, "hh") == 0) {
+        return sign ? (long long)(signed char)v : (long long)(unsigned char)v;
+    } else if (strcmp(len, "h") == 0) {
+        return sign ? (long long)(short)v : (long long)(unsigned short)v;
+    } else if (len[0] == NUL) {
+        return sign ? (long long)(int)v : (long long)(unsigned int)v;
+    } else if (strcmp(len, "l") == 0) {
+        return sign ? (long long)(long)v : (long long)(unsigned long)v;
+    } else if (strcmp(len, "z") == 0) {
+        return sign ? (long long)(ssize_t)v : (long long)(size_t)v;
+    } else if (strcmp(len, "t") == 0) {
+        return (long long)(ptrdiff_t)v;
+    }
+    return (long long)v;
+}
+
+/**
+ *  format an event into @c line.
+ */
+static void log_format(const struct log_site_entry *site, struct log_cursor *args, char *line, size_t size)
+{
+    struct log_spec spec;
+    const char *fmt = site->format;
+    size_t pos = 0;
+    int arg = 0;
+
+#define LOG_APPEND(...)                                                   \
+    do {                                                                  \
+        if (pos < size) {                                                 \
+            int n = snprintf(&line[pos], size - pos, __VA_ARGS__);        \
+            pos = (n > 0) ? pos + n : pos;                                \
+        }                                                                 \
+    } while (0)
+
+    for (const char *p = fmt; ; fmt = p) {
+        p = log_spec_next(p, &spec);
+        const char *lit_end = (p != NULL) ? spec.begin : (fmt + strlen(fmt));
+
+        /* literal text, with "%%" turned to '%'. */
+        for (const char *q = fmt; q < lit_end; ++q) {
+            if ((q[0] == '%') && (q[1] == '%')) {
+                ++q;
+            }
+            LOG_APPEND("%c", *q);
+        }
+        if (p == NULL) {
+            break;
+        }
+
+        /* rebuild the specification with '*' expanded and no length modifier. */
+        char text[64];
+        size_t tlen = 0;
+        uint64_t values[3] = {0};
+        const char *strs = NULL;
+        uint16_t slen = 0;
+        bool missing = false;
+
+        for (int i = 0; i < spec.ntypes; ++i, ++arg) {
+            if (arg >= site->nargs) {
+                missing = true;
+            } else if (site->types[arg] == ARG_STRING) {
+                if (!log_get(args, &slen, sizeof(slen)) || ((size_t)(args->end - args->p) < slen)) {
+                    missing = true;
+                } else {
+                    strs = (const char *)args->p;
+                    args->p += slen;
+                }
+            } else if (!log_get(args, &values[i], sizeof(values[i]))) {
+                missing = true;
+            }
+        }
+        if (missing) {
+            LOG_APPEND("?");
+            continue;
+        }
+
+        int star = 0;
+        for (const char *q = spec.begin; (q < spec.end - 1 - strlen(spec.length)) && (tlen < sizeof(text) - 24); ++q) {
+            if (*q == '*') {
+                tlen += snprintf(&text[tlen], sizeof(text) - tlen, "%d", (int)values[star++]);
+            } else {
+                text[tlen++] = *q;
+            }
+        }
+
+        uint64_t v = values[spec.ntypes - 1];
+        switch (spec.conv) {
+        case 'd':
+        case 'i':
+            snprintf(&text[tlen], sizeof(text) - tlen, "ll%c", spec.conv);
+            LOG_APPEND(text, log_integer(v, &spec, true));
+            break;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            snprintf(&text[tlen], sizeof(text) - tlen, "ll%c", spec.conv);
+            LOG_APPEND(text, (unsigned long long)log_integer(v, &spec, false));
+            break;
+        case 'c':
+            snprintf(&text[tlen], sizeof(text) - tlen, "c");
+            LOG_APPEND(text, (int)v);
+            break;
+        case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A': {
+            double d;
+            memcpy(&d, &v, sizeof(d));
+            snprintf(&text[tlen], sizeof(text) - tlen, "%c", spec.conv);
+            LOG_APPEND(text, d);
+            break;
+        }
+        case 's':
+            if (strs != NULL) {
+                char str[LOG_STRING_MAX + 1];
+                size_t n = (slen < sizeof(str)) ? slen : (sizeof(str) - 1);
+
+                memcpy(str, strs, n);
+                str[n] = NUL;
+                snprintf(&text[tlen], sizeof(text) - tlen, "s");
+                LOG_APPEND(text, str);
+                break;
+            }
+            /* fall through */
+        case 'p':
+            LOG_APPEND("%p", (void *)(uintptr_t)v);
+            break;
+        default:
+            break;
+        }
+    }
+#undef LOG_APPEND
+}
+
+/**
+ *  decode records in @c buf.
+ *
+ *  @return     returns bytes consumed, a record cut at the end is left.
+ *              on malformed input, -1 is returned.
+ */
+static ssize_t log_decode_buffer(struct log_decoder *dec, const unsigned char *buf, size_t len)
+{
+    static const char levels[] = "EWID";
+    struct log_cursor c = {.p = buf, .end = buf + len};
+    const unsigned char *done = buf;
+    char line[LOG_LINE_MAX];
+
+    if (!dec->header) {
+        char magic[sizeof(log_magic)];
+        if (!log_get(&c, magic, sizeof(magic)) || !log_get(&c, &dec->offset, sizeof(dec->offset))) {
+            return 0;
+        }
+        if (memcmp(magic, log_magic, sizeof(magic)) != 0) {
+            errno = EINVAL;
+            return -1;
+        }
+        dec->header = true;
+        done = c.p;
+    }
+
+    for (uint8_t tag; log_get(&c, &tag, sizeof(tag)); done = c.p) {
+        if (tag == TAG_SITE) {
+            struct log_site_entry site = {0};
+            uint32_t id;
+            uint8_t level;
+            uint8_t nargs;
+
+            if (!log_get(&c, &id, sizeof(id)) || !log_get(&c, &level, sizeof(level))
+                || !log_get(&c, &site.line, sizeof(site.line))
+                || !log_get_string(&c, NULL) || !log_get_string(&c, NULL) || !log_get_string(&c, NULL)
+                || !log_get(&c, &nargs, sizeof(nargs)) || (nargs > ECON_LOG_MAX_ARGS)
+                || !log_get(&c, site.types, nargs)) {
+                break;
+            }
+            if (id != dec->nsites + 1) {
+                errno = EINVAL;
+                return -1;
+            }
+            /* whole record is here, read strings again to keep them. */
+            c.p = done + 1 + sizeof(id) + sizeof(level) + sizeof(site.line);
+            log_get_string(&c, &site.file);
+            log_get_string(&c, &site.func);
+            log_get_string(&c, &site.format);
+            c.p += sizeof(nargs) + nargs;
+            site.level = level;
+            site.nargs = nargs;
+
+            struct log_site_entry *sites = realloc(dec->sites, (dec->nsites + 1) * sizeof(*sites));
+            if ((sites == NULL) || (site.file == NULL) || (site.func == NULL) || (site.format == NULL)) {
+                free(site.file);
+                free(site.func);
+                free(site.format);
+                errno = ENOMEM;
+                return -1;
+            }
+            dec->sites = sites;
+            dec->sites[dec->nsites++] = site;
+        } else if (tag == TAG_EVENT) {
+            uint32_t id;
+            uint32_t tid;
+            uint64_t time;
+            uint16_t args_len;
+
+            if (!log_get(&c, &id, sizeof(id)) || !log_get(&c, &tid, sizeof(tid))
+                || !log_get(&c, &time, sizeof(time)) || !log_get(&c, &args_len, sizeof(args_len))
+                || ((size_t)(c.end - c.p) < args_len)) {
+                break;
+            }
+            if ((id == 0) || (id > dec->nsites)) {
+                errno = EINVAL;
+                return -1;
+            }
+            const struct log_site_entry *site = &dec->sites[id - 1];
+            struct log_cursor args = {.p = c.p, .end = c.p + args_len};
+            c.p += args_len;
+
+            int64_t real = (int64_t)time + dec->offset;
+            time_t sec = real / 1000000000LL;
+            struct tm tm;
+            localtime_r(&sec, &tm);
+            int n = snprintf(line, sizeof(line), "%02d:%02d:%02d.%06ld %5u %c %s:%u %s: ",
+                             tm.tm_hour, tm.tm_min, tm.tm_sec, (long)((real % 1000000000LL) / 1000),
+                             tid, (site->level < (int)strlen(levels)) ? levels[site->level] : '?',
+                             site->file, site->line, site->func);
+            if ((n > 0) && ((size_t)n < sizeof(line))) {
+                log_format(site, &args, &line[n], sizeof(line) - n);
+            }
+            dec->output(dec->ctx, line);
+        } else if (tag == TAG_DROP) {
+            uint32_t tid;
+            uint64_t count;
+
+            if (!log_get(&c, &tid, sizeof(tid)) || !log_get(&c, &count, sizeof(count))) {
+                break;
+            }
+            snprintf(line, sizeof(line), "*** %5u dropped %" PRIu64 " records", tid, count);
+            dec->output(dec->ctx, line);
+        } else {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    return done - buf;
+}
+
+static void log_decoder_free(struct log_decoder *dec)
+{
+    for (size_t i = 0; i < dec->nsites; ++i) {
+        free(dec->sites[i].file);
+        free(dec->sites[i].func);
+        free(dec->sites[i].format);
+    }
+    free(dec->sites);
+}
+
+/**
+ *  write a decoded line to a file descriptor.
+ */
+static void log_output_fd(void *ctx, const char *line)
+{
+    int fd = *(int *)ctx;
+    size_t len = strlen(line);
+
+    if ((log_write_all(fd, line, len) != 0) || (log_write_all(fd, "\n", 1) != 0)) {
+        perror("log");
+    }
+}
+
+/**
+ *  decode a log file.
+ *
+ *  @details    reads records written by econ_log_open() from @c in_fd
+ *              and writes them to @c out_fd as text, one per line.
+ *  @param      [in]    in_fd   binary log input.
+ *  @param      [in]    out_fd  text output.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_log_decode(int in_fd, int out_fd)
+{
+    struct log_decoder dec = {.output = log_output_fd, .ctx = &out_fd};
+    unsigned char *buf = malloc(LOG_BATCH_SIZE);
+    size_t cap = LOG_BATCH_SIZE;
+    size_t len = 0;
+    int ret = 0;
+
+    if (buf == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    for (;;) {
+        if (len == cap) {
+            /* a record larger than the buffer. */
+            unsigned char *bigger = realloc(buf, cap * 2);
+            if (bigger == NULL) {
+                errno = ENOMEM;
+                ret = -1;
+                break;
+            }
+            buf = bigger;
+            cap *= 2;
+        }
+        ssize_t n = read(in_fd, &buf[len], cap - len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ret = -1;
+            break;
+        } else if (n == 0) {
+            if (len > 0) {
+                errno = EINVAL;
+                ret = -1;
+            }
+            break;
+        }
+        len += n;
+
+        ssize_t used = log_decode_buffer(&dec, buf, len);
+        if (used < 0) {
+            ret = -1;
+            break;
+        }
+        memmove(buf, &buf[used], len - used);
+        len -= used;
+    }
+    log_decoder_free(&dec);
+    free(buf);
+
+    return ret;
+}
+
+/**
+ *  print a decoded line on the console.
+ */
+static void log_output_console(void *ctx, const char *line)
+{
+    econ_printf("%s\r\n", line);
+}
+
+void econ_log_usage(const char *name)
+{
+    econ_printf("usage: %s [open path | close]\r\n", name);
+}
+
+/**
+ *  log command.
+ *
+ *  @details    without arguments, pending records are written to the
+ *              background output, or printed if it is not open.
+ *              "open" and "close" control background output.
+ *  @param      [in]    argc    argument count.
+ *  @param      [in]    argv    argument values.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned.
+ */
+int econ_log_command(int argc, char **argv)
+{
+    if ((argc == 3) && (strcmp(argv[1], "open") == 0)) {
+        if (econ_log_open(argv[2]) != 0) {
+            econ_printf("%s: %s: %s\r\n", argv[0], argv[2], strerror(errno));
+        }
+        return 0;
+    } else if ((argc == 2) && (strcmp(argv[1], "close") == 0)) {
+        if (econ_log_close() != 0) {
+            econ_printf("%s: %s\r\n", argv[0], strerror(errno));
+        }
+        return 0;
+    } else if (argc != 1) {
+        return -1;
+    }
+
+    struct log_writer w;
+    int ret = 0;
+
+    pthread_mutex_lock(&logger.lock);
+    if (logger.running) {
+        ret = log_drain(&logger.file);
+        econ_printf("%s: written to %s\r\n", argv[0], logger.path);
+        pthread_mutex_unlock(&logger.lock);
+        return ret;
+    }
+    ret = log_writer_init(&w, -1) | log_drain(&w);
+    pthread_mutex_unlock(&logger.lock);
+
+    if (ret == 0) {
+        struct log_decoder dec = {.output = log_output_console};
+        ret = (log_decode_buffer(&dec, w.buf, w.len) < 0) ? -1 : 0;
+        log_decoder_free(&dec);
+    }
+    free(w.buf);
+
+    return ret;
+}
@@ -0,0 +1,546 @@
+/** @file       registry.c
+ *  @brief      Command registry (prefix trie index).
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "econ.h"
+#include "ascii.h"
+#include "args.h"
+#include "complete.h"
+#include "registry.h"
+#include "suggest.h"
+#include "debug.h"
+#include "utils.h"
+
+struct trie_node;
+
+/**
+ *  trie edge.
+ */
+struct trie_edge {
+    unsigned char key;      /**< edge character. */
+    struct trie_node *node; /**< child node. */
+};
+
+/**
+ *  trie node.
+ *
+ *  edges are kept sorted by @c key, so that one step of lookup is
+ *  a binary search bounded by the size of the alphabet.
+ */
+struct trie_node {
+    struct trie_edge *edges;        /**< child edges. */
+    size_t count;                   /**< number of edges. */
+    size_t capacity;                /**< allocated edges. */
+    struct registry_entry *entry;   /**< command terminated at this node. */
+};
+
+/**
+ *  registered command.
+ */
+struct registry_entry {
+    struct econ_command cmd;    /**< copy of the command. */
+    struct econ_registry *sub;  /**< sub-command level. */
+    size_t length;              /**< length of command name. */
+};
+
+/**
+ *  command registry (one level of the command tree).
+ */
+struct econ_registry {
+    struct trie_node root;              /**< trie root. */
+    struct registry_entry **entries;    /**< entries in registration order. */
+    size_t count;                       /**< number of entries. */
+    size_t capacity;                    /**< allocated entries. */
+    int col_length;                     /**< longest command name. */
+    struct registry_entry **sorted;     /**< entries in name order, or NULL if stale. */
+    struct suggest_index *suggest;      /**< names indexed for suggestions, or NULL if stale. */
+};
+
+static void entry_destroy(struct registry_entry *entry);
+
+/**
+ *  find the edge index of @c key, or the insertion point.
+ */
+static size_t node_search(const struct trie_node *node, unsigned char key, bool *found)
+{
+    size_t lo = 0, hi = node->count;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (node->edges[mid].key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *found = (lo < node->count) && (node->edges[lo].key == key);
+    return lo;
+}
+
+static struct trie_node *node_child(const struct trie_node *node, unsigned char key)
+{
+    bool found;
+    size_t idx = node_search(node, key, &found);
+
+    return found ? node->edges[idx].node : NULL;
+}
+
+static struct trie_node *node_child_create(struct trie_node *node, unsigned char key)
+{
+    bool found;
+    size_t idx = node_search(node, key, &found);
+
+    if (found) {
+        return node->edges[idx].node;
+    }
+
+    if (node->count == node->capacity) {
+        size_t capacity = (node->capacity > 0) ? node->capacity * 2 : 2;
+        struct trie_edge *edges = realloc(node->edges, sizeof(*edges) * capacity);
+        if (edges == NULL) {
+            return NULL;
+        }
+        node->edges = edges;
+        node->capacity = capacity;
+    }
+
+    struct trie_node *child = calloc(1, sizeof(*child));
+    if (child == NULL) {
+        return NULL;
+    }
+    memmove(&node->edges[idx + 1], &node->edges[idx],
+            sizeof(node->edges[0]) * (node->count - idx));
+    node->edges[idx].key = key;
+    node->edges[idx].node = child;
+    ++node->count;
+
+    return child;
+}
+
+static void node_cleanup(struct trie_node *node)
+{
+    for (size_t i = 0; i < node->count; ++i) {
+        node_cleanup(node->edges[i].node);
+        free(node->edges[i].node);
+    }
+    free(node->edges);
+    node->edges = NULL;
+    node->count = node->capacity = 0;
+    if (node->entry != NULL) {
+        entry_destroy(node->entry);
+        node->entry = NULL;
+    }
+}
+
+/**
+ *  detach the entry of @c name, pruning nodes left empty.
+ *
+ *  @return     returns detached entry, or NULL if not found.
+ */
+static struct registry_entry *node_remove(struct trie_node *node, const char *name)
+{
+    if (*name == NUL) {
+        struct registry_entry *entry = node->entry;
+        node->entry = NULL;
+        return entry;
+    }
+
+    bool found;
+    size_t idx = node_search(node, (unsigned char)*name, &found);
+    if (!found) {
+        return NULL;
+    }
+
+    struct trie_node *child = node->edges[idx].node;
+    struct registry_entry *entry = node_remove(child, name + 1);
+    if ((entry != NULL) && (child->count == 0) && (child->entry == NULL)) {
+        free(child->edges);
+        free(child);
+        memmove(&node->edges[idx], &node->edges[idx + 1],
+                sizeof(node->edges[0]) * (node->count - idx - 1));
+        --node->count;
+    }
+    return entry;
+}
+
+static void entry_destroy(struct registry_entry *entry)
+{
+    if (entry->sub != NULL) {
+        econ_registry_destroy(entry->sub);
+    }
+    free(entry);
+}
+
+static void update_col_length(struct econ_registry *reg)
+{
+    reg->col_length = 0;
+    for (size_t i = 0; i < reg->count; ++i) {
+        if ((int)reg->entries[i]->length > reg->col_length) {
+            reg->col_length = reg->entries[i]->length;
+        }
+    }
+}
+
+static int compare_entry(const void *a, const void *b)
+{
+    const struct registry_entry *ea = *(struct registry_entry *const *)a;
+    const struct registry_entry *eb = *(struct registry_entry *const *)b;
+
+    return strcmp(ea->cmd.command, eb->cmd.command);
+}
+
+/**
+ *  get entries in name order, built once after every change.
+ *
+ *  commands sharing a prefix are adjacent, so candidates of
+ *  a prefix are found by one binary search.
+ */
+static struct registry_entry **registry_sorted(struct econ_registry *reg)
+{
+    if (reg->sorted == NULL) {
+        reg->sorted = malloc(sizeof(*reg->sorted) * (reg->count + 1));
+        if (reg->sorted == NULL) {
+            return NULL;
+        }
+        memcpy(reg->sorted, reg->entries, sizeof(*reg->sorted) * reg->count);
+        qsort(reg->sorted, reg->count, sizeof(*reg->sorted), compare_entry);
+    }
+    return reg->sorted;
+}
+
+/**
+ *  get names indexed for suggestions, built once after every change.
+ */
+static struct suggest_index *registry_suggest(struct econ_registry *reg)
+{
+    if (reg->suggest == NULL) {
+        const char **names = malloc(sizeof(*names) * (reg->count + 1));
+        if (names == NULL) {
+            return NULL;
+        }
+        for (size_t i = 0; i < reg->count; ++i) {
+            names[i] = reg->entries[i]->cmd.command;
+        }
+        reg->suggest = suggest_index_create(names, reg->count);
+        free(names);
+    }
+    return reg->suggest;
+}
+
+static void registry_invalidate(struct econ_registry *reg)
+{
+    free(reg->sorted);
+    reg->sorted = NULL;
+    suggest_index_destroy(reg->suggest);
+    reg->suggest = NULL;
+}
+
+static struct registry_entry *registry_lookup(const struct econ_registry *reg, const char *name)
+{
+    const struct trie_node *node = &reg->root;
+
+    for (; (node != NULL) && (*name != NUL); ++name) {
+        node = node_child(node, (unsigned char)*name);
+    }
+    return (node != NULL) ? node->entry : NULL;
+}
+
+/**
+ *  @details    create a registry indexing @c cmds.
+ *
+ *  @param      [in]    cmds    command list terminated by @ref ECON_END_OF_COMMAND,
+ *                              or NULL for an empty registry.
+ *  @return     returns registry on success.
+ *              on error, NULL is returned, and @c errno set.
+ */
+struct econ_registry *econ_registry_create(const struct econ_command *cmds)
+{
+    struct econ_registry *reg = calloc(1, sizeof(*reg));
+    if (reg == NULL) {
+        return NULL;
+    }
+
+    for (int i = 0; (cmds != NULL) && (cmds[i].command != NULL); ++i) {
+        if (econ_registry_register(reg, &cmds[i]) != 0) {
+            int saved = errno;
+            econ_registry_destroy(reg);
+            errno = saved;
+            return NULL;
+        }
+    }
+
+    return reg;
+}
+
+/**
+ *  @details    destroy the registry and all sub-command levels.
+ *
+ *  @param      [in]    reg     registry.
+ */
+void econ_registry_destroy(struct econ_registry *reg)
+{
+    if (reg == NULL) {
+        return;
+    }
+
+    node_cleanup(&reg->root);
+    free(reg->entries);
+    free(reg->sorted);
+    suggest_index_destroy(reg->suggest);
+    free(reg);
+}
+
+/**
+ *  @details    register @c cmd (and its sub-commands).
+ *
+ *  @param      [in]    reg     registry.
+ *  @param      [in]    cmd     command. (copied, strings are referenced)
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_registry_register(struct econ_registry *reg, const struct econ_command *cmd)
+{
+    if ((reg == NULL) || (cmd == NULL) || (cmd->command == NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (registry_lookup(reg, cmd->command) != NULL) {
+        errno = EEXIST;
+        return -1;
+    }
+
+    if (reg->count == reg->capacity) {
+        size_t capacity = (reg->capacity > 0) ? reg->capacity * 2 : 16;
+        struct registry_entry **entries = realloc(reg->entries, sizeof(*entries) * capacity);
+        if (entries == NULL) {
+            return -1;
+        }
+        reg->entries = entries;
+        reg->capacity = capacity;
+    }
+
+    struct registry_entry *entry = calloc(1, sizeof(*entry));
+    if (entry == NULL) {
+        return -1;
+    }
+    entry->cmd = *cmd;
+    entry->length = strlen(cmd->command);
+    if (cmd->sub_cmds != NULL) {
+        entry->sub = econ_registry_create(cmd->sub_cmds);
+        if (entry->sub == NULL) {
+            free(entry);
+            return -1;
+        }
+    }
+
+    struct trie_node *node = &reg->root;
+    for (const char *p = cmd->command; (node != NULL) && (*p != NUL); ++p) {
+        node = node_child_create(node, (unsigned char)*p);
+    }
+    if (node == NULL) {
+        /* partially created nodes are kept, they are reused or freed on destroy. */
+        entry_destroy(entry);
+        errno = ENOMEM;
+        return -1;
+    }
+    node->entry = entry;
+
+    reg->entries[reg->count++] = entry;
+    if ((int)entry->length > reg->col_length) {
+        reg->col_length = entry->length;
+    }
+    registry_invalidate(reg);
+
+    return 0;
+}
+
+/**
+ *  @details    unregister command @c name (and its sub-commands).
+ *
+ *  @param      [in]    reg     registry.
+ *  @param      [in]    name    command name.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_registry_unregister(struct econ_registry *reg, const char *name)
+{
+    if ((reg == NULL) || (name == NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    struct registry_entry *entry = node_remove(&reg->root, name);
+    if (entry == NULL) {
+        errno = ENOENT;
+        return -1;
+    }
+
+    for (size_t i = 0; i < reg->count; ++i) {
+        if (reg->entries[i] == entry) {
+            memmove(&reg->entries[i], &reg->entries[i + 1],
+                    sizeof(reg->entries[0]) * (reg->count - i - 1));
+            --reg->count;
+            break;
+        }
+    }
+    if ((int)entry->length == reg->col_length) {
+        update_col_length(reg);
+    }
+    registry_invalidate(reg);
+    entry_destroy(entry);
+
+    return 0;
+}
+
+/**
+ *  @details    find command @c name.
+ *
+ *  @param      [in]    reg     registry.
+ *  @param      [in]    name    command name.
+ *  @return     returns command on success.
+ *              on error, NULL is returned, and @c errno set.
+ */
+const struct econ_command *econ_registry_find(const struct econ_registry *reg, const char *name)
+{
+    struct registry_entry *entry = registry_lookup(reg, name);
+    if (entry == NULL) {
+        errno = ENOENT;
+        return NULL;
+    }
+    return &entry->cmd;
+}
+
+/**
+ *  @details    get sub-command level of command @c name.
+ *
+ *  @param      [in]    reg     registry.
+ *  @param      [in]    name    command name.
+ *  @return     returns sub-command registry on success.
+ *              on error, NULL is returned, and @c errno set.
+ */
+struct econ_registry *econ_registry_sub(struct econ_registry *reg, const char *name)
+{
+    struct registry_entry *entry = registry_lookup(reg, name);
+    if ((entry == NULL) || (entry->sub == NULL)) {
+        errno = ENOENT;
+        return NULL;
+    }
+    return entry->sub;
+}
+
+/**
+ *  @details    print available command list.
+ *
+ *  @param      [in]    reg     registry.
+ */
+void econ_registry_help(const struct econ_registry *reg)
+{
+    econ_printf("\navailable list.\r\n");
+    for (size_t i = 0; i < reg->count; ++i) {
+        const struct econ_command *cmd = &reg->entries[i]->cmd;
+
+        econ_printf("* %-*s: %s\r\n", reg->col_length + 1, cmd->command, cmd->help);
+    }
+}
+
+size_t registry_suggest_find(struct econ_registry *reg, const char *word,
+                             struct suggestion *out, size_t n)
+{
+    return suggest_index_find(registry_suggest(reg), word, out, n);
+}
+
+/**
+ *  @details    invoke @c argv command from @c reg.
+ *
+ *              commands run as econ_invoke() runs them from a list:
+ *              with an unquoted '&' ending the line, or for a command
+ *              flagged @ref ECON_FLAG_ASYNC, as a job, and joined by
+ *              '|' as a pipeline.
+ *
+ *  @param      [in]    reg     registry.
+ *  @param      [in]    argc    command argument count.
+ *  @param      [in]    argv    command argument values.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_registry_invoke(struct econ_registry *reg, int argc, char **argv)
+{
+    return invoke_registry(reg, argc, argv);
+}
+
+/**
+ *  @details    collect completion candidates of the last word of @c argv.
+ *
+ *              leading words select the sub-command level,
+ *              words after a command are completed by its completer.
+ *
+ *  @param      [in]    reg     registry.
+ *  @param      [in]    argc    word count, the last one is being completed.
+ *  @param      [in]    argv    words.
+ *  @param      [out]   comp    completion.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_registry_complete(struct econ_registry *reg, int argc, char **argv,
+                           struct econ_completion *comp)
+{
+    if ((reg == NULL) || (argc < 1) || (argv == NULL) || (comp == NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    for (int i = 0; i < argc - 1; ++i) {
+        struct registry_entry *entry = registry_lookup(reg, argv[i]);
+
+        if (entry == NULL) {
+            return 0;
+        } else if (entry->sub == NULL) {
+            if (entry->cmd.complete != NULL) {
+                entry->cmd.complete(comp, argc - i, &argv[i]);
+            } else if (entry->cmd.args != NULL) {
+                args_complete(&entry->cmd, comp, argc - i, &argv[i]);
+            }
+            return 0;
+        }
+        reg = entry->sub;
+    }
+
+    struct registry_entry **sorted = registry_sorted(reg);
+    if (sorted == NULL) {
+        return -1;
+    }
+    const char *prefix = argv[argc - 1];
+    size_t prefix_len = strlen(prefix);
+    size_t lo = 0, hi = reg->count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (strcmp(sorted[mid]->cmd.command, prefix) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (; lo < reg->count; ++lo) {
+        const struct registry_entry *entry = sorted[lo];
+        if (strncmp(entry->cmd.command, prefix, prefix_len) != 0) {
+            break;
+        }
+        if (completion_push(comp, entry->cmd.command, entry->length) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,29 @@
+/** @file       registry.h
+ *  @brief      Command registry internals.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-17 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_REGISTRY_H__
+#define __ECON_REGISTRY_H__
+
+#include <stddef.h>
+
+#include "econ.h"
+#include "suggest.h"
+
+/**
+ *  find names of @c reg close to @c word.
+ */
+size_t registry_suggest_find(struct econ_registry *reg, const char *word,
+                             struct suggestion *out, size_t n);
+
+/**
+ *  invoke @c argv command from @c reg, as econ_invoke() does from a list.
+ */
+int invoke_registry(struct econ_registry *reg, int argc, char **argv);
+
+#endif /* __ECON_REGISTRY_H__ */
@@ -0,0 +1,819 @@
+/** @file       rpc.c
+ *  @brief      Framed requests for automation clients.
+ *
+ *  a request is one line of JSON, an object naming the command by
+ *  its words or by a line to split as typed:
+ *
+ *  @code
+ *  {"id":1,"argv":["poke","0x40000000","32","1"]}
+ *  {"id":"st","line":"regs 4 | grep CTRL"}
+ *  @endcode
+ *
+ *  and a response is one line of JSON carrying the id of its request,
+ *  the result of the command and its output:
+ *
+ *  @code
+ *  {"id":1,"ret":0,"output":"poke: 0x40000000 <- 0x00000001 (32 bits) \"\"\r\n"}
+ *  {"id":null,"ret":-1,"error":"not a JSON object"}
+ *  @endcode
+ *
+ *  nothing is echoed and there is no prompt. requests are answered
+ *  in order, so a client may send many before reading responses, and
+ *  match them by id. commands run to completion on the calling thread,
+ *  as in batch mode.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-17 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <termios.h>
+
+#include "econ.h"
+#include "ascii.h"
+#include "rpc.h"
+#include "session.h"
+#include "token.h"
+#include "utils.h"
+
+/**
+ *  most output bytes of a response.
+ */
+#define RPC_OUTPUT_MAX (1024 * 1024)
+
+/**
+ *  deepest nesting of ignored values.
+ */
+#define RPC_DEPTH_MAX (16)
+
+struct rpc {
+    struct econ_session *out;       /**< session responses go to. */
+    struct econ_command *cmds;      /**< command list. */
+    struct econ_session *capture;   /**< session commands run on. */
+    char *output;                   /**< output of the running request. */
+    size_t output_len;              /**< length of @c output. */
+    size_t output_cap;              /**< allocated length of @c output. */
+    bool truncated;                 /**< output beyond @ref RPC_OUTPUT_MAX was dropped. */
+    char *buf;                      /**< input not run yet. */
+    size_t len;                     /**< length of @c buf. */
+    size_t cap;                     /**< allocated length of @c buf. */
+    bool skipping;                  /**< rest of a request too long is dropped. */
+    struct econ_batch_stats stats;  /**< counters. */
+};
+
+/**
+ *  parsed request.
+ */
+struct rpc_request {
+    char id[RPC_ID_MAX + 1];    /**< id, as written. */
+    char *argv[RPC_MAX_ARGS];   /**< words. */
+    int argc;                   /**< number of words, -1 if not given. */
+    char *line;                 /**< line to split, or NULL. */
+};
+
+static char *json_ws(char *p)
+{
+    while ((*p == SP) || (*p == TAB) || (*p == CR) || (*p == LF)) {
+        ++p;
+    }
+    return p;
+}
+
+static int json_hex4(const char *p)
+{
+    int val = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        char c = p[i];
+        int d = ((c >= '0') && (c <= '9')) ? c - '0'
+              : ((c >= 'a') && (c <= 'f')) ? c - 'a' + 10
+              : ((c >= 'A') && (c <= 'F')) ? c - 'A' + 10 : -1;
+        if (d < 0) {
+            return -1;
+        }
+        val = (val << 4) | d;
+    }
+    return val;
+}
+
+static char *utf8_put(char *w, long cp)
+{
+    if (cp < 0x80) {
+        *w++ = cp;
+    } else if (cp < 0x800) {
+        *w++ = 0xc0 | (cp >> 6);
+        *w++ = 0x80 | (cp & 0x3f);
+    } else if (cp < 0x10000) {
+        *w++ = 0xe0 | (cp >> 12);
+        *w++ = 0x80 | ((cp >> 6) & 0x3f);
+        *w++ = 0x80 | (cp & 0x3f);
+    } else {
+        *w++ = 0xf0 | (cp >> 18);
+        *w++ = 0x80 | ((cp >> 12) & 0x3f);
+        *w++ = 0x80 | ((cp >> 6) & 0x3f);
+        *w++ = 0x80 | (cp & 0x3f);
+    }
+    return w;
+}
+
+/**
+ *  get length of the UTF-8 sequence at @c p, of @c len bytes at most.
+ *
+ *  overlong forms, surrogates and code points beyond U+10FFFF are not
+ *  valid.
+ *
+ *  @return returns length of the sequence.
+ *          if it is not valid, 0 is returned.
+ */
+static size_t utf8_len(const char *p, size_t len)
+{
+    const unsigned char *u = (const unsigned char *)p;
+    unsigned char lo = 0x80, hi = 0xbf;
+    size_t n;
+
+    if (u[0] < 0x80) {
+        return 1;
+    } else if (u[0] < 0xc2) {
+        return 0;
+    } else if (u[0] < 0xe0) {
+        n = 2;
+    } else if (u[0] < 0xf0) {
+        n = 3;
+        lo = (u[0] == 0xe0) ? 0xa0 : lo;
+        hi = (u[0] == 0xed) ? 0x9f : hi;
+    } else if (u[0] < 0xf5) {
+        n = 4;
+        lo = (u[0] == 0xf0) ? 0x90 : lo;
+        hi = (u[0] == 0xf4) ? 0x8f : hi;
+    } else {
+        return 0;
+    }
+    if ((len < n) || (u[1] < lo) || (u[1] > hi)) {
+        return 0;
+    }
+    for (size_t i = 2; i < n; ++i) {
+        if ((u[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+    }
+    return n;
+}
+
+/**
+ *  decode the string at @c *pp in place.
+ *
+ *  an escape is never shorter than what it stands for, so the decoded
+ *  string fits where it was written.
+ *
+ *  @return returns the terminated string, @c *pp is moved past it.
+ *          on error, NULL is returned.
+ */
+static char *json_string(char **pp)
+{
+    char *r = *pp + 1;
+    char *w = r, *s = r;
+
+    for (;;) {
+        unsigned char c = *r++;
+
+        if (c == '"') {
+            break;
+        } else if (c < SP) {
+            /* NUL included. */
+            return NULL;
+        } else if (c >= 0x80) {
+            size_t n = utf8_len(&r[-1], SIZE_MAX);
+            if (n == 0) {
+                return NULL;
+            }
+            memmove(w, &r[-1], n);
+            w += n;
+            r += n - 1;
+            continue;
+        } else if (c != '\\') {
+            *w++ = c;
+            continue;
+        }
+        switch (*r++) {
+        case '"':  *w++ = '"';  break;
+        case '\\': *w++ = '\\'; break;
+        case '/':  *w++ = '/';  break;
+        case 'b':  *w++ = BS;   break;
+        case 'f':  *w++ = '\f'; break;
+        case 'n':  *w++ = LF;   break;
+        case 'r':  *w++ = CR;   break;
+        case 't':  *w++ = TAB;  break;
+        case 'u': {
+            long cp = json_hex4(r);
+            if (cp <= 0) {
+                /* a word cannot hold NUL. */
+                return NULL;
+            }
+            r += 4;
+            if ((cp >= 0xdc00) && (cp < 0xe000)) {
+                /* a low surrogate of no pair. */
+                return NULL;
+            } else if ((cp >= 0xd800) && (cp < 0xdc00)) {
+                long lo = ((r[0] == '\\') && (r[1] == 'u')) ? json_hex4(&r[2]) : -1;
+                if ((lo < 0xdc00) || (lo >= 0xe000)) {
+                    return NULL;
+                }
+                cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+                r += 6;
+            }
+            w = utf8_put(w, cp);
+            break;
+        }
+        default:
+            return NULL;
+        }
+    }
+    *w = NUL;
+    *pp = r;
+
+    return s;
+}
+
+/**
+ *  skip the number at @c p.
+ *
+ *  @return returns the end of the number.
+ *          on error, NULL is returned.
+ */
+static char *json_number(char *p)
+{
+    if (*p == '-') {
+        ++p;
+    }
+    if (*p == '0') {
+        ++p;
+    } else if ((*p >= '1') && (*p <= '9')) {
+        while ((*p >= '0') && (*p <= '9')) {
+            ++p;
+        }
+    } else {
+        return NULL;
+    }
+    if (*p == '.') {
+        if ((*++p < '0') || (*p > '9')) {
+            return NULL;
+        }
+        while ((*p >= '0') && (*p <= '9')) {
+            ++p;
+        }
+    }
+    if ((*p == 'e') || (*p == 'E')) {
+        if ((*++p == '+') || (*p == '-')) {
+            ++p;
+        }
+        if ((*p < '0') || (*p > '9')) {
+            return NULL;
+        }
+        while ((*p >= '0') && (*p <= '9')) {
+            ++p;
+        }
+    }
+    return p;
+}
+
+/**
+ *  skip the value at @c p, leaving it as it is.
+ *
+ *  @return returns the end of the value.
+ *          on error, NULL is returned.
+ */
+static char *json_skip(char *p, int depth)
+{
+    if (*p == '"') {
+        for (++p; *p != '"'; ++p) {
+            if ((unsigned char)*p < SP) {
+                return NULL;
+            } else if ((*p == '\\') && (*++p == NUL)) {
+                return NULL;
+            }
+        }
+        return p + 1;
+    } else if ((*p == '{') || (*p == '[')) {
+        char close = (*p == '{') ? '}' : ']';
+
+        if (depth >= RPC_DEPTH_MAX) {
+            return NULL;
+        }
+        p = json_ws(p + 1);
+        if (*p == close) {
+            return p + 1;
+        }
+        for (;;) {
+            if (close == '}') {
+                if ((*p != '"') || ((p = json_skip(p, depth + 1)) == NULL)) {
+                    return NULL;
+                }
+                p = json_ws(p);
+                if (*p++ != ':') {
+                    return NULL;
+                }
+                p = json_ws(p);
+            }
+            if ((p = json_skip(p, depth + 1)) == NULL) {
+                return NULL;
+            }
+            p = json_ws(p);
+            if (*p == close) {
+                return p + 1;
+            } else if (*p++ != ',') {
+                return NULL;
+            }
+            p = json_ws(p);
+        }
+    }
+
+    if ((*p == '-') || ((*p >= '0') && (*p <= '9'))) {
+        return json_number(p);
+    }
+    static const char *const literals[] = {"true", "false", "null"};
+    for (size_t i = 0; i < lengthof(literals); ++i) {
+        size_t len = strlen(literals[i]);
+        if (strncmp(p, literals[i], len) == 0) {
+            return p + len;
+        }
+    }
+    return NULL;
+}
+
+/**
+ *  parse request @c line in place.
+ *
+ *  @return returns NULL on success.
+ *          on error, the reason is returned.
+ */
+static const char *rpc_parse(char *line, struct rpc_request *req)
+{
+    char *p = json_ws(line);
+
+    if (*p++ != '{') {
+        return "not a JSON object";
+    }
+    p = json_ws(p);
+    bool more = (*p != '}');
+    if (!more) {
+        p = json_ws(p + 1);
+    }
+    while (more) {
+        char *key;
+        if ((*p != '"') || ((key = json_string(&p)) == NULL)) {
+            return "malformed key";
+        }
+        p = json_ws(p);
+        if (*p++ != ':') {
+            return "missing ':'";
+        }
+        p = json_ws(p);
+
+        if (strcmp(key, "id") == 0) {
+            char *end = (*p == '"') ? json_skip(p, 0) : json_number(p);
+            if (end == NULL) {
+                return "id is not a string or number";
+            } else if (end - p > RPC_ID_MAX) {
+                return "id too long";
+            }
+            if (*p == '"') {
+                /* it is sent back verbatim, decode a copy to check it. */
+                char copy[RPC_ID_MAX + 1], *q = copy;
+
+                memcpy(copy, p, end - p);
+                copy[end - p] = NUL;
+                if (json_string(&q) == NULL) {
+                    return "id is not a valid string";
+                }
+            }
+            memcpy(req->id, p, end - p);
+            req->id[end - p] = NUL;
+            p = end;
+        } else if (strcmp(key, "argv") == 0) {
+            if (*p++ != '[') {
+                return "argv is not an array";
+            }
+            req->argc = 0;
+            p = json_ws(p);
+            bool next = (*p != ']');
+            if (!next) {
+                ++p;
+            }
+            while (next) {
+                char *word;
+                if ((*p != '"') || ((word = json_string(&p)) == NULL)) {
+                    return "argv holds a malformed string";
+                } else if (req->argc >= RPC_MAX_ARGS) {
+                    return "too many arguments";
+                }
+                req->argv[req->argc++] = word;
+                p = json_ws(p);
+                if ((*p != ',') && (*p != ']')) {
+                    return "malformed argv";
+                }
+                next = (*p == ',');
+                p = json_ws(p + 1);
+            }
+        } else if (strcmp(key, "line") == 0) {
+            if ((*p != '"') || ((req->line = json_string(&p)) == NULL)) {
+                return "line is not a string";
+            }
+        } else if ((p = json_skip(p, 0)) == NULL) {
+            return "malformed value";
+        }
+
+        p = json_ws(p);
+        if ((*p != ',') && (*p != '}')) {
+            return "missing ',' or '}'";
+        }
+        more = (*p == ',');
+        p = json_ws(p + 1);
+    }
+    if (*p != NUL) {
+        return "trailing characters";
+    }
+
+    return NULL;
+}
+
+/**
+ *  queue @c data as the body of a JSON string.
+ *
+ *  bytes which are not valid UTF-8 are replaced by U+FFFD.
+ */
+static void rpc_escape(struct econ_session *s, const char *data, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    size_t from = 0;
+
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char c = data[i];
+        char esc[6] = {'\\', c};
+        size_t n = 2;
+        unsigned int cp;
+
+        if (c >= 0x80) {
+            size_t seq = utf8_len(&data[i], len - i);
+            if (seq > 0) {
+                i += seq - 1;
+                continue;
+            }
+        } else if ((c >= SP) && (c != '"') && (c != '\\') && (c != DEL)) {
+            continue;
+        }
+        switch (c) {
+        case '"':
+        case '\\':
+            break;
+        case LF:
+            esc[1] = 'n';
+            break;
+        case CR:
+            esc[1] = 'r';
+            break;
+        case TAB:
+            esc[1] = 't';
+            break;
+        default:
+            /* a byte not valid as UTF-8 is U+FFFD. */
+            cp = (c >= 0x80) ? 0xfffd : c;
+            esc[1] = 'u';
+            esc[2] = hex[cp >> 12];
+            esc[3] = hex[(cp >> 8) & 0xf];
+            esc[4] = hex[(cp >> 4) & 0xf];
+            esc[5] = hex[cp & 0xf];
+            n = 6;
+            break;
+        }
+        if (i > from) {
+            session_write(s, &data[from], i - from);
+        }
+        session_write(s, esc, n);
+        from = i + 1;
+    }
+    if (len > from) {
+        session_write(s, &data[from], len - from);
+    }
+}
+
+/**
+ *  queue response to request @c id.
+ *
+ *  the output of the command is sent when @c error is NULL.
+ */
+static void rpc_respond(struct rpc *r, const char *id, int ret, const char *error)
+{
+    session_printf(r->out, "{\"id\":%s,\"ret\":%d", id, ret);
+    if (error != NULL) {
+        session_write(r->out, ",\"error\":\"", 10);
+        rpc_escape(r->out, error, strlen(error));
+    } else {
+        session_write(r->out, ",\"output\":\"", 11);
+        rpc_escape(r->out, r->output, r->output_len);
+        if (r->truncated) {
+            session_write(r->out, "\",\"truncated\":true", 18);
+        } else {
+            session_write(r->out, "\"", 1);
+        }
+    }
+    session_write(r->out, (error != NULL) ? "\"}\n" : "}\n", (error != NULL) ? 3 : 2);
+}
+
+static void rpc_error(struct rpc *r, const char *id, const char *error)
+{
+    ++r->stats.errors;
+    if (r->stats.first_error == 0) {
+        r->stats.first_error = r->stats.lines;
+    }
+    rpc_respond(r, id, -1, error);
+}
+
+/**
+ *  run request @c line terminated in place.
+ *
+ *  blank lines are skipped.
+ */
+static void rpc_request(struct rpc *r, char *line)
+{
+    struct rpc_request req = {.id = "null", .argc = -1};
+
+    if (*json_ws(line) == NUL) {
+        /* blank, or LF of CR LF. */
+        return;
+    }
+    ++r->stats.lines;
+    const char *error = rpc_parse(line, &req);
+    if (error != NULL) {
+        rpc_error(r, req.id, error);
+        return;
+    }
+    if ((req.argc < 0) && (req.line != NULL)) {
+        req.argc = token_split(req.line, strlen(req.line), req.argv, lengthof(req.argv), NULL);
+        if (req.argc < 0) {
+            rpc_error(r, req.id, token_error(errno));
+            return;
+        }
+        /* the response carries the output, a job would leave it behind. */
+        if ((req.argc > 0) && (req.argv[req.argc - 1] == token_background)) {
+            rpc_error(r, req.id, "background jobs are not run");
+            return;
+        }
+    }
+    if (req.argc <= 0) {
+        rpc_error(r, req.id, "no command");
+        return;
+    }
+
+    ++r->stats.commands;
+    r->output_len = 0;
+    r->truncated = false;
+    int ret = session_invoke(r->capture, req.argc, req.argv, r->cmds);
+    session_flush(r->capture);
+    if (ret != 0) {
+        ++r->stats.errors;
+        if (r->stats.first_error == 0) {
+            r->stats.first_error = r->stats.lines;
+        }
+    }
+    rpc_respond(r, req.id, ret, NULL);
+}
+
+/**
+ *  output sink of commands, keeps output for the response.
+ */
+static ssize_t rpc_output(void *ctx, const void *buf, size_t len)
+{
+    struct rpc *r = ctx;
+    size_t keep = len;
+
+    if (r->output_len + len > RPC_OUTPUT_MAX) {
+        r->truncated = true;
+        keep = RPC_OUTPUT_MAX - r->output_len;
+    }
+    if (r->output_len + keep > r->output_cap) {
+        size_t cap = (r->output_cap > 0) ? r->output_cap : 1024;
+        while (cap < r->output_len + keep) {
+            cap *= 2;
+        }
+        char *output = realloc(r->output, cap);
+        if (output == NULL) {
+            return -1;
+        }
+        r->output = output;
+        r->output_cap = cap;
+    }
+    memcpy(&r->output[r->output_len], buf, keep);
+    r->output_len += keep;
+
+    /* the rest is dropped, not left queued for the next request. */
+    return len;
+}
+
+struct rpc *rpc_create(struct econ_session *out, struct econ_command *cmds)
+{
+    struct rpc *r = calloc(1, sizeof(*r));
+    if (r == NULL) {
+        return NULL;
+    }
+    r->out = out;
+    r->cmds = cmds;
+    r->capture = session_alloc(-1, -1);
+    if (r->capture == NULL) {
+        free(r);
+        return NULL;
+    }
+    econ_session_set_output(r->capture, rpc_output, r);
+    /* output is taken as a whole when the command returns. */
+    r->capture->deferred = true;
+
+    return r;
+}
+
+void rpc_destroy(struct rpc *r)
+{
+    if (r == NULL) {
+        return;
+    }
+
+    econ_session_destroy(r->capture);
+    free(r->output);
+    free(r->buf);
+    free(r);
+}
+
+/**
+ *  find the end of a request, LF or CR as a terminal in raw mode sends.
+ */
+static const char *rpc_eol(const char *p, size_t len)
+{
+    const char *lf = memchr(p, LF, len);
+    const char *cr = memchr(p, CR, (lf != NULL) ? (size_t)(lf - p) : len);
+
+    return (cr != NULL) ? cr : lf;
+}
+
+void rpc_feed(struct rpc *r, const void *data, size_t len)
+{
+    const char *in = data;
+
+    while (len > 0) {
+        const char *lf = rpc_eol(in, len);
+        size_t n = (lf != NULL) ? (size_t)(lf - in) : len;
+
+        if (r->skipping) {
+            if (lf != NULL) {
+                r->skipping = false;
+            }
+        } else if (r->len + n > SESSION_LINE_MAX) {
+            ++r->stats.lines;
+            rpc_error(r, "null", "request too long");
+            r->len = 0;
+            r->skipping = (lf == NULL);
+        } else {
+            if (r->len + n + 1 > r->cap) {
+                size_t cap = (r->cap > 0) ? r->cap : RPC_BLOCK_SIZE;
+                while (cap < r->len + n + 1) {
+                    cap *= 2;
+                }
+                char *buf = realloc(r->buf, cap);
+                if (buf == NULL) {
+                    return;
+                }
+                r->buf = buf;
+                r->cap = cap;
+            }
+            memcpy(&r->buf[r->len], in, n);
+            r->len += n;
+            if (lf != NULL) {
+                r->buf[r->len] = NUL;
+                rpc_request(r, r->buf);
+                r->len = 0;
+            }
+        }
+        if (lf == NULL) {
+            break;
+        }
+        in = lf + 1;
+        len -= n + 1;
+    }
+}
+
+void rpc_finish(struct rpc *r)
+{
+    if ((r->len > 0) && !r->skipping) {
+        r->buf[r->len] = NUL;
+        rpc_request(r, r->buf);
+    }
+    r->len = 0;
+    r->skipping = false;
+}
+
+const struct econ_batch_stats *rpc_stats(const struct rpc *r)
+{
+    return &r->stats;
+}
+
+/**
+ *  @details    answer JSON-lines requests read from @c in_fd on @c out_fd.
+ *
+ *              each line read, ended by LF or CR, is a request object with an "id", and
+ *              the command as "argv", an array of words, or as "line",
+ *              split and piped as typed, but not ended by an unquoted
+ *              '&'. each request is answered by a line carrying its
+ *              "id", the "ret" of the command and its "output", or an
+ *              "error" when it cannot be run.
+ *              requests are answered in order, and responses to all
+ *              the requests of one read are written together, so
+ *              clients may pipeline requests.
+ *              a terminal is put into raw mode until end of input,
+ *              so that nothing is echoed or edited.
+ *
+ *  @param      [in]    in_fd   input fd. (a pipe, a pty or a socket)
+ *  @param      [in]    out_fd  output fd.
+ *  @param      [in]    cmds    command list.
+ *  @param      [out]   stats   counters, or NULL.
+ *                              @c lines counts requests.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_run_rpc(int in_fd, int out_fd, struct econ_command *cmds, struct econ_batch_stats *stats)
+{
+    struct termios saved_term;
+    bool tty = false;
+    int error = 0;
+
+    if ((in_fd < 0) || (out_fd < 0) || (cmds == NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+    char *buf = malloc(RPC_BLOCK_SIZE);
+    struct econ_session *out = session_alloc(-1, out_fd);
+    struct rpc *r = (out != NULL) ? rpc_create(out, cmds) : NULL;
+    if ((buf == NULL) || (r == NULL)) {
+        free(buf);
+        if (out != NULL) {
+            econ_session_destroy(out);
+        }
+        errno = ENOMEM;
+        return -1;
+    }
+    out->deferred = true;
+
+    if (isatty(in_fd) && (tcgetattr(in_fd, &saved_term) == 0)) {
+        struct termios raw = saved_term;
+        cfmakeraw(&raw);
+        tty = (tcsetattr(in_fd, TCSAFLUSH, &raw) == 0);
+    }
+
+    for (;;) {
+        ssize_t n = read(in_fd, buf, RPC_BLOCK_SIZE);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                struct pollfd pfd = {.fd = in_fd, .events = POLLIN};
+                poll(&pfd, 1, -1);
+                continue;
+            }
+            error = errno;
+            break;
+        } else if (n == 0) {
+            rpc_finish(r);
+            break;
+        }
+        rpc_feed(r, buf, n);
+        if (session_flush(out) != 0) {
+            error = errno;
+            break;
+        }
+    }
+    if ((session_flush(out) != 0) && (error == 0)) {
+        error = errno;
+    }
+
+    if (tty) {
+        tcsetattr(in_fd, TCSAFLUSH, &saved_term);
+    }
+    if (stats != NULL) {
+        *stats = *rpc_stats(r);
+    }
+    rpc_destroy(r);
+    econ_session_destroy(out);
+    free(buf);
+
+    if (error != 0) {
+        errno = error;
+        return -1;
+    }
+    return 0;
+}
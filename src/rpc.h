@@ -0,0 +1,64 @@
+/** @file       rpc.h
+ *  @brief      Framed requests for automation clients.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-17 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_RPC_H__
+#define __ECON_RPC_H__
+
+#include <stddef.h>
+
+#include "econ.h"
+
+/**
+ *  most arguments of a request.
+ */
+#define RPC_MAX_ARGS (64)
+
+/**
+ *  longest request id, as written.
+ */
+#define RPC_ID_MAX (64)
+
+/**
+ *  input read at once.
+ */
+#define RPC_BLOCK_SIZE (64 * 1024)
+
+/**
+ *  request stream.
+ */
+struct rpc;
+
+/**
+ *  create a request stream answering on @c out.
+ */
+struct rpc *rpc_create(struct econ_session *out, struct econ_command *cmds);
+
+/**
+ *  destroy request stream.
+ */
+void rpc_destroy(struct rpc *r);
+
+/**
+ *  run every request completed by @c len more bytes.
+ *
+ *  responses are queued on the session, the caller flushes it.
+ */
+void rpc_feed(struct rpc *r, const void *data, size_t len);
+
+/**
+ *  run the last request, not terminated by LF, at end of input.
+ */
+void rpc_finish(struct rpc *r);
+
+/**
+ *  get counters.
+ */
+const struct econ_batch_stats *rpc_stats(const struct rpc *r);
+
+#endif /* __ECON_RPC_H__ */
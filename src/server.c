@@ -0,0 +1,601 @@
+/** @file       server.c
+ *  @brief      Multi-client console server.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "econ.h"
+#include "jobs.h"
+#include "rpc.h"
+#include "session.h"
+#include "debug.h"
+#include "utils.h"
+
+/**
+ *  maximum argument count of one line.
+ */
+#define SERVER_MAX_ARGS (64)
+
+/**
+ *  default maximum number of clients.
+ */
+#define SERVER_DEFAULT_CLIENTS (256)
+
+/**
+ *  client connection.
+ */
+struct connection {
+    int fd;                     /**< socket fd. */
+    struct econ_session *s;     /**< line discipline and output queue. */
+    struct rpc *rpc;            /**< request frames, or NULL for typing. */
+    uint32_t events;            /**< registered events. */
+    bool closing;               /**< input ended, closed when output is sent. */
+    bool closed;                /**< freed once the polled events are handled. */
+    struct connection *next;    /**< next connection. */
+    struct connection *prev;    /**< previous connection. */
+};
+
+/**
+ *  console server.
+ */
+struct econ_server {
+    struct econ_server_config config;   /**< configuration. */
+    struct econ_registry *registry;     /**< completion index shared by connections. */
+    int epfd;                           /**< polling fd. */
+    int evfd;                           /**< stop request fd. */
+    int jobfd;                          /**< fd signaled by jobs of any connection. */
+    int unix_fd;                        /**< AF_UNIX listening fd. */
+    int tcp_fd;                         /**< TCP listening fd. */
+    int tcp_port;                       /**< bound TCP port. */
+    size_t clients;                     /**< number of connections. */
+    struct connection *conns;           /**< connection list. */
+    struct epoll_event events[64];      /**< polled events. */
+};
+
+/**
+ *  output sink of connection, never blocks the loop.
+ */
+static ssize_t conn_send(void *ctx, const void *buf, size_t len)
+{
+    struct connection *conn = ctx;
+
+    for (;;) {
+        ssize_t sent = send(conn->fd, buf, len, MSG_NOSIGNAL);
+        if (sent >= 0) {
+            return sent;
+        } else if (errno == EINTR) {
+            continue;
+        } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return 0;
+        }
+        return -1;
+    }
+}
+
+/**
+ *  send buffered output as far as the socket accepts.
+ *
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+static int conn_flush(struct econ_server *srv, struct connection *conn)
+{
+    if (session_flush(conn->s) != 0) {
+        return -1;
+    }
+
+    size_t queued = conn->s->out_len - conn->s->out_pos;
+    /* a client sending requests without reading responses waits. */
+    bool want_in = !conn->closing && ((conn->rpc == NULL) || (queued < SESSION_OUTPUT_LIMIT));
+    uint32_t events = (want_in ? EPOLLIN : 0) | ((queued > 0) ? EPOLLOUT : 0);
+    if (events != conn->events) {
+        struct epoll_event ev;
+        ev.events = events;
+        ev.data.ptr = conn;
+        if (epoll_ctl(srv->epfd, EPOLL_CTL_MOD, conn->fd, &ev) != 0) {
+            return -1;
+        }
+        conn->events = events;
+    }
+
+    return 0;
+}
+
+/**
+ *  close the connection after the polled events, which may still
+ *  point to it, are handled.
+ */
+static void conn_shut(struct econ_server *srv, struct connection *conn)
+{
+    if (!conn->closed) {
+        epoll_ctl(srv->epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+        conn->closed = true;
+    }
+}
+
+static void conn_close(struct econ_server *srv, struct connection *conn)
+{
+    if (!conn->closed) {
+        epoll_ctl(srv->epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+    }
+    close(conn->fd);
+    rpc_destroy(conn->rpc);
+    econ_session_destroy(conn->s);
+
+    if (conn->prev != NULL) {
+        conn->prev->next = conn->next;
+    } else {
+        srv->conns = conn->next;
+    }
+    if (conn->next != NULL) {
+        conn->next->prev = conn->prev;
+    }
+    --srv->clients;
+    free(conn);
+}
+
+/**
+ *  free connections shut while handling polled events.
+ */
+static void server_reap(struct econ_server *srv)
+{
+    for (struct connection *conn = srv->conns, *next; conn != NULL; conn = next) {
+        next = conn->next;
+        if (conn->closed) {
+            conn_close(srv, conn);
+        }
+    }
+}
+
+/**
+ *  answer every completed request of the connection.
+ *
+ *  @return     returns 0 on success.
+ *              on end of input or error, -1 is returned.
+ */
+static int conn_requests(struct connection *conn)
+{
+    char buf[RPC_BLOCK_SIZE / 4];
+
+    while (!conn->closing && (conn->s->out_len - conn->s->out_pos < SESSION_OUTPUT_LIMIT)) {
+        ssize_t n = recv(conn->fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            rpc_feed(conn->rpc, buf, n);
+        } else if (n == 0) {
+            /* responses queued are still sent. */
+            rpc_finish(conn->rpc);
+            conn->closing = true;
+            return 0;
+        } else if (errno == EINTR) {
+            continue;
+        } else {
+            return ((errno == EAGAIN) || (errno == EWOULDBLOCK)) ? 0 : -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ *  run every completed line of the connection.
+ *
+ *  @return     returns 0 on success.
+ *              on end of input or error, -1 is returned.
+ */
+static int conn_input(struct econ_server *srv, struct connection *conn)
+{
+    int ret;
+
+    if (conn->rpc != NULL) {
+        return conn_requests(conn);
+    }
+
+    while ((ret = session_poll(conn->s)) > 0) {
+        char *argv[SERVER_MAX_ARGS];
+        int argc = session_parse(conn->s, argv, lengthof(argv));
+
+        if (argc > 0) {
+            econ_session_invoke(conn->s, argc, argv, srv->config.cmds);
+        }
+        if (session_jobs_busy(conn->s)) {
+            /* shown when the foreground job finishes. */
+            conn->s->prompt = srv->config.prompt;
+            break;
+        }
+        session_begin(conn->s, srv->config.prompt);
+    }
+
+    return (ret < 0) ? -1 : 0;
+}
+
+/**
+ *  deliver output and completion of jobs to their connections.
+ */
+static void server_jobs(struct econ_server *srv)
+{
+    uint64_t val;
+
+    if ((read(srv->jobfd, &val, sizeof(val)) < 0) && (errno != EAGAIN)) {
+        perror("read");
+    }
+    for (struct connection *conn = srv->conns; conn != NULL; conn = conn->next) {
+        if (conn->closed || (session_jobs_fd(conn->s) < 0)) {
+            continue;
+        }
+        session_jobs_drain(conn->s);
+        /* lines typed while a foreground job ran are waiting. */
+        int ret = session_jobs_busy(conn->s) ? 0 : conn_input(srv, conn);
+        if ((conn_flush(srv, conn) != 0) || (ret != 0)) {
+            conn_shut(srv, conn);
+        }
+    }
+}
+
+static void server_accept(struct econ_server *srv, int listen_fd)
+{
+    for (;;) {
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                perror("accept4");
+            }
+            return;
+        }
+        if (srv->clients >= srv->config.max_clients) {
+            DEBUG("too many clients: %zu", srv->clients);
+            close(fd);
+            continue;
+        }
+
+        struct connection *conn = calloc(1, sizeof(*conn));
+        if (conn == NULL) {
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->s = session_alloc(fd, fd);
+        if (conn->s == NULL) {
+            free(conn);
+            close(fd);
+            continue;
+        }
+        econ_session_set_output(conn->s, conn_send, conn);
+        /* the loop never waits for one client, output beyond is dropped. */
+        struct econ_output_config output = {
+            .limit = SESSION_OUTPUT_LIMIT,
+            .policy = ECON_OUTPUT_DROP,
+            .flow = 0,
+        };
+        econ_session_set_flow(conn->s, &output);
+        econ_session_set_history(conn->s, srv->config.history);
+        econ_session_set_registry(conn->s, srv->registry);
+        conn->s->deferred = true;
+        conn->s->notify_fd = srv->jobfd;
+        if (srv->config.rpc && ((conn->rpc = rpc_create(conn->s, srv->config.cmds)) == NULL)) {
+            econ_session_destroy(conn->s);
+            free(conn);
+            close(fd);
+            continue;
+        }
+
+        struct epoll_event ev;
+        ev.events = conn->events = EPOLLIN;
+        ev.data.ptr = conn;
+        if (epoll_ctl(srv->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            perror("epoll_ctl");
+            rpc_destroy(conn->rpc);
+            econ_session_destroy(conn->s);
+            free(conn);
+            close(fd);
+            continue;
+        }
+
+        conn->next = srv->conns;
+        if (srv->conns != NULL) {
+            srv->conns->prev = conn;
+        }
+        srv->conns = conn;
+        ++srv->clients;
+
+        if (conn->rpc == NULL) {
+            session_begin(conn->s, srv->config.prompt);
+        }
+        if (conn_flush(srv, conn) != 0) {
+            conn_close(srv, conn);
+        }
+    }
+}
+
+static int listen_add(struct econ_server *srv, int fd)
+{
+    struct epoll_event ev;
+
+    if (listen(fd, SOMAXCONN) != 0) {
+        perror("listen");
+        return -1;
+    }
+    ev.events = EPOLLIN;
+    ev.data.ptr = &srv->unix_fd;
+    if (fd == srv->tcp_fd) {
+        ev.data.ptr = &srv->tcp_fd;
+    }
+    if (epoll_ctl(srv->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        perror("epoll_ctl");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int listen_unix(struct econ_server *srv, const char *path)
+{
+    struct sockaddr_un addr;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    srv->unix_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (srv->unix_fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    unlink(path);
+    if (bind(srv->unix_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("bind");
+        return -1;
+    }
+
+    return listen_add(srv, srv->unix_fd);
+}
+
+static int listen_tcp(struct econ_server *srv, int port)
+{
+    struct sockaddr_in addr;
+    socklen_t addrlen = sizeof(addr);
+    int val = 1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    srv->tcp_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (srv->tcp_fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    setsockopt(srv->tcp_fd, SOL_SOCKET, SO_REUSEADDR, &val, sizeof(val));
+    if (bind(srv->tcp_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("bind");
+        return -1;
+    }
+    if (getsockname(srv->tcp_fd, (struct sockaddr *)&addr, &addrlen) == 0) {
+        srv->tcp_port = ntohs(addr.sin_port);
+    }
+
+    return listen_add(srv, srv->tcp_fd);
+}
+
+/**
+ *  @details    create a console server.
+ *
+ *              a client which does not read as fast as a command
+ *              writes loses output beyond 64 KiB, with
+ *              @ref ECON_OUTPUT_DROP.
+ *
+ *  @param      [in]    config  server configuration.
+ *  @return     returns server on success.
+ *              on error, NULL is returned, and @c errno set.
+ */
+struct econ_server *econ_server_create(const struct econ_server_config *config)
+{
+    if ((config == NULL) || (config->cmds == NULL)
+        || ((config->unix_path == NULL) && (config->tcp_port < 0))) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    struct econ_server *srv = calloc(1, sizeof(*srv));
+    if (srv == NULL) {
+        return NULL;
+    }
+    srv->config = *config;
+    if (srv->config.max_clients == 0) {
+        srv->config.max_clients = SERVER_DEFAULT_CLIENTS;
+    }
+    srv->epfd = -1;
+    srv->evfd = -1;
+    srv->jobfd = -1;
+    srv->unix_fd = -1;
+    srv->tcp_fd = -1;
+    srv->tcp_port = -1;
+
+    do {
+        srv->registry = econ_registry_create(config->cmds);
+        if (srv->registry == NULL) {
+            perror("econ_registry_create");
+            break;
+        }
+        srv->epfd = epoll_create1(EPOLL_CLOEXEC);
+        if (srv->epfd < 0) {
+            perror("epoll_create1");
+            break;
+        }
+        srv->evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (srv->evfd < 0) {
+            perror("eventfd");
+            break;
+        }
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = &srv->evfd;
+        if (epoll_ctl(srv->epfd, EPOLL_CTL_ADD, srv->evfd, &ev) != 0) {
+            perror("epoll_ctl");
+            break;
+        }
+        srv->jobfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (srv->jobfd < 0) {
+            perror("eventfd");
+            break;
+        }
+        ev.events = EPOLLIN;
+        ev.data.ptr = &srv->jobfd;
+        if (epoll_ctl(srv->epfd, EPOLL_CTL_ADD, srv->jobfd, &ev) != 0) {
+            perror("epoll_ctl");
+            break;
+        }
+
+        if ((config->unix_path != NULL) && (listen_unix(srv, config->unix_path) != 0)) {
+            break;
+        }
+        if ((config->tcp_port >= 0) && (listen_tcp(srv, config->tcp_port) != 0)) {
+            break;
+        }
+
+        return srv;
+    } while (0);
+
+    int saved = errno;
+    econ_server_destroy(srv);
+    errno = saved;
+    return NULL;
+}
+
+/**
+ *  @details    destroy the server and close all connections.
+ *
+ *  @param      [in]    srv     server.
+ */
+void econ_server_destroy(struct econ_server *srv)
+{
+    if (srv == NULL) {
+        return;
+    }
+
+    while (srv->conns != NULL) {
+        conn_close(srv, srv->conns);
+    }
+    if (srv->unix_fd >= 0) {
+        close(srv->unix_fd);
+        unlink(srv->config.unix_path);
+    }
+    if (srv->tcp_fd >= 0) {
+        close(srv->tcp_fd);
+    }
+    if (srv->evfd >= 0) {
+        close(srv->evfd);
+    }
+    if (srv->jobfd >= 0) {
+        close(srv->jobfd);
+    }
+    if (srv->epfd >= 0) {
+        close(srv->epfd);
+    }
+    econ_registry_destroy(srv->registry);
+    free(srv);
+}
+
+/**
+ *  @details    get bound TCP port.
+ *
+ *  @param      [in]    srv     server.
+ *  @return     returns port number, or -1 if TCP is not listened.
+ */
+int econ_server_port(const struct econ_server *srv)
+{
+    return srv->tcp_port;
+}
+
+/**
+ *  @details    request econ_server_run() to return.
+ *
+ *              this function may be called from any thread.
+ *
+ *  @param      [in]    srv     server.
+ */
+void econ_server_stop(struct econ_server *srv)
+{
+    uint64_t val = 1;
+
+    if (write(srv->evfd, &val, sizeof(val)) < 0) {
+        perror("write");
+    }
+}
+
+/**
+ *  @details    serve all connections until econ_server_stop() is called.
+ *
+ *  @param      [in]    srv     server.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_server_run(struct econ_server *srv)
+{
+    for (;;) {
+        int nevs = epoll_wait(srv->epfd, srv->events, lengthof(srv->events), -1);
+        if (nevs < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            return -1;
+        }
+
+        for (int i = 0; i < nevs; ++i) {
+            void *ptr = srv->events[i].data.ptr;
+            uint32_t events = srv->events[i].events;
+
+            if (ptr == &srv->evfd) {
+                uint64_t val;
+                if (read(srv->evfd, &val, sizeof(val)) < 0) {
+                    perror("read");
+                }
+                return 0;
+            } else if (ptr == &srv->jobfd) {
+                server_jobs(srv);
+            } else if (ptr == &srv->unix_fd) {
+                server_accept(srv, srv->unix_fd);
+            } else if (ptr == &srv->tcp_fd) {
+                server_accept(srv, srv->tcp_fd);
+            } else {
+                struct connection *conn = ptr;
+                int ret = 0;
+
+                if (conn->closed) {
+                    continue;
+                }
+                if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    ret = conn_input(srv, conn);
+                }
+                if ((conn_flush(srv, conn) != 0) || (ret != 0)
+                    || (conn->closing && (conn->s->out_len == conn->s->out_pos))) {
+                    conn_shut(srv, conn);
+                }
+            }
+        }
+        server_reap(srv);
+    }
+}
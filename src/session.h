@@ -0,0 +1,233 @@
+/** @file       session.h
+ *  @brief      Console session internals.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_SESSION_H__
+#define __ECON_SESSION_H__
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/epoll.h>
+
+#include "econ.h"
+#include "keys.h"
+#include "line.h"
+
+/**
+ *  input ring size, bytes read with one call at most.
+ */
+#define SESSION_INPUT_SIZE (4096)
+
+/**
+ *  longest line accepted, bell is rung beyond.
+ */
+#define SESSION_LINE_MAX (1024 * 1024)
+
+/**
+ *  keys held while a foreground job runs, bell is rung beyond.
+ */
+#define SESSION_AHEAD_SIZE (256)
+
+/**
+ *  most words of a line looked at by completion.
+ */
+#define SESSION_COMPLETE_ARGS (64)
+
+/**
+ *  terminal width assumed when it cannot be queried.
+ */
+#define SESSION_DEFAULT_COLUMNS (80)
+
+/**
+ *  terminal height assumed when it cannot be queried.
+ */
+#define SESSION_DEFAULT_ROWS (24)
+
+/**
+ *  buffered output size written out without waiting for the end of a burst.
+ */
+#define SESSION_FLUSH_THRESHOLD (16 * 1024)
+
+/**
+ *  default limit of queued output of a session on a terminal.
+ */
+#define SESSION_OUTPUT_LIMIT (64 * 1024)
+
+/**
+ *  console session.
+ *
+ *  every piece of mutable console state lives here,
+ *  so that sessions on separate threads never share anything.
+ */
+struct econ_session {
+    int in_fd;                          /**< input fd. */
+    int out_fd;                         /**< output fd. */
+    int epfd;                           /**< input polling fd. */
+    struct epoll_event events[10];      /**< polled events. */
+    bool eof;                           /**< input reached end of file. */
+    bool cr;                            /**< last input byte was CR. */
+
+    char in[SESSION_INPUT_SIZE];        /**< input ring. */
+    size_t in_head;                     /**< consumed position of @c in. */
+    size_t in_tail;                     /**< filled position of @c in. */
+    uint64_t in_ms;                     /**< when input was last read, in milliseconds. */
+    struct key_decoder dec;             /**< input decoder. */
+    struct econ_timer *esc_timer;       /**< wakes the session for a lone ESC, or NULL. */
+    int ahead[SESSION_AHEAD_SIZE];      /**< keys typed while a foreground job runs. */
+    size_t ahead_head;                  /**< consumed position of @c ahead. */
+    size_t ahead_tail;                  /**< filled position of @c ahead. */
+
+    const char *prompt;                 /**< current prompt. */
+    struct line_buffer edit;            /**< edit line. */
+
+    struct econ_history *history;       /**< history, or NULL. */
+    int64_t hist_pos;                   /**< recalled entry, -1 if not recalling. */
+    char *hist_buf;                     /**< scratch for entries. */
+    size_t hist_size;                   /**< size of @c hist_buf. */
+    char *hist_saved;                   /**< line typed before recalling. */
+    size_t hist_saved_len;              /**< length of @c hist_saved. */
+    bool searching;                     /**< reverse-i-search is active. */
+    bool search_failed;                 /**< query has no match. */
+    char query[128];                    /**< search query. */
+    size_t query_len;                   /**< length of @c query. */
+    int64_t match;                      /**< matched entry, -1 if none. */
+
+    struct econ_registry *registry;     /**< commands completed by TAB, or NULL. */
+    struct econ_command *registry_cmds; /**< command list @c registry is built from, NULL if attached. */
+    bool tabbed;                        /**< last key was TAB. */
+
+    struct session_jobs *jobs;          /**< jobs started from this session, or NULL. */
+    int notify_fd;                      /**< fd signaled by jobs, -1 to create one. */
+
+    econ_output_fn output;              /**< output sink. */
+    void *output_ctx;                   /**< output sink context. */
+    char *out;                          /**< output buffer. */
+    size_t out_pos;                     /**< flushed position of @c out. */
+    size_t out_len;                     /**< buffered length of @c out. */
+    size_t out_cap;                     /**< allocated length of @c out. */
+    bool deferred;                      /**< owner flushes, never flush implicitly. */
+    struct econ_stream *capture;        /**< stream taking output buffers, or NULL. */
+    int invoking;                       /**< nesting depth of running commands. */
+
+    size_t out_limit;                   /**< most bytes queued, 0 to write through. */
+    int out_policy;                     /**< policy when @c out_limit is reached. */
+    int flow;                           /**< flow control flags. */
+    bool xoff;                          /**< output paused by DC3. */
+    bool want_out;                      /**< output fd is watched for room. */
+    bool draining;                      /**< keys are read while output waits. */
+    bool interrupted;                   /**< ETX typed while output of a command waited. */
+    bool more;                          /**< --More-- is shown for a foreground job. */
+    size_t page_rows;                   /**< rows of a page. */
+    size_t page_lines;                  /**< lines of command output on this page. */
+    uint64_t dropped;                   /**< bytes dropped, not reported yet. */
+
+    bool line_open;                     /**< econ_session_step() has begun a line. */
+    struct econ_timer *timers;          /**< timers, or NULL. */
+    struct watch *watch;                /**< command repainted on the screen, or NULL. */
+
+    struct econ_session_stats stats;    /**< counters. */
+};
+
+/**
+ *  allocate a session without its own polling fd.
+ */
+struct econ_session *session_alloc(int in_fd, int out_fd);
+
+/**
+ *  start a new line showing @c prompt.
+ */
+void session_begin(struct econ_session *s, const char *prompt);
+
+/**
+ *  consume available input.
+ *
+ *  returns 1 if a line is completed, 0 if more input is needed,
+ *  -1 if input reached end of file.
+ */
+int session_poll(struct econ_session *s);
+
+/**
+ *  split the completed line into @c argv.
+ *
+ *  a line that cannot be split is reported on the session and
+ *  gives no words.
+ */
+int session_parse(struct econ_session *s, char **argv, size_t length);
+
+/**
+ *  redraw prompt and edit line after other output.
+ */
+void session_refresh(struct econ_session *s);
+
+/**
+ *  run @c cmd with output going to the session.
+ */
+int session_run(struct econ_session *s, const struct econ_command *cmd, int argc, char **argv);
+
+/**
+ *  run a line of words on the calling thread with output going to
+ *  the session, jobs are never started.
+ */
+int session_invoke(struct econ_session *s, int argc, char **argv, struct econ_command *cmds);
+
+/**
+ *  get command list of the line running on this thread, or NULL.
+ */
+struct econ_command *session_commands(void);
+
+/**
+ *  get terminal height of the session output.
+ */
+size_t session_rows(struct econ_session *s);
+
+/**
+ *  get terminal width of the session output.
+ */
+size_t session_columns(struct econ_session *s);
+
+/**
+ *  make @c s the session of econ_printf() on this thread.
+ *
+ *  returns the session it was.
+ */
+struct econ_session *session_switch(struct econ_session *s);
+
+/**
+ *  buffer @c len bytes for the session output sink.
+ */
+ssize_t session_write(struct econ_session *s, const void *buf, size_t len);
+
+/**
+ *  flush output buffer to the output sink.
+ *
+ *  a sink returning 0 leaves the rest buffered.
+ */
+int session_flush(struct econ_session *s);
+
+/**
+ *  count @c len bytes of command output against the page.
+ *
+ *  returns bytes up to the end of the page, all of @c len if it
+ *  does not fill the page.
+ */
+size_t session_page_fill(struct econ_session *s, const char *data, size_t len);
+
+/**
+ *  the page is full.
+ */
+bool session_page_full(const struct econ_session *s);
+
+/**
+ *  formatted write to the session output sink.
+ */
+int session_printf(struct econ_session *s, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+#endif /* __ECON_SESSION_H__ */
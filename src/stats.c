@@ -0,0 +1,458 @@
+/** @file       stats.c
+ *  @brief      Latency histograms.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "econ.h"
+#include "utils.h"
+#include "stats.h"
+
+#if STATS_ENABLED
+
+/**
+ *  sub-buckets per power of 2 are 1 << STATS_SUB_BITS.
+ *
+ *  a value falls in a bucket at most 1/16 of it wide, exact below 16.
+ */
+#define STATS_SUB_BITS (4)
+#define STATS_SUB (1 << STATS_SUB_BITS)
+
+/**
+ *  bucket count covering the whole uint64_t range.
+ */
+#define STATS_BUCKETS ((64 - STATS_SUB_BITS + 1) * STATS_SUB)
+
+/**
+ *  most command paths kept, further ones are counted as "(other)".
+ */
+#define STATS_MAX_PATHS (256)
+
+/**
+ *  length of the path hash table. (power of 2)
+ */
+#define STATS_TABLE_SIZE (2 * STATS_MAX_PATHS)
+
+struct stats_hist {
+    const char *name;                   /**< figure name. */
+    const char *unit;                   /**< "ns", or "" for counts. */
+    const void *key;                    /**< command the path leads to. */
+    atomic_uint_fast64_t count;         /**< recorded values. */
+    atomic_uint_fast64_t sum;           /**< sum of values. */
+    atomic_uint_fast64_t max;           /**< largest value. */
+    atomic_uint_fast64_t buckets[STATS_BUCKETS]; /**< counts per bucket. */
+};
+
+static struct stats_hist builtin[] = {
+    {.name = "prompt/echo", .unit = "ns"},
+    {.name = "prompt/wakeups", .unit = ""},
+    {.name = "(other)", .unit = "ns"},
+};
+
+struct stats_hist *const stats_echo = &builtin[0];
+struct stats_hist *const stats_wakeups = &builtin[1];
+
+/**
+ *  command path histograms.
+ */
+static struct {
+    pthread_mutex_t lock;   /**< serializes adding paths. */
+    size_t count;           /**< paths added. */
+    _Atomic(struct stats_hist *) table[STATS_TABLE_SIZE]; /**< by hash. */
+    struct stats_hist *order[STATS_MAX_PATHS]; /**< in order added. */
+} paths = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+uint64_t stats_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ *  get bucket of @c value.
+ */
+static inline size_t stats_bucket(uint64_t value)
+{
+    if (value < STATS_SUB) {
+        return value;
+    }
+    int exp = 63 - __builtin_clzll(value);
+    return (exp - STATS_SUB_BITS + 1) * STATS_SUB + ((value >> (exp - STATS_SUB_BITS)) & (STATS_SUB - 1));
+}
+
+/**
+ *  get largest value falling in @c bucket.
+ */
+static uint64_t stats_bucket_high(size_t bucket)
+{
+    if (bucket < STATS_SUB) {
+        return bucket;
+    }
+    int shift = bucket / STATS_SUB - 1;
+    uint64_t low = (uint64_t)(STATS_SUB + bucket % STATS_SUB) << shift;
+    return low + (((uint64_t)1 << shift) - 1);
+}
+
+void stats_record(struct stats_hist *h, uint64_t value)
+{
+    if (h == NULL) {
+        return;
+    }
+    atomic_fetch_add_explicit(&h->buckets[stats_bucket(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum, value, memory_order_relaxed);
+
+    uint_fast64_t max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    while ((value > max)
+           && !atomic_compare_exchange_weak_explicit(&h->max, &max, value,
+                                                     memory_order_relaxed, memory_order_relaxed)) {
+        continue;
+    }
+}
+
+/**
+ *  find a command in the table.
+ *
+ *  @return     returns the slot holding the command, or the empty slot
+ *              where it belongs.
+ */
+static size_t stats_find(const void *key)
+{
+    size_t slot = (size_t)(((uintptr_t)key >> 4) * 0x9e3779b1u) & (STATS_TABLE_SIZE - 1);
+
+    for (;;) {
+        struct stats_hist *h = atomic_load_explicit(&paths.table[slot], memory_order_acquire);
+        if ((h == NULL) || (h->key == key)) {
+            return slot;
+        }
+        slot = (slot + 1) & (STATS_TABLE_SIZE - 1);
+    }
+}
+
+/**
+ *  join path words by SP into a new string.
+ */
+static char *stats_join(char *const *path, size_t depth)
+{
+    size_t len = 0;
+
+    for (size_t i = 0; i < depth; ++i) {
+        len += strlen(path[i]) + 1;
+    }
+    char *name = malloc(len);
+    if (name == NULL) {
+        return NULL;
+    }
+    char *p = name;
+    for (size_t i = 0; i < depth; ++i) {
+        if (i > 0) {
+            *p++ = ' ';
+        }
+        size_t n = strlen(path[i]);
+        memcpy(p, path[i], n);
+        p += n;
+    }
+    *p = '\0';
+    return name;
+}
+
+struct stats_hist *stats_path(const void *key, char *const *path, size_t depth)
+{
+    size_t slot = stats_find(key);
+    struct stats_hist *h = atomic_load_explicit(&paths.table[slot], memory_order_acquire);
+
+    if (h != NULL) {
+        return h;
+    }
+
+    pthread_mutex_lock(&paths.lock);
+    /* added by another thread in the meantime. */
+    slot = stats_find(key);
+    h = atomic_load_explicit(&paths.table[slot], memory_order_acquire);
+    if ((h == NULL) && (paths.count < STATS_MAX_PATHS)) {
+        h = calloc(1, sizeof(*h));
+        char *name = stats_join(path, depth);
+        if ((h != NULL) && (name != NULL)) {
+            h->name = name;
+            h->unit = "ns";
+            h->key = key;
+            paths.order[paths.count++] = h;
+            atomic_store_explicit(&paths.table[slot], h, memory_order_release);
+        } else {
+            free(name);
+            free(h);
+            h = NULL;
+        }
+    }
+    pthread_mutex_unlock(&paths.lock);
+
+    return (h) ?: &builtin[lengthof(builtin) - 1];
+}
+
+/**
+ *  get value at quantile @c q of @c h.
+ */
+static uint64_t stats_quantile(const struct stats_hist *h, uint64_t count, uint64_t max, double q)
+{
+    uint64_t rank = (uint64_t)(q * count + 0.999999);
+    uint64_t seen = 0;
+
+    if (rank == 0) {
+        rank = 1;
+    }
+    for (size_t i = 0; i < STATS_BUCKETS; ++i) {
+        seen += atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        if (seen >= rank) {
+            uint64_t high = stats_bucket_high(i);
+            return (high < max) ? high : max;
+        }
+    }
+    return max;
+}
+
+/**
+ *  summarize @c h into @c st.
+ */
+static void stats_summary(const struct stats_hist *h, struct econ_stats *st)
+{
+    memset(st, 0, sizeof(*st));
+    st->name = h->name;
+    st->unit = h->unit;
+    st->count = atomic_load_explicit(&h->count, memory_order_relaxed);
+    st->max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    if (st->count > 0) {
+        st->mean = atomic_load_explicit(&h->sum, memory_order_relaxed) / st->count;
+        st->p50 = stats_quantile(h, st->count, st->max, 0.50);
+        st->p99 = stats_quantile(h, st->count, st->max, 0.99);
+        st->p999 = stats_quantile(h, st->count, st->max, 0.999);
+    }
+}
+
+/**
+ *  clear @c h.
+ */
+static void stats_clear(struct stats_hist *h)
+{
+    for (size_t i = 0; i < STATS_BUCKETS; ++i) {
+        atomic_store_explicit(&h->buckets[i], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&h->count, 0, memory_order_relaxed);
+    atomic_store_explicit(&h->sum, 0, memory_order_relaxed);
+    atomic_store_explicit(&h->max, 0, memory_order_relaxed);
+}
+
+/**
+ *  @details    get summaries of all figures.
+ *
+ *              prompt figures come first, then command paths in the
+ *              order they were first run. names stay valid until exit.
+ *
+ *  @param      [out]   list    summaries.
+ *  @param      [in]    length  length of @c list.
+ *  @return     returns figure count, which may be more than @c length.
+ */
+size_t econ_stats_list(struct econ_stats *list, size_t length)
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < lengthof(builtin); ++i, ++n) {
+        if (n < length) {
+            stats_summary(&builtin[i], &list[n]);
+        }
+    }
+    pthread_mutex_lock(&paths.lock);
+    for (size_t i = 0; i < paths.count; ++i, ++n) {
+        if (n < length) {
+            stats_summary(paths.order[i], &list[n]);
+        }
+    }
+    pthread_mutex_unlock(&paths.lock);
+
+    return n;
+}
+
+/**
+ *  @details    get summary of one figure.
+ *
+ *  @param      [in]    name    command path with words joined by SP,
+ *                              or a prompt figure name.
+ *  @param      [out]   st      summary.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_stats_get(const char *name, struct econ_stats *st)
+{
+    for (size_t i = 0; i < lengthof(builtin); ++i) {
+        if (strcmp(builtin[i].name, name) == 0) {
+            stats_summary(&builtin[i], st);
+            return 0;
+        }
+    }
+
+    int ret = -1;
+    pthread_mutex_lock(&paths.lock);
+    for (size_t i = 0; i < paths.count; ++i) {
+        if (strcmp(paths.order[i]->name, name) == 0) {
+            stats_summary(paths.order[i], st);
+            ret = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&paths.lock);
+    if (ret != 0) {
+        errno = ENOENT;
+    }
+
+    return ret;
+}
+
+/**
+ *  @details    clear all figures.
+ *
+ *              values recorded at the same time may be partly kept.
+ */
+void econ_stats_reset(void)
+{
+    for (size_t i = 0; i < lengthof(builtin); ++i) {
+        stats_clear(&builtin[i]);
+    }
+    pthread_mutex_lock(&paths.lock);
+    for (size_t i = 0; i < paths.count; ++i) {
+        stats_clear(paths.order[i]);
+    }
+    pthread_mutex_unlock(&paths.lock);
+}
+
+/**
+ *  format @c value of @c unit in a short form.
+ */
+static const char *stats_format(char *buf, size_t len, uint64_t value, const char *unit)
+{
+    if (strcmp(unit, "ns") != 0) {
+        snprintf(buf, len, "%" PRIu64, value);
+    } else if (value < 1000) {
+        snprintf(buf, len, "%" PRIu64 "ns", value);
+    } else if (value < 1000000) {
+        snprintf(buf, len, "%.1fus", value / 1e3);
+    } else if (value < 1000000000) {
+        snprintf(buf, len, "%.1fms", value / 1e6);
+    } else {
+        snprintf(buf, len, "%.2fs", value / 1e9);
+    }
+    return buf;
+}
+
+/**
+ *  print one summary line.
+ */
+static void stats_print(const struct econ_stats *st, int width)
+{
+    char b[5][16];
+
+    econ_printf("%-*s %10" PRIu64 " %8s %8s %8s %8s %8s\r\n", width, st->name, st->count,
+                stats_format(b[0], sizeof(b[0]), st->mean, st->unit),
+                stats_format(b[1], sizeof(b[1]), st->p50, st->unit),
+                stats_format(b[2], sizeof(b[2]), st->p99, st->unit),
+                stats_format(b[3], sizeof(b[3]), st->p999, st->unit),
+                stats_format(b[4], sizeof(b[4]), st->max, st->unit));
+}
+
+void econ_stats_usage(const char *name)
+{
+    econ_printf("usage: %s [reset | name ...]\r\n", name);
+}
+
+/**
+ *  stats command.
+ *
+ *  @details    without arguments, figures recorded so far are printed.
+ *              names select figures, "reset" clears all of them.
+ *  @param      [in]    argc    argument count.
+ *  @param      [in]    argv    argument values.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned.
+ */
+int econ_stats_command(int argc, char **argv)
+{
+    if ((argc == 2) && (strcmp(argv[1], "reset") == 0)) {
+        econ_stats_reset();
+        return 0;
+    }
+
+    size_t count = econ_stats_list(NULL, 0);
+    struct econ_stats *list = calloc(count, sizeof(*list));
+    if (list == NULL) {
+        econ_printf("%s: %s\r\n", argv[0], strerror(errno));
+        return 0;
+    }
+    count = econ_stats_list(list, count);
+
+    int width = strlen("name");
+    for (size_t i = 0; i < count; ++i) {
+        if ((int)strlen(list[i].name) > width) {
+            width = strlen(list[i].name);
+        }
+    }
+    econ_printf("%-*s %10s %8s %8s %8s %8s %8s\r\n", width, "name", "count", "mean", "p50", "p99", "p99.9", "max");
+    for (size_t i = 0; i < count; ++i) {
+        bool selected = (argc == 1) && (list[i].count > 0);
+        for (int j = 1; j < argc; ++j) {
+            selected = selected || (strcmp(argv[j], list[i].name) == 0);
+        }
+        if (selected) {
+            stats_print(&list[i], width);
+        }
+    }
+    free(list);
+
+    return 0;
+}
+
+#else
+
+size_t econ_stats_list(struct econ_stats *list, size_t length)
+{
+    return 0;
+}
+
+int econ_stats_get(const char *name, struct econ_stats *st)
+{
+    errno = ENOTSUP;
+    return -1;
+}
+
+void econ_stats_reset(void)
+{
+}
+
+void econ_stats_usage(const char *name)
+{
+    econ_printf("usage: %s [reset | name ...]\r\n", name);
+}
+
+int econ_stats_command(int argc, char **argv)
+{
+    econ_printf("%s: not compiled in (NODEBUG=1)\r\n", argv[0]);
+    return 0;
+}
+
+#endif /* STATS_ENABLED */
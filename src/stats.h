@@ -0,0 +1,84 @@
+/** @file       stats.h
+ *  @brief      Latency histograms.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_STATS_H__
+#define __ECON_STATS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ *  instrumentation is compiled in.
+ */
+#if defined(NODEBUG) && (NODEBUG == 1)
+#define STATS_ENABLED (0)
+#else
+#define STATS_ENABLED (1)
+#endif
+
+/**
+ *  histogram of one figure.
+ */
+struct stats_hist;
+
+#if STATS_ENABLED
+
+/**
+ *  time from wake-up on input to the echo being written.
+ */
+extern struct stats_hist *const stats_echo;
+
+/**
+ *  wake-ups for one prompted line.
+ */
+extern struct stats_hist *const stats_wakeups;
+
+/**
+ *  get monotonic time in nanoseconds.
+ */
+uint64_t stats_now(void);
+
+/**
+ *  get histogram of the command @c key reached by words
+ *  @c path[0] .. @c path[depth - 1].
+ *
+ *  looked up by @c key, the words only name it on first use.
+ *  never freed.
+ */
+struct stats_hist *stats_path(const void *key, char *const *path, size_t depth);
+
+/**
+ *  add @c value to @c h.
+ *
+ *  safe from any thread. does nothing if @c h is NULL.
+ */
+void stats_record(struct stats_hist *h, uint64_t value);
+
+#else
+
+#define stats_echo ((struct stats_hist *)NULL)
+#define stats_wakeups ((struct stats_hist *)NULL)
+
+static inline uint64_t stats_now(void)
+{
+    return 0;
+}
+
+static inline struct stats_hist *stats_path(const void *key, char *const *path, size_t depth)
+{
+    return NULL;
+}
+
+static inline void stats_record(struct stats_hist *h, uint64_t value)
+{
+}
+
+#endif /* STATS_ENABLED */
+
+#endif /* __ECON_STATS_H__ */
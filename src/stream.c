@@ -0,0 +1,265 @@
+/** @file       stream.c
+ *  @brief      Byte stream between piped commands.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "econ.h"
+#include "ascii.h"
+#include "session.h"
+#include "stream.h"
+
+_Thread_local struct econ_stream *stream_input = NULL;
+
+static void chunk_release(struct stream_chunk *chunk)
+{
+    if (--chunk->refs == 0) {
+        free(chunk->data);
+        free(chunk);
+    }
+}
+
+struct econ_stream *stream_create(void)
+{
+    return calloc(1, sizeof(struct econ_stream));
+}
+
+void stream_destroy(struct econ_stream *st)
+{
+    if (st == NULL) {
+        return;
+    }
+    econ_stream_skip(st, st->length);
+    free(st->scratch);
+    free(st);
+}
+
+int stream_append_slice(struct econ_stream *st, struct stream_chunk *chunk, size_t off, size_t len)
+{
+    if (len == 0) {
+        return 0;
+    }
+
+    /* adjacent parts of one chunk, such as lines passed by a filter, are merged. */
+    struct stream_slice *tail = st->tail;
+    if ((tail != NULL) && (tail->chunk == chunk) && (tail->off + tail->len == off)) {
+        tail->len += len;
+        st->length += len;
+        return 0;
+    }
+
+    struct stream_slice *slice = malloc(sizeof(*slice));
+    if (slice == NULL) {
+        return -1;
+    }
+    slice->chunk = chunk;
+    slice->off = off;
+    slice->len = len;
+    slice->next = NULL;
+    ++chunk->refs;
+    if (tail != NULL) {
+        tail->next = slice;
+    } else {
+        st->head = slice;
+    }
+    st->tail = slice;
+    st->length += len;
+
+    return 0;
+}
+
+int stream_append_buffer(struct econ_stream *st, char *data, size_t off, size_t len)
+{
+    struct stream_chunk *chunk = malloc(sizeof(*chunk));
+    if (chunk == NULL) {
+        return -1;
+    }
+    chunk->refs = 1;
+    chunk->data = data;
+
+    int ret = stream_append_slice(st, chunk, off, len);
+    chunk_release(chunk);
+
+    return ret;
+}
+
+/**
+ *  @details    get the input stream of the running command.
+ *
+ *  @return     returns the stream fed by the previous command of a pipeline.
+ *              otherwise, NULL is returned.
+ */
+struct econ_stream *econ_input(void)
+{
+    return stream_input;
+}
+
+/**
+ *  @details    get number of unread bytes.
+ *
+ *  @param      [in]    st      stream.
+ *  @return     returns unread length.
+ */
+size_t econ_stream_length(const struct econ_stream *st)
+{
+    return (st != NULL) ? st->length : 0;
+}
+
+/**
+ *  @details    peek at the next line without consuming it.
+ *
+ *              the line is not terminated and includes its LF, if any.
+ *              the pointer stays valid until the stream is consumed.
+ *
+ *  @param      [in]    st      stream.
+ *  @param      [out]   line    start of line.
+ *  @return     returns line length.
+ *              at end of stream, 0 is returned.
+ *              on error, -1 is returned, and @c errno set.
+ */
+ssize_t econ_stream_peek_line(struct econ_stream *st, const char **line)
+{
+    struct stream_slice *slice = (st != NULL) ? st->head : NULL;
+    if (slice == NULL) {
+        return 0;
+    }
+
+    const char *p = &slice->chunk->data[slice->off];
+    const char *lf = memchr(p, LF, slice->len);
+    if ((lf != NULL) || (slice->next == NULL)) {
+        *line = p;
+        return (lf != NULL) ? (lf - p + 1) : slice->len;
+    }
+
+    /* the line continues in the next slices. */
+    size_t len = 0;
+    for (; slice != NULL; slice = slice->next) {
+        p = &slice->chunk->data[slice->off];
+        lf = memchr(p, LF, slice->len);
+        size_t part = (lf != NULL) ? (lf - p + 1) : slice->len;
+        if (len + part > st->scratch_cap) {
+            size_t cap = (st->scratch_cap > 0) ? st->scratch_cap : 256;
+            while (cap < len + part) {
+                cap *= 2;
+            }
+            char *scratch = realloc(st->scratch, cap);
+            if (scratch == NULL) {
+                return -1;
+            }
+            st->scratch = scratch;
+            st->scratch_cap = cap;
+        }
+        memcpy(&st->scratch[len], p, part);
+        len += part;
+        if (lf != NULL) {
+            break;
+        }
+    }
+    *line = st->scratch;
+
+    return len;
+}
+
+/**
+ *  @details    discard up to @c len bytes.
+ *
+ *  @param      [in]    st      stream.
+ *  @param      [in]    len     length to discard.
+ *  @return     returns discarded length.
+ */
+size_t econ_stream_skip(struct econ_stream *st, size_t len)
+{
+    size_t done = 0;
+
+    while ((st != NULL) && (st->head != NULL) && (done < len)) {
+        struct stream_slice *slice = st->head;
+        size_t part = len - done;
+
+        if (part < slice->len) {
+            slice->off += part;
+            slice->len -= part;
+        } else {
+            part = slice->len;
+            st->head = slice->next;
+            if (st->head == NULL) {
+                st->tail = NULL;
+            }
+            chunk_release(slice->chunk);
+            free(slice);
+        }
+        st->length -= part;
+        done += part;
+    }
+
+    return done;
+}
+
+/**
+ *  @details    read up to @c len bytes.
+ *
+ *  @param      [in]    st      stream.
+ *  @param      [out]   buf     buffer.
+ *  @param      [in]    len     buffer length.
+ *  @return     returns read length, 0 at end of stream.
+ */
+ssize_t econ_stream_read(struct econ_stream *st, void *buf, size_t len)
+{
+    size_t done = 0;
+
+    for (struct stream_slice *slice = (st) ? st->head : NULL;
+         (slice != NULL) && (done < len); slice = slice->next) {
+        size_t part = (slice->len < len - done) ? slice->len : len - done;
+        memcpy((char *)buf + done, &slice->chunk->data[slice->off], part);
+        done += part;
+    }
+
+    return econ_stream_skip(st, done);
+}
+
+/**
+ *  @details    pass up to @c len bytes to the output of the running command.
+ *
+ *              inside a pipeline, the buffers holding the bytes are
+ *              shared with the next command, nothing is copied.
+ *
+ *  @param      [in]    st      stream.
+ *  @param      [in]    len     length to pass.
+ *  @return     returns passed length.
+ *              on error, -1 is returned, and @c errno set.
+ */
+ssize_t econ_stream_forward(struct econ_stream *st, size_t len)
+{
+    struct econ_session *out = econ_session_current();
+    size_t done = 0;
+
+    if ((out != NULL) && (out->capture != NULL)) {
+        /* keep order with output buffered so far. */
+        if (session_flush(out) != 0) {
+            return -1;
+        }
+    }
+    for (struct stream_slice *slice = (st) ? st->head : NULL;
+         (slice != NULL) && (done < len); slice = slice->next) {
+        size_t part = (slice->len < len - done) ? slice->len : len - done;
+        int ret;
+
+        if ((out != NULL) && (out->capture != NULL)) {
+            ret = stream_append_slice(out->capture, slice->chunk, slice->off, part);
+        } else {
+            ret = (econ_write(&slice->chunk->data[slice->off], part) < 0) ? -1 : 0;
+        }
+        if (ret != 0) {
+            return -1;
+        }
+        done += part;
+    }
+
+    return econ_stream_skip(st, done);
+}
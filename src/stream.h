@@ -0,0 +1,74 @@
+/** @file       stream.h
+ *  @brief      Byte stream between piped commands.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_STREAM_H__
+#define __ECON_STREAM_H__
+
+#include <stddef.h>
+
+#include "econ.h"
+
+/**
+ *  shared buffer.
+ *
+ *  a chunk is the output buffer of a command handed over as is,
+ *  and is released when no slice refers to it.
+ */
+struct stream_chunk {
+    size_t refs;    /**< number of slices referring to the chunk. */
+    char *data;     /**< buffer. */
+};
+
+/**
+ *  part of a chunk queued in a stream.
+ */
+struct stream_slice {
+    struct stream_chunk *chunk; /**< referred chunk. */
+    size_t off;                 /**< start of data in the chunk. */
+    size_t len;                 /**< data length. */
+    struct stream_slice *next;  /**< next slice. */
+};
+
+/**
+ *  byte stream.
+ */
+struct econ_stream {
+    struct stream_slice *head;  /**< first slice. */
+    struct stream_slice *tail;  /**< last slice. */
+    size_t length;              /**< queued bytes. */
+    char *scratch;              /**< line assembled across slices. */
+    size_t scratch_cap;         /**< allocated length of @c scratch. */
+};
+
+/**
+ *  input stream of the command running on this thread.
+ */
+extern _Thread_local struct econ_stream *stream_input;
+
+/**
+ *  create an empty stream.
+ */
+struct econ_stream *stream_create(void);
+
+/**
+ *  release the stream and unread data.
+ */
+void stream_destroy(struct econ_stream *st);
+
+/**
+ *  queue @c len bytes at @c off of @c data, taking ownership of @c data.
+ */
+int stream_append_buffer(struct econ_stream *st, char *data, size_t off, size_t len);
+
+/**
+ *  queue @c len bytes at @c off of @c chunk, sharing the chunk.
+ */
+int stream_append_slice(struct econ_stream *st, struct stream_chunk *chunk, size_t off, size_t len);
+
+#endif /* __ECON_STREAM_H__ */
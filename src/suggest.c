@@ -0,0 +1,335 @@
+/** @file       suggest.c
+ *  @brief      Suggestions of command names.
+ *
+ *  names are compared with the typed word by the bit-parallel edit
+ *  distance of Myers, in the global form of Hyyrö: the word is a bit
+ *  vector of one machine word, and every character of a name costs
+ *  a handful of word operations.
+ *
+ *  an index keeps names grouped by length with a signature of their
+ *  characters, so that names which cannot be close are skipped
+ *  without being read: the distance is at least the difference of
+ *  lengths, and at least the number of characters one has and the
+ *  other lacks.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-17 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "econ.h"
+#include "suggest.h"
+
+/**
+ *  indexed name.
+ */
+struct suggest_name {
+    const char *name;   /**< name. */
+    size_t length;      /**< length of @c name. */
+    uint64_t sig;       /**< characters of @c name. */
+    size_t order;       /**< position given at indexing. */
+};
+
+struct suggest_index {
+    struct suggest_name *names; /**< names in length order. */
+    size_t count;               /**< number of names. */
+    size_t *starts;             /**< first name of each length, @c max_length + 2 of them. */
+    size_t max_length;          /**< longest name. */
+};
+
+/**
+ *  typed word prepared for comparisons.
+ */
+struct suggest_query {
+    uint64_t peq[256];  /**< positions of each character in the word. */
+    size_t length;      /**< length of the word. */
+    uint64_t sig;       /**< characters of the word. */
+};
+
+/**
+ *  get signature of the characters of @c s.
+ */
+static uint64_t suggest_sig(const char *s, size_t len)
+{
+    uint64_t sig = 0;
+
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char c = s[i];
+        /* letters and digits get bits of their own, others share. */
+        int bit = ((c | 0x20) >= 'a') && ((c | 0x20) <= 'z') ? (c | 0x20) - 'a'
+                : (c >= '0') && (c <= '9') ? 26 + (c - '0')
+                : 36 + (c % 28);
+        sig |= 1ULL << bit;
+    }
+    return sig;
+}
+
+/**
+ *  prepare @c word, which is 1 to @ref SUGGEST_WORD_MAX long.
+ */
+static void suggest_prepare(struct suggest_query *q, const char *word, size_t len)
+{
+    memset(q->peq, 0, sizeof(q->peq));
+    for (size_t i = 0; i < len; ++i) {
+        q->peq[(unsigned char)word[i]] |= 1ULL << i;
+    }
+    q->length = len;
+    q->sig = suggest_sig(word, len);
+}
+
+/**
+ *  get edit distance of the query and @c text, giving up beyond @c limit.
+ */
+static int suggest_myers(const struct suggest_query *q, const char *text, size_t len, int limit)
+{
+    uint64_t pv = ~0ULL, mv = 0;
+    const uint64_t last = 1ULL << (q->length - 1);
+    int score = q->length;
+
+    for (size_t j = 0; j < len; ++j) {
+        uint64_t eq = q->peq[(unsigned char)text[j]];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+
+        if (ph & last) {
+            ++score;
+        } else if (mh & last) {
+            --score;
+        }
+        /* every column of the top row is one more, the whole word must match. */
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        /* each remaining character lowers the score by one at most. */
+        if (score - (int)(len - j - 1) > limit) {
+            return limit + 1;
+        }
+    }
+
+    return (score > limit) ? limit + 1 : score;
+}
+
+/**
+ *  get largest distance worth suggesting for a word of @c len.
+ */
+static int suggest_limit(size_t len)
+{
+    return (len < 4) ? 1 : (len < 8) ? 2 : 3;
+}
+
+/**
+ *  add a candidate to the @c *n best of @c out, closest first.
+ *
+ *  names farther than one edit beyond the closest one are not worth
+ *  showing next to it.
+ *
+ *  @return returns the distance a candidate has to be within from now.
+ */
+static int suggest_keep(struct suggestion *out, size_t k, size_t *n,
+                        const char *name, int distance, size_t order, int limit)
+{
+    size_t pos = *n;
+
+    while ((pos > 0) && ((out[pos - 1].distance > distance)
+                         || ((out[pos - 1].distance == distance) && (out[pos - 1].order > order)))) {
+        --pos;
+    }
+    if (pos < k) {
+        size_t moved = ((*n < k) ? *n : k - 1) - pos;
+        memmove(&out[pos + 1], &out[pos], sizeof(*out) * moved);
+        out[pos].name = name;
+        out[pos].distance = distance;
+        out[pos].order = order;
+        if (*n < k) {
+            ++*n;
+        }
+    }
+
+    if ((*n > 0) && (out[0].distance + 1 < limit)) {
+        limit = out[0].distance + 1;
+        while (out[*n - 1].distance > limit) {
+            --*n;
+        }
+    }
+    return ((*n == k) && (out[k - 1].distance < limit)) ? out[k - 1].distance : limit;
+}
+
+int suggest_distance(const char *word, const char *name, int limit)
+{
+    size_t len = strlen(word);
+    if ((len == 0) || (len > SUGGEST_WORD_MAX)) {
+        return limit + 1;
+    }
+
+    struct suggest_query q;
+    suggest_prepare(&q, word, len);
+    return suggest_myers(&q, name, strlen(name), limit);
+}
+
+static int compare_name(const void *a, const void *b)
+{
+    const struct suggest_name *na = a, *nb = b;
+
+    if (na->length != nb->length) {
+        return (na->length < nb->length) ? -1 : 1;
+    }
+    return (na->order < nb->order) ? -1 : (na->order > nb->order);
+}
+
+struct suggest_index *suggest_index_create(const char *const *names, size_t count)
+{
+    struct suggest_index *idx = calloc(1, sizeof(*idx));
+    if (idx == NULL) {
+        return NULL;
+    }
+    idx->names = malloc(sizeof(*idx->names) * (count + 1));
+    if (idx->names == NULL) {
+        free(idx);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        struct suggest_name *n = &idx->names[i];
+
+        n->name = names[i];
+        n->length = strlen(names[i]);
+        n->sig = suggest_sig(n->name, n->length);
+        n->order = i;
+        if (n->length > idx->max_length) {
+            idx->max_length = n->length;
+        }
+    }
+    idx->count = count;
+    qsort(idx->names, count, sizeof(*idx->names), compare_name);
+
+    idx->starts = malloc(sizeof(*idx->starts) * (idx->max_length + 2));
+    if (idx->starts == NULL) {
+        suggest_index_destroy(idx);
+        return NULL;
+    }
+    size_t pos = 0;
+    for (size_t len = 0; len <= idx->max_length + 1; ++len) {
+        while ((pos < count) && (idx->names[pos].length < len)) {
+            ++pos;
+        }
+        idx->starts[len] = pos;
+    }
+
+    return idx;
+}
+
+void suggest_index_destroy(struct suggest_index *idx)
+{
+    if (idx == NULL) {
+        return;
+    }
+
+    free(idx->names);
+    free(idx->starts);
+    free(idx);
+}
+
+/**
+ *  compare the names of length @c len with the query.
+ */
+static int suggest_bucket(const struct suggest_index *idx, const struct suggest_query *q, size_t len,
+                          struct suggestion *out, size_t k, size_t *n, int limit)
+{
+    if ((len == 0) || (len > idx->max_length)) {
+        return limit;
+    }
+
+    for (size_t i = idx->starts[len]; i < idx->starts[len + 1]; ++i) {
+        const struct suggest_name *name = &idx->names[i];
+        int missing = __builtin_popcountll(q->sig & ~name->sig);
+        int extra = __builtin_popcountll(name->sig & ~q->sig);
+
+        if ((missing > limit) || (extra > limit)) {
+            continue;
+        }
+        int distance = suggest_myers(q, name->name, len, limit);
+        if (distance <= limit) {
+            limit = suggest_keep(out, k, n, name->name, distance, name->order, limit);
+        }
+    }
+
+    return limit;
+}
+
+size_t suggest_index_find(const struct suggest_index *idx, const char *word,
+                          struct suggestion *out, size_t k)
+{
+    size_t len = strlen(word);
+    size_t n = 0;
+
+    if ((idx == NULL) || (k == 0) || (len == 0) || (len > SUGGEST_WORD_MAX)) {
+        return 0;
+    }
+
+    struct suggest_query q;
+    suggest_prepare(&q, word, len);
+
+    /* nearest lengths first, the limit tightens as the best fill up. */
+    int limit = suggest_limit(len);
+    for (size_t diff = 0; (int)diff <= limit; ++diff) {
+        limit = suggest_bucket(idx, &q, len + diff, out, k, &n, limit);
+        if ((diff > 0) && (diff < len) && ((int)diff <= limit)) {
+            limit = suggest_bucket(idx, &q, len - diff, out, k, &n, limit);
+        }
+    }
+
+    return n;
+}
+
+size_t suggest_commands(const struct econ_command *cmds, const char *word,
+                        struct suggestion *out, size_t k)
+{
+    size_t len = strlen(word);
+    size_t n = 0;
+
+    if ((k == 0) || (len == 0) || (len > SUGGEST_WORD_MAX)) {
+        return 0;
+    }
+
+    struct suggest_query q;
+    suggest_prepare(&q, word, len);
+
+    int limit = suggest_limit(len);
+    for (size_t i = 0; cmds[i].command != NULL; ++i) {
+        const char *name = cmds[i].command;
+        size_t name_len = strlen(name);
+
+        if (((name_len > len) ? name_len - len : len - name_len) > (size_t)limit) {
+            continue;
+        }
+        int distance = suggest_myers(&q, name, name_len, limit);
+        if (distance <= limit) {
+            limit = suggest_keep(out, k, &n, name, distance, i, limit);
+        }
+    }
+
+    return n;
+}
+
+void suggest_print(const char *word, const struct suggestion *out, size_t n)
+{
+    econ_printf("%s: command not found\r\n", word);
+    if (n == 0) {
+        econ_printf("'" SUGGEST_LIST_WORD "' lists available commands.\r\n");
+        return;
+    }
+    econ_printf("did you mean:");
+    for (size_t i = 0; i < n; ++i) {
+        econ_printf("%s %s", (i > 0) ? "," : "", out[i].name);
+    }
+    econ_printf("?\r\n");
+}
@@ -0,0 +1,84 @@
+/** @file       suggest.h
+ *  @brief      Suggestions of command names.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-17 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_SUGGEST_H__
+#define __ECON_SUGGEST_H__
+
+#include <stddef.h>
+
+#include "econ.h"
+
+/**
+ *  most suggestions shown for an unknown command.
+ */
+#define SUGGEST_MAX (3)
+
+/**
+ *  longest word suggestions are made for.
+ */
+#define SUGGEST_WORD_MAX (64)
+
+/**
+ *  word that lists commands of a level.
+ */
+#define SUGGEST_LIST_WORD "?"
+
+/**
+ *  suggested name.
+ */
+struct suggestion {
+    const char *name;   /**< name. */
+    int distance;       /**< edit distance from the word. */
+    size_t order;       /**< position of the name, breaks ties. */
+};
+
+/**
+ *  names indexed for suggestions.
+ */
+struct suggest_index;
+
+/**
+ *  index @c count names.
+ *
+ *  strings are referenced, not copied.
+ */
+struct suggest_index *suggest_index_create(const char *const *names, size_t count);
+
+/**
+ *  destroy index.
+ */
+void suggest_index_destroy(struct suggest_index *idx);
+
+/**
+ *  find up to @c k names of @c idx closest to @c word.
+ *
+ *  returns number of suggestions, closest first.
+ */
+size_t suggest_index_find(const struct suggest_index *idx, const char *word,
+                          struct suggestion *out, size_t k);
+
+/**
+ *  find up to @c k names of @c cmds closest to @c word, without an index.
+ */
+size_t suggest_commands(const struct econ_command *cmds, const char *word,
+                        struct suggestion *out, size_t k);
+
+/**
+ *  get edit distance of @c word and @c name, if within @c limit.
+ *
+ *  returns @c limit + 1 if farther.
+ */
+int suggest_distance(const char *word, const char *name, int limit);
+
+/**
+ *  report unknown command @c word with suggestions.
+ */
+void suggest_print(const char *word, const struct suggestion *out, size_t n);
+
+#endif /* __ECON_SUGGEST_H__ */
@@ -0,0 +1,203 @@
+/** @file       timer.c
+ *  @brief      Session timers.
+ *
+ *  every timer is a timerfd polled by the session, so that it fires
+ *  from econ_session_prompt() and econ_session_step() on the thread
+ *  of the session, between keystrokes.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#include "econ.h"
+#include "ascii.h"
+#include "jobs.h"
+#include "session.h"
+#include "timer.h"
+
+struct econ_timer {
+    struct econ_session *owner; /**< session polling the timer. */
+    int fd;                     /**< timerfd. */
+    econ_timer_fn fn;           /**< callback. */
+    void *ctx;                  /**< callback context. */
+    struct econ_timer *next;    /**< next timer of the owner. */
+};
+
+/**
+ *  convert milliseconds to timespec.
+ */
+static struct timespec timer_spec(uint64_t ms)
+{
+    struct timespec ts = {
+        .tv_sec = ms / 1000,
+        .tv_nsec = (ms % 1000) * 1000000,
+    };
+    return ts;
+}
+
+/**
+ *  @details    add a timer to the session.
+ *
+ *              @c fn is called from econ_session_prompt() or
+ *              econ_session_step() of the session, first after
+ *              @c delay_ms, then every @c interval_ms. its output shows
+ *              above the prompt.
+ *
+ *  @param      [in]    s           session.
+ *  @param      [in]    delay_ms    milliseconds to the first call.
+ *  @param      [in]    interval_ms milliseconds between calls, 0 for once.
+ *  @param      [in]    fn          callback.
+ *  @param      [in]    ctx         context passed to @c fn.
+ *  @return     returns timer on success.
+ *              on error, NULL is returned, and @c errno set.
+ */
+struct econ_timer *econ_timer_add(struct econ_session *s, uint64_t delay_ms, uint64_t interval_ms,
+                                  econ_timer_fn fn, void *ctx)
+{
+    if ((s == NULL) || (s->epfd < 0) || (fn == NULL)) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    struct econ_timer *t = calloc(1, sizeof(*t));
+    if (t == NULL) {
+        return NULL;
+    }
+    t->owner = s;
+    t->fn = fn;
+    t->ctx = ctx;
+    t->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (t->fd < 0) {
+        free(t);
+        return NULL;
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = t->fd;
+    if ((epoll_ctl(s->epfd, EPOLL_CTL_ADD, t->fd, &ev) != 0)
+        || (econ_timer_set(t, delay_ms, interval_ms) != 0)) {
+        int saved = errno;
+        close(t->fd);
+        free(t);
+        errno = saved;
+        return NULL;
+    }
+    t->next = s->timers;
+    s->timers = t;
+
+    return t;
+}
+
+/**
+ *  @details    restart the timer.
+ *
+ *              a delay of 0 fires as soon as the session polls.
+ *
+ *  @param      [in]    t           timer.
+ *  @param      [in]    delay_ms    milliseconds to the next call.
+ *  @param      [in]    interval_ms milliseconds between calls, 0 for once.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+int econ_timer_set(struct econ_timer *t, uint64_t delay_ms, uint64_t interval_ms)
+{
+    struct itimerspec its = {
+        .it_interval = timer_spec(interval_ms),
+        .it_value = timer_spec(delay_ms),
+    };
+    if (delay_ms == 0) {
+        /* zero would disarm it. */
+        its.it_value.tv_nsec = 1;
+    }
+
+    return timerfd_settime(t->fd, 0, &its, NULL);
+}
+
+/**
+ *  @details    remove the timer.
+ *
+ *              a callback may remove its own timer.
+ *
+ *  @param      [in]    t       timer, or NULL.
+ */
+void econ_timer_remove(struct econ_timer *t)
+{
+    if (t == NULL) {
+        return;
+    }
+
+    struct econ_session *s = t->owner;
+    for (struct econ_timer **pp = &s->timers; *pp != NULL; pp = &(*pp)->next) {
+        if (*pp == t) {
+            *pp = t->next;
+            break;
+        }
+    }
+    epoll_ctl(s->epfd, EPOLL_CTL_DEL, t->fd, NULL);
+    close(t->fd);
+    free(t);
+}
+
+bool session_timer_fire(struct econ_session *s, int fd)
+{
+    struct econ_timer *t = s->timers;
+    while ((t != NULL) && (t->fd != fd)) {
+        t = t->next;
+    }
+    if (t == NULL) {
+        return false;
+    }
+
+    uint64_t expirations;
+    if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+        /* restarted since it was polled. */
+        return true;
+    }
+
+    bool at_prompt = !session_jobs_busy(s) && (s->prompt != NULL) && (s->watch == NULL);
+    bool deferred = s->deferred;
+    s->deferred = true;
+    if (at_prompt) {
+        session_write(s, "\r\033[K", 4);
+    }
+    size_t queued = s->out_len - s->out_pos;
+
+    struct econ_session *saved = session_switch(s);
+    t->fn(t, t->ctx);
+    session_switch(saved);
+
+    if (at_prompt) {
+        if (s->out_len - s->out_pos == queued) {
+            /* nothing shown, the line stays as it is. */
+            s->out_len -= 4;
+        } else {
+            if (s->out[s->out_len - 1] != LF) {
+                session_write(s, "\r\n", 2);
+            }
+            session_refresh(s);
+        }
+    }
+    s->deferred = deferred;
+
+    return true;
+}
+
+void session_timers_release(struct econ_session *s)
+{
+    while (s->timers != NULL) {
+        econ_timer_remove(s->timers);
+    }
+}
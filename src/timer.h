@@ -0,0 +1,29 @@
+/** @file       timer.h
+ *  @brief      Session timers.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_TIMER_H__
+#define __ECON_TIMER_H__
+
+#include <stdbool.h>
+
+#include "econ.h"
+
+/**
+ *  run the timer of the session on @c fd, if it is one.
+ *
+ *  output of the callback shows above the prompt.
+ */
+bool session_timer_fire(struct econ_session *s, int fd);
+
+/**
+ *  remove every timer of a session being destroyed.
+ */
+void session_timers_release(struct econ_session *s);
+
+#endif /* __ECON_TIMER_H__ */
@@ -0,0 +1,186 @@
+/** @file       token.c
+ *  @brief      Command line tokenizer.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "ascii.h"
+#include "token.h"
+
+char token_pipe[] = "|";
+char token_background[] = "&";
+
+/**
+ *  characters ending a plain run of a word.
+ */
+static const unsigned char token_special[256] = {
+    [TAB] = 1, [LF] = 1, [SP] = 1, ['"'] = 1, ['\''] = 1, ['\\'] = 1, ['|'] = 1, ['&'] = 1,
+};
+
+/**
+ *  byte @c c in every byte of a word.
+ */
+#define TOKEN_BYTES(c) ((uint64_t)0x0101010101010101ULL * (c))
+
+/**
+ *  get length of the plain run at @c p, stopping at a special character.
+ *
+ *  eight bytes are tested at once: a block is skipped when none of its
+ *  bytes is below '(' (covering TAB, LF, SP, '&' and the quotes), '\' or '|'.
+ *  a block that might hold one is scanned bytewise.
+ */
+static size_t token_plain(const char *p, const char *end)
+{
+    const char *start = p;
+    const uint64_t high = TOKEN_BYTES(0x80);
+
+    while (end - p >= (ptrdiff_t)sizeof(uint64_t)) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+
+        uint64_t bs = v ^ TOKEN_BYTES('\\');
+        uint64_t bar = v ^ TOKEN_BYTES('|');
+        uint64_t hit = ((v - TOKEN_BYTES('(')) & ~v)
+                       | ((bs - TOKEN_BYTES(1)) & ~bs)
+                       | ((bar - TOKEN_BYTES(1)) & ~bar);
+        if ((hit & high) != 0) {
+            break;
+        }
+        p += sizeof(v);
+    }
+    while ((p < end) && !token_special[(unsigned char)*p]) {
+        ++p;
+    }
+    return p - start;
+}
+
+/**
+ *  test whether the '&' at @c p ends the line.
+ */
+static bool token_last(const char *p, const char *end)
+{
+    for (++p; p < end; ++p) {
+        if ((*p != SP) && (*p != TAB) && (*p != LF)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int token_split(char *buf, size_t len, char **argv, size_t length, bool *open)
+{
+    char *r = buf;
+    char *end = buf + len;
+    size_t count = 0;
+    bool in_word = false;
+
+    while (r < end) {
+        if ((*r == SP) || (*r == TAB) || (*r == LF)) {
+            ++r;
+            continue;
+        }
+        if (count >= length) {
+            errno = E2BIG;
+            return -1;
+        }
+        if ((*r == '|') || ((*r == '&') && token_last(r, end))) {
+            argv[count++] = (*r == '|') ? token_pipe : token_background;
+            ++r;
+            continue;
+        }
+
+        /* a word, copied down over removed quotes and escapes. */
+        char *w = r;
+        argv[count++] = w;
+        in_word = true;
+        while (r < end) {
+            size_t n = token_plain(r, end);
+            if (w != r) {
+                memmove(w, r, n);
+            }
+            w += n;
+            r += n;
+            if ((r == end) || (*r == SP) || (*r == TAB) || (*r == LF) || (*r == '|')) {
+                break;
+            } else if (*r == '&') {
+                if (token_last(r, end)) {
+                    break;
+                }
+                *w++ = *r++;
+                continue;
+            }
+
+            char quote = *r++;
+            if (quote == '\\') {
+                if (r == end) {
+                    if (open == NULL) {
+                        errno = EINVAL;
+                        return -1;
+                    }
+                    break;
+                }
+                *w++ = *r++;
+            } else if (quote == '\'') {
+                char *close = memchr(r, '\'', end - r);
+                n = (close != NULL) ? (size_t)(close - r) : (size_t)(end - r);
+                memmove(w, r, n);
+                w += n;
+                r += n;
+                if (close == NULL) {
+                    if (open == NULL) {
+                        errno = EINVAL;
+                        return -1;
+                    }
+                    break;
+                }
+                ++r;
+            } else {
+                while ((r < end) && (*r != '"')) {
+                    if ((*r == '\\') && (r + 1 < end) && (r[1] != NUL) && (strchr("\"\\$`", r[1]) != NULL)) {
+                        ++r;
+                    }
+                    *w++ = *r++;
+                }
+                if (r == end) {
+                    if (open == NULL) {
+                        errno = EINVAL;
+                        return -1;
+                    }
+                    break;
+                }
+                ++r;
+            }
+        }
+        in_word = (r == end);
+
+        /* the delimiter is consumed here, the terminator may land on it. */
+        if (r < end) {
+            if ((*r == '|') || (*r == '&')) {
+                if (count >= length) {
+                    errno = E2BIG;
+                    return -1;
+                }
+                argv[count++] = (*r == '|') ? token_pipe : token_background;
+            }
+            ++r;
+        }
+        *w = NUL;
+    }
+
+    if (open != NULL) {
+        *open = in_word;
+    }
+    return count;
+}
+
+const char *token_error(int err)
+{
+    return (err == E2BIG) ? "too many arguments" : "unterminated quote";
+}
@@ -0,0 +1,56 @@
+/** @file       token.h
+ *  @brief      Command line tokenizer.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_TOKEN_H__
+#define __ECON_TOKEN_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ *  word standing for an unquoted '|'.
+ *
+ *  compared by address, so that a quoted "|" stays a plain word.
+ */
+extern char token_pipe[];
+
+/**
+ *  word standing for an unquoted '&' ending the line.
+ *
+ *  compared by address, so that a quoted "&" stays a plain word.
+ */
+extern char token_background[];
+
+/**
+ *  split @c buf into words in place.
+ *
+ *  words are separated by SP, TAB and LF. single quotes keep text as
+ *  is, double quotes keep text but '\' escapes '"', '\', '$' and '`'.
+ *  outside quotes '\' escapes any character. an unquoted '|' is a word
+ *  of its own, @ref token_pipe, and so is an unquoted '&' ending the
+ *  line, @ref token_background.
+ *
+ *  @c buf[len] must be writable, words are terminated in place.
+ *
+ *  if @c open is NULL, an unterminated quote is an error. otherwise it
+ *  is closed at the end, and @c open tells if input ended inside a word.
+ *
+ *  @return     returns word count on success.
+ *              on error, -1 is returned, and @c errno set.
+ *              @c E2BIG for more words than @c length,
+ *              @c EINVAL for an unterminated quote or escape.
+ */
+int token_split(char *buf, size_t len, char **argv, size_t length, bool *open);
+
+/**
+ *  describe @c errno set by token_split().
+ */
+const char *token_error(int err);
+
+#endif /* __ECON_TOKEN_H__ */
@@ -0,0 +1,488 @@
+/** @file       watch.c
+ *  @brief      Periodic command screen.
+ *
+ *  a watched command is run on a timer of the session, so that keys
+ *  and other timers are handled between runs as at the prompt. the
+ *  timer is periodic, runs stay on the schedule it was started with
+ *  however long each one takes.
+ *
+ *  the screen keeps what was last shown on each row, and a run only
+ *  writes the columns that changed, moving the cursor over those that
+ *  did not. rows holding other than printable ASCII are rewritten as
+ *  a whole, their columns are not known.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-17 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+
+#include "econ.h"
+#include "ascii.h"
+#include "jobs.h"
+#include "session.h"
+#include "watch.h"
+
+/**
+ *  bytes of a cursor move, unchanged columns shorter than this are
+ *  written over.
+ */
+#define WATCH_MOVE_COST (7)
+
+/**
+ *  row of the screen.
+ */
+struct watch_line {
+    char *text;     /**< shown text. */
+    size_t len;     /**< length of @c text. */
+    size_t cap;     /**< allocated length of @c text. */
+    bool plain;     /**< only printable ASCII, a byte is a column. */
+};
+
+struct watch {
+    struct econ_session *s;         /**< watching session. */
+    struct econ_command *cmds;      /**< command list. */
+    char *words;                    /**< words of the command, each terminated. */
+    size_t words_len;               /**< length of @c words. */
+    char *scratch;                  /**< copy of @c words given to a run. */
+    int argc;                       /**< number of words. */
+    char **argv;                    /**< words in @c scratch. */
+    char *title;                    /**< command as typed. */
+    uint64_t interval;              /**< interval. (ms) */
+    struct econ_timer *timer;       /**< timer, NULL while paused. */
+    int ret;                        /**< result of the last run. */
+
+    struct econ_session *capture;   /**< session the command runs on. */
+    char *output;                   /**< output of the last run. */
+    size_t output_len;              /**< length of @c output. */
+    size_t output_cap;              /**< allocated length of @c output. */
+
+    struct watch_line *shown;       /**< rows of the screen, @c rows of them. */
+    size_t used;                    /**< rows written by the last paint. */
+    size_t rows;                    /**< screen height painted for. */
+    size_t cols;                    /**< screen width painted for. */
+    size_t cur_row;                 /**< cursor row, 1 based. */
+    size_t cur_col;                 /**< cursor column, 1 based, 0 if not known. */
+};
+
+/**
+ *  output sink of the command, keeps output for the screen.
+ */
+static ssize_t watch_output(void *ctx, const void *buf, size_t len)
+{
+    struct watch *w = ctx;
+    size_t keep = len;
+
+    if (w->output_len + len > WATCH_OUTPUT_MAX) {
+        keep = WATCH_OUTPUT_MAX - w->output_len;
+    }
+    if (w->output_len + keep > w->output_cap) {
+        size_t cap = (w->output_cap > 0) ? w->output_cap : 1024;
+        while (cap < w->output_len + keep) {
+            cap *= 2;
+        }
+        char *output = realloc(w->output, cap);
+        if (output == NULL) {
+            return -1;
+        }
+        w->output = output;
+        w->output_cap = cap;
+    }
+    memcpy(&w->output[w->output_len], buf, keep);
+    w->output_len += keep;
+
+    /* rows beyond the screen are not shown anyway. */
+    return len;
+}
+
+/**
+ *  run the command, capturing its output.
+ */
+static void watch_run(struct watch *w)
+{
+    memcpy(w->scratch, w->words, w->words_len);
+    char *p = w->scratch;
+    for (int i = 0; i < w->argc; ++i) {
+        w->argv[i] = p;
+        p += strlen(p) + 1;
+    }
+    w->argv[w->argc] = NULL;
+
+    w->output_len = 0;
+    w->ret = session_invoke(w->capture, w->argc, w->argv, w->cmds);
+    session_flush(w->capture);
+}
+
+static void watch_move(struct watch *w, size_t row, size_t col)
+{
+    if ((row == w->cur_row) && (col == w->cur_col)) {
+        return;
+    }
+    if (col == 1) {
+        session_printf(w->s, "\033[%zuH", row);
+    } else {
+        session_printf(w->s, "\033[%zu;%zuH", row, col);
+    }
+    w->cur_row = row;
+    w->cur_col = col;
+}
+
+static bool watch_plain(const char *text, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        if ((text[i] < SP) || (text[i] >= DEL)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ *  write the columns of @c text differing from @c line on row @c row.
+ *
+ *  columns which did not change are written over when that is shorter
+ *  than moving past them.
+ */
+static void watch_diff(struct watch *w, size_t row, const struct watch_line *line,
+                       const char *text, size_t len)
+{
+    size_t same = (len < line->len) ? len : line->len;
+    size_t i = 0;
+
+    while (i < len) {
+        while ((i < same) && (text[i] == line->text[i])) {
+            ++i;
+        }
+        if (i == len) {
+            break;
+        }
+        size_t j = i;
+        while (j < len) {
+            size_t k = 0;
+            while ((j + k < same) && (text[j + k] == line->text[j + k])) {
+                ++k;
+            }
+            if ((k > WATCH_MOVE_COST) || ((k > 0) && (j + k == len))) {
+                break;
+            }
+            j += (k > 0) ? k : 1;
+        }
+        watch_move(w, row, i + 1);
+        session_write(w->s, &text[i], j - i);
+        w->cur_col = j + 1;
+        i = j;
+    }
+    if (len < line->len) {
+        watch_move(w, row, len + 1);
+        session_write(w->s, "\033[K", 3);
+    }
+}
+
+/**
+ *  show @c text on row @c i, writing only what differs from the row.
+ */
+static void watch_row(struct watch *w, size_t i, const char *text, size_t len)
+{
+    bool plain = watch_plain(text, len);
+    if (plain && (len > w->cols)) {
+        len = w->cols;
+    }
+
+    struct watch_line *line = &w->shown[i];
+    if ((line->len == len) && ((len == 0) || (memcmp(line->text, text, len) == 0))) {
+        return;
+    }
+
+    if (plain && line->plain) {
+        watch_diff(w, i + 1, line, text, len);
+    } else {
+        watch_move(w, i + 1, 1);
+        session_write(w->s, text, len);
+        session_write(w->s, "\033[K", 3);
+        w->cur_col = 0;
+    }
+
+    if (len > line->cap) {
+        char *copy = realloc(line->text, len);
+        if (copy == NULL) {
+            /* not known any more, rewritten next time. */
+            line->len = 0;
+            line->plain = false;
+            return;
+        }
+        line->text = copy;
+        line->cap = len;
+    }
+    memcpy(line->text, text, len);
+    line->len = len;
+    line->plain = plain;
+}
+
+/**
+ *  bring the screen up to the last run.
+ *
+ *  @c full clears the screen first, as after a resize.
+ */
+static void watch_paint(struct watch *w, bool full)
+{
+    size_t rows = session_rows(w->s);
+    size_t cols = session_columns(w->s);
+
+    if (full || (rows != w->rows) || (cols != w->cols)) {
+        struct watch_line *shown = calloc(rows, sizeof(*shown));
+        if (shown == NULL) {
+            return;
+        }
+        for (size_t i = 0; i < w->rows; ++i) {
+            free(w->shown[i].text);
+        }
+        free(w->shown);
+        for (size_t i = 0; i < rows; ++i) {
+            shown[i].plain = true;
+        }
+        w->shown = shown;
+        w->used = 0;
+        w->rows = rows;
+        w->cols = cols;
+        session_write(w->s, "\033[H\033[2J", 7);
+        w->cur_row = w->cur_col = 1;
+    }
+
+    char header[256];
+    int len = snprintf(header, sizeof(header), "Every %" PRIu64 "ms: %s%s", w->interval, w->title,
+                       (w->timer == NULL) ? "  [paused]" : "");
+    if ((len >= 0) && (w->ret != 0) && ((size_t)len < sizeof(header))) {
+        len += snprintf(&header[len], sizeof(header) - len, "  [exit %d]", w->ret);
+    }
+    len = ((size_t)len < sizeof(header)) ? len : (int)sizeof(header) - 1;
+    watch_row(w, 0, header, len);
+
+    size_t n = 2;
+    const char *p = w->output, *end = &w->output[w->output_len];
+    while ((p < end) && (n < rows)) {
+        const char *lf = memchr(p, LF, end - p);
+        const char *eol = (lf != NULL) ? lf : end;
+        size_t line_len = eol - p;
+        if ((line_len > 0) && (p[line_len - 1] == CR)) {
+            --line_len;
+        }
+        watch_row(w, n++, p, line_len);
+        p = (lf != NULL) ? lf + 1 : end;
+    }
+
+    if (w->used > n) {
+        /* rows of a longer run before. */
+        watch_move(w, n + 1, 1);
+        session_write(w->s, "\033[J", 3);
+        for (size_t i = n; i < w->used; ++i) {
+            w->shown[i].len = 0;
+            w->shown[i].plain = true;
+        }
+    }
+    w->used = n;
+}
+
+static void watch_tick(struct econ_timer *t, void *ctx)
+{
+    struct watch *w = ctx;
+
+    watch_run(w);
+    watch_paint(w, false);
+}
+
+static void watch_free(struct watch *w)
+{
+    econ_timer_remove(w->timer);
+    econ_session_destroy(w->capture);
+    for (size_t i = 0; i < w->rows; ++i) {
+        free(w->shown[i].text);
+    }
+    free(w->shown);
+    free(w->output);
+    free(w->words);
+    free(w->scratch);
+    free(w->argv);
+    free(w->title);
+    free(w);
+}
+
+/**
+ *  leave the screen as it is, and give the session back to the prompt.
+ */
+static void watch_end(struct econ_session *s)
+{
+    struct watch *w = s->watch;
+
+    watch_move(w, (w->used > 0) ? w->used : 1, 1);
+    session_write(s, "\r\n\033[?25h", 8);
+
+    s->watch = NULL;
+    watch_free(w);
+
+    if (s->prompt != NULL) {
+        session_begin(s, s->prompt);
+    }
+    /* output of jobs held while watching. */
+    session_jobs_drain(s);
+}
+
+void watch_key(struct econ_session *s, int key)
+{
+    struct watch *w = s->watch;
+
+    switch (key) {
+    case 'q':
+    case 'Q':
+    case ETX:
+        watch_end(s);
+        break;
+    case SP:
+        if (w->timer != NULL) {
+            econ_timer_remove(w->timer);
+            w->timer = NULL;
+        } else {
+            w->timer = econ_timer_add(s, w->interval, w->interval, watch_tick, w);
+            watch_run(w);
+        }
+        watch_paint(w, false);
+        break;
+    case CR:
+    case LF:
+        watch_run(w);
+        watch_paint(w, false);
+        break;
+    case FF:
+        watch_paint(w, true);
+        break;
+    default:
+        break;
+    }
+}
+
+void watch_release(struct econ_session *s)
+{
+    if (s->watch != NULL) {
+        watch_free(s->watch);
+        s->watch = NULL;
+    }
+}
+
+/**
+ *  create a watch of @c argc words of @c argv.
+ */
+static struct watch *watch_create(struct econ_session *s, uint64_t interval, int argc, char **argv)
+{
+    struct watch *w = calloc(1, sizeof(*w));
+    if (w == NULL) {
+        return NULL;
+    }
+    w->s = s;
+    w->cmds = session_commands();
+    w->interval = interval;
+    w->argc = argc;
+    for (int i = 0; i < argc; ++i) {
+        w->words_len += strlen(argv[i]) + 1;
+    }
+    w->words = malloc(w->words_len);
+    w->scratch = malloc(w->words_len);
+    w->title = malloc(w->words_len);
+    w->argv = calloc(argc + 1, sizeof(*w->argv));
+    w->capture = session_alloc(-1, -1);
+    if ((w->words == NULL) || (w->scratch == NULL) || (w->title == NULL)
+        || (w->argv == NULL) || (w->capture == NULL)) {
+        watch_free(w);
+        return NULL;
+    }
+    char *p = w->words;
+    for (int i = 0; i < argc; ++i) {
+        size_t n = strlen(argv[i]) + 1;
+        memcpy(p, argv[i], n);
+        memcpy(&w->title[p - w->words], argv[i], n);
+        p += n;
+        if (i + 1 < argc) {
+            w->title[p - w->words - 1] = SP;
+        }
+    }
+    econ_session_set_output(w->capture, watch_output, w);
+    /* output is taken as a whole when the command returns. */
+    w->capture->deferred = true;
+
+    return w;
+}
+
+/**
+ *  watch command usage.
+ *
+ *  @param      [in]    name    command name.
+ */
+void econ_watch_usage(const char *name)
+{
+    econ_printf("usage: %s [-n ms] command [args ...]\r\n", name);
+}
+
+/**
+ *  watch command.
+ *
+ *  @details    the command is run every @c ms milliseconds, 1000 by
+ *              default, and its output fills the screen. 'q' or ^C
+ *              quits, SP pauses and resumes, CR runs it at once and
+ *              ^L repaints the screen.
+ *              the prompt comes back when the watch is quit, the
+ *              watch command itself returns at once.
+ *  @param      [in]    argc    argument count.
+ *  @param      [in]    argv    argument values.
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned.
+ */
+int econ_watch_command(int argc, char **argv)
+{
+    struct econ_session *s = econ_session_current();
+    uint64_t interval = WATCH_DEFAULT_INTERVAL;
+    int first = 1;
+
+    if ((argc > 2) && (strcmp(argv[1], "-n") == 0)) {
+        char *end;
+        errno = 0;
+        interval = strtoull(argv[2], &end, 10);
+        if ((errno != 0) || (*end != NUL) || (interval < WATCH_MIN_INTERVAL)) {
+            return -1;
+        }
+        first = 3;
+    }
+    if (first >= argc) {
+        return -1;
+    }
+    /* needs timers and keys: a terminal, not a pipeline or a script. */
+    if ((s == NULL) || (econ_session_fd(s) < 0) || (s->capture != NULL)
+        || (s->watch != NULL) || (session_commands() == NULL)) {
+        econ_printf("%s: not on this session\r\n", argv[0]);
+        return -1;
+    }
+
+    struct watch *w = watch_create(s, interval, argc - first, &argv[first]);
+    if (w == NULL) {
+        econ_printf("%s: %s\r\n", argv[0], strerror(errno));
+        return -1;
+    }
+    w->timer = econ_timer_add(s, interval, interval, watch_tick, w);
+    if (w->timer == NULL) {
+        econ_printf("%s: %s\r\n", argv[0], strerror(errno));
+        watch_free(w);
+        return -1;
+    }
+    s->watch = w;
+
+    session_write(s, "\033[?25l", 6);
+    watch_run(w);
+    watch_paint(w, true);
+
+    return 0;
+}
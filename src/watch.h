@@ -0,0 +1,40 @@
+/** @file       watch.h
+ *  @brief      Periodic command screen.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-17 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __ECON_WATCH_H__
+#define __ECON_WATCH_H__
+
+#include "econ.h"
+
+/**
+ *  default interval. (ms)
+ */
+#define WATCH_DEFAULT_INTERVAL (1000)
+
+/**
+ *  shortest interval. (ms)
+ */
+#define WATCH_MIN_INTERVAL (10)
+
+/**
+ *  most output bytes of one run.
+ */
+#define WATCH_OUTPUT_MAX (256 * 1024)
+
+/**
+ *  handle a key typed while the session is watching.
+ */
+void watch_key(struct econ_session *s, int key);
+
+/**
+ *  end the watch of a session being destroyed.
+ */
+void watch_release(struct econ_session *s);
+
+#endif /* __ECON_WATCH_H__ */
@@ -0,0 +1,1406 @@
+/** @file       bench.cpp
+ *  @brief      Embedded console benchmarks.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cinttypes>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <time.h>
+#include <termios.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "econ.hpp"
+#include "record.h"
+#include "relay.h"
+
+/**
+ *  allocations made by the library.
+ */
+static std::atomic<uint64_t> alloc_count(0);
+
+/**
+ *  I/O system calls made by the library.
+ */
+static std::atomic<uint64_t> syscall_count(0);
+
+/*
+ *  the library is linked with --wrap for these functions (see Makefile),
+ *  so that its calls are counted. I/O of the benchmarks themselves goes
+ *  to __real_*() directly.
+ */
+extern "C" {
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+int __real_posix_memalign(void **ptr, size_t align, size_t size);
+ssize_t __real_read(int fd, void *buf, size_t len);
+ssize_t __real_readv(int fd, const struct iovec *iov, int iovcnt);
+ssize_t __real_write(int fd, const void *buf, size_t len);
+ssize_t __real_send(int fd, const void *buf, size_t len, int flags);
+ssize_t __real_splice(int in, loff_t *in_off, int out, loff_t *out_off, size_t len, unsigned int flags);
+int __real_epoll_wait(int epfd, struct epoll_event *evs, int max, int timeout);
+int __real_epoll_ctl(int epfd, int op, int fd, struct epoll_event *ev);
+int __real_poll(struct pollfd *fds, nfds_t nfds, int timeout);
+int __real_ioctl(int fd, unsigned long req, void *arg);
+int __real_accept4(int fd, struct sockaddr *addr, socklen_t *len, int flags);
+
+void *__wrap_malloc(size_t size)
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __real_realloc(ptr, size);
+}
+
+int __wrap_posix_memalign(void **ptr, size_t align, size_t size)
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __real_posix_memalign(ptr, align, size);
+}
+
+ssize_t __wrap_read(int fd, void *buf, size_t len)
+{
+    syscall_count.fetch_add(1, std::memory_order_relaxed);
+    return __real_read(fd, buf, len);
+}
+
+ssize_t __wrap_readv(int fd, const struct iovec *iov, int iovcnt)
+{
+    syscall_count.fetch_add(1, std::memory_order_relaxed);
+    return __real_readv(fd, iov, iovcnt);
+}
+
+ssize_t __wrap_write(int fd, const void *buf, size_t len)
+{
+    syscall_count.fetch_add(1, std::memory_order_relaxed);
+    return __real_write(fd, buf, len);
+}
+
+ssize_t __wrap_send(int fd, const void *buf, size_t len, int flags)
+{
+    syscall_count.fetch_add(1, std::memory_order_relaxed);
+    return __real_send(fd, buf, len, flags);
+}
+
+ssize_t __wrap_splice(int in, loff_t *in_off, int out, loff_t *out_off, size_t len, unsigned int flags)
+{
+    syscall_count.fetch_add(1, std::memory_order_relaxed);
+    return __real_splice(in, in_off, out, out_off, len, flags);
+}
+
+int __wrap_epoll_wait(int epfd, struct epoll_event *evs, int max, int timeout)
+{
+    syscall_count.fetch_add(1, std::memory_order_relaxed);
+    return __real_epoll_wait(epfd, evs, max, timeout);
+}
+
+int __wrap_epoll_ctl(int epfd, int op, int fd, struct epoll_event *ev)
+{
+    syscall_count.fetch_add(1, std::memory_order_relaxed);
+    return __real_epoll_ctl(epfd, op, fd, ev);
+}
+
+int __wrap_poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+    syscall_count.fetch_add(1, std::memory_order_relaxed);
+    return __real_poll(fds, nfds, timeout);
+}
+
+int __wrap_ioctl(int fd, unsigned long req, void *arg)
+{
+    syscall_count.fetch_add(1, std::memory_order_relaxed);
+    return __real_ioctl(fd, req, arg);
+}
+
+int __wrap_accept4(int fd, struct sockaddr *addr, socklen_t *len, int flags)
+{
+    syscall_count.fetch_add(1, std::memory_order_relaxed);
+    return __real_accept4(fd, addr, len, flags);
+}
+
+#include "complete.h"
+#include "keys.h"
+#include "session.h"
+#include "token.h"
+#include "suggest.h"
+#include "utils.h"
+
+static int nop(int argc, char **argv)
+{
+    return 0;
+}
+
+static int gen(int argc, char **argv)
+{
+    long count = (argc > 1) ? atol(argv[1]) : 1;
+
+    for (long i = 0; i < count; ++i) {
+        econ_printf("%08lx %s 0x%08lx\r\n", 0x40000000 + i * 4, (i % 4) ? "DATA" : "IRQ_STAT", i);
+    }
+    return 0;
+}
+
+static char register_names[5000][16];
+
+static void many_complete(struct econ_completion *comp, int argc, char **argv)
+{
+    for (size_t i = 0; i < lengthof(register_names); ++i) {
+        econ_completion_add(comp, register_names[i]);
+    }
+}
+
+}
+
+/**
+ *  get monotonic time in nanoseconds.
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ *  output as JSON lines.
+ */
+static bool json = false;
+
+/**
+ *  name of the last result.
+ */
+static std::string last_name;
+
+/**
+ *  counters at start of the measurement.
+ */
+static uint64_t begin_allocs = 0;
+static uint64_t begin_syscalls = 0;
+
+/**
+ *  start counting allocations and system calls of a measurement.
+ *
+ *  @return returns current time, see now_ns().
+ */
+static uint64_t bench_begin(void)
+{
+    begin_allocs = alloc_count.load();
+    begin_syscalls = syscall_count.load();
+    return now_ns();
+}
+
+/**
+ *  print a result line.
+ *
+ *  allocations and system calls are counted from the last bench_begin()
+ *  or report().
+ *
+ *  @param  [in]    name    benchmark name.
+ *  @param  [in]    ops     operation count.
+ *  @param  [in]    ns      elapsed time in nanoseconds.
+ */
+static void report(const std::string &name, uint64_t ops, uint64_t ns)
+{
+    uint64_t allocs = alloc_count.load() - begin_allocs;
+    uint64_t syscalls = syscall_count.load() - begin_syscalls;
+
+    if (json) {
+        printf("{\"version\":\"%s\",\"name\":\"%s\",\"ops\":%" PRIu64 ",\"ns_per_op\":%.2f,"
+               "\"allocs_per_op\":%.4f,\"syscalls_per_op\":%.4f}\n",
+               ECON_VERSION, name.c_str(), ops, (double)ns / ops,
+               (double)allocs / ops, (double)syscalls / ops);
+    } else {
+        printf("%-40s %10" PRIu64 " ops %10.1f ns/op %8.3f allocs/op %8.3f sys/op\n",
+               name.c_str(), ops, (double)ns / ops, (double)allocs / ops, (double)syscalls / ops);
+    }
+    fflush(stdout);
+    last_name = name;
+    begin_allocs += allocs;
+    begin_syscalls += syscalls;
+}
+
+/**
+ *  print a secondary figure of the last result.
+ *
+ *  @param  [in]    value   figure.
+ *  @param  [in]    unit    unit of the figure.
+ */
+static void metric(double value, const char *unit)
+{
+    if (json) {
+        printf("{\"version\":\"%s\",\"name\":\"%s\",\"metric\":\"%s\",\"value\":%.3f}\n",
+               ECON_VERSION, last_name.c_str(), unit, value);
+    } else {
+        printf("%-40s %10.2f %s\n", "", value, unit);
+    }
+}
+
+/**
+ *  synthetic command table.
+ */
+struct command_table {
+    std::vector<std::string> names;
+    std::vector<struct econ_command> cmds;
+
+    explicit command_table(size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            char name[32];
+            snprintf(name, sizeof(name), "cmd%zx_%zu", i * 2654435761u % 0xFFFFF, i);
+            names.push_back(name);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            cmds.push_back(ECON_COMMAND(names[i].c_str(), nop, "bench", NULL));
+        }
+        cmds.push_back(ECON_END_OF_COMMAND());
+    }
+};
+
+/**
+ *  compile-time table of a typical console.
+ */
+static constexpr auto static_table = econ::make_table({
+    econ::command("boot", nop, "bench"),
+    econ::command("reset", nop, "bench"),
+    econ::command("reboot", nop, "bench"),
+    econ::command("version", nop, "bench"),
+    econ::command("uptime", nop, "bench"),
+    econ::command("date", nop, "bench"),
+    econ::command("free", nop, "bench"),
+    econ::command("ps", nop, "bench"),
+    econ::command("kill", nop, "bench"),
+    econ::command("env", nop, "bench"),
+    econ::command("set", nop, "bench"),
+    econ::command("unset", nop, "bench"),
+    econ::command("mem", nop, "bench"),
+    econ::command("peek", nop, "bench"),
+    econ::command("poke", nop, "bench"),
+    econ::command("dump", nop, "bench"),
+    econ::command("i2c", nop, "bench"),
+    econ::command("spi", nop, "bench"),
+    econ::command("gpio", nop, "bench"),
+    econ::command("uart", nop, "bench"),
+    econ::command("eth", nop, "bench"),
+    econ::command("ping", nop, "bench"),
+    econ::command("ifconfig", nop, "bench"),
+    econ::command("route", nop, "bench"),
+    econ::command("arp", nop, "bench"),
+    econ::command("flash", nop, "bench"),
+    econ::command("erase", nop, "bench"),
+    econ::command("verify", nop, "bench"),
+    econ::command("load", nop, "bench"),
+    econ::command("save", nop, "bench"),
+    econ::command("log", nop, "bench"),
+    econ::command("stats", nop, "bench"),
+});
+
+/**
+ *  linear table scan vs. registry trie lookup vs. compile-time table.
+ */
+static void bench_dispatch(void)
+{
+    static const size_t sizes[] = {10, 100, 1000};
+
+    for (size_t s = 0; s < lengthof(sizes); ++s) {
+        command_table table(sizes[s]);
+        const uint64_t loops = 200000;
+        std::vector<char *> argvs;
+        for (size_t i = 0; i < table.names.size(); ++i) {
+            argvs.push_back(&table.names[i][0]);
+        }
+
+        uint64_t start = bench_begin();
+        for (uint64_t i = 0; i < loops; ++i) {
+            econ_invoke(1, &argvs[i % argvs.size()], table.cmds.data());
+        }
+        report("invoke/linear/" + std::to_string(sizes[s]), loops, now_ns() - start);
+
+        start = bench_begin();
+        struct econ_registry *reg = econ_registry_create(table.cmds.data());
+        report("registry/create/" + std::to_string(sizes[s]), 1, now_ns() - start);
+
+        start = bench_begin();
+        for (uint64_t i = 0; i < loops; ++i) {
+            econ_registry_invoke(reg, 1, &argvs[i % argvs.size()]);
+        }
+        report("invoke/registry/" + std::to_string(sizes[s]), loops, now_ns() - start);
+
+        econ_registry_destroy(reg);
+    }
+
+    /* one list scanned, and looked up through its perfect hash. */
+    {
+        const uint64_t loops = 200000;
+        const size_t count = static_table.size();
+        std::vector<struct econ_command> scanned(static_table.commands(), static_table.commands() + count + 1);
+        scanned[0].lookup = NULL;
+        std::vector<std::string> names;
+        std::vector<char *> argvs;
+        for (size_t i = 0; i < count; ++i) {
+            names.push_back(scanned[i].command);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            argvs.push_back(&names[i][0]);
+        }
+        std::string name = std::to_string(count);
+
+        uint64_t start = bench_begin();
+        for (uint64_t i = 0; i < loops; ++i) {
+            econ_invoke(1, &argvs[i % count], scanned.data());
+        }
+        report("invoke/linear-static/" + name, loops, now_ns() - start);
+
+        start = bench_begin();
+        for (uint64_t i = 0; i < loops; ++i) {
+            econ_invoke(1, &argvs[i % count], static_table.commands());
+        }
+        report("invoke/constexpr/" + name, loops, now_ns() - start);
+    }
+
+    /* sub-command nesting, each level among 16 siblings. */
+    static const size_t depths[] = {1, 2, 4, 8};
+    for (size_t d = 0; d < lengthof(depths); ++d) {
+        std::vector<command_table> levels;
+        for (size_t l = 0; l < depths[d]; ++l) {
+            levels.emplace_back(16);
+        }
+        std::vector<char *> argvs;
+        for (size_t l = 0; l < depths[d]; ++l) {
+            /* the last sibling of a level leads to the next one. */
+            struct econ_command &last = levels[l].cmds[15];
+            if (l + 1 < depths[d]) {
+                last.func = NULL;
+                last.sub_cmds = levels[l + 1].cmds.data();
+            }
+            argvs.push_back(&levels[l].names[15][0]);
+        }
+
+        const uint64_t loops = 200000;
+        uint64_t start = bench_begin();
+        for (uint64_t i = 0; i < loops; ++i) {
+            econ_invoke(argvs.size(), argvs.data(), levels[0].cmds.data());
+        }
+        report("invoke/nested/" + std::to_string(depths[d]), loops, now_ns() - start);
+
+        start = bench_begin();
+        struct econ_registry *reg = econ_registry_create(levels[0].cmds.data());
+        for (uint64_t i = 0; i < loops; ++i) {
+            econ_registry_invoke(reg, argvs.size(), argvs.data());
+        }
+        report("invoke/registry-nested/" + std::to_string(depths[d]), loops, now_ns() - start);
+        econ_registry_destroy(reg);
+    }
+}
+
+/**
+ *  "did you mean" on a miss: indexed and scanned names.
+ */
+static void bench_suggest(void)
+{
+    static const size_t sizes[] = {100, 1000, 5000};
+
+    for (size_t s = 0; s < lengthof(sizes); ++s) {
+        command_table table(sizes[s]);
+        std::vector<const char *> names;
+        std::vector<std::string> typos;
+        for (size_t i = 0; i < table.names.size(); ++i) {
+            names.push_back(table.names[i].c_str());
+            /* one character mistyped. */
+            std::string typo = table.names[i];
+            typo[(i * 7) % typo.size()] = 'q';
+            typos.push_back(typo);
+        }
+        const uint64_t loops = 20000;
+        struct suggestion near[SUGGEST_MAX];
+        uint64_t found = 0;
+
+        uint64_t start = bench_begin();
+        struct suggest_index *idx = suggest_index_create(names.data(), names.size());
+        report("suggest/index/" + std::to_string(sizes[s]), 1, now_ns() - start);
+
+        start = bench_begin();
+        for (uint64_t i = 0; i < loops; ++i) {
+            found += suggest_index_find(idx, typos[i % typos.size()].c_str(), near, SUGGEST_MAX);
+        }
+        report("suggest/indexed/" + std::to_string(sizes[s]), loops, now_ns() - start);
+        metric((double)found / loops, "suggestions");
+
+        found = 0;
+        start = bench_begin();
+        for (uint64_t i = 0; i < loops; ++i) {
+            found += suggest_commands(table.cmds.data(), typos[i % typos.size()].c_str(), near, SUGGEST_MAX);
+        }
+        report("suggest/scan/" + std::to_string(sizes[s]), loops, now_ns() - start);
+        metric((double)found / loops, "suggestions");
+
+        suggest_index_destroy(idx);
+    }
+}
+
+/**
+ *  count occurrences of @c pattern in @c buf, carrying partial matches in @c state.
+ */
+static size_t count_pattern(const char *buf, size_t len, const char *pattern, size_t *state)
+{
+    size_t plen = strlen(pattern);
+    size_t found = 0;
+
+    for (size_t i = 0; i < len; ++i) {
+        if (buf[i] == pattern[*state]) {
+            if (++*state == plen) {
+                ++found;
+                *state = 0;
+            }
+        } else {
+            *state = (buf[i] == pattern[0]) ? 1 : 0;
+        }
+    }
+    return found;
+}
+
+/**
+ *  server load test: concurrent sessions pipelining commands over AF_UNIX.
+ */
+static void bench_server(void)
+{
+    static const size_t sessions[] = {1, 64, 512, 2048};
+    static const char line[] = "nop\n";
+    const size_t window = 16;
+    const size_t total = 200000;
+    struct econ_command cmds[] = {
+        ECON_COMMAND("nop", nop, "no operation", NULL),
+        ECON_END_OF_COMMAND()
+    };
+    char path[64];
+    struct rlimit rl;
+
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+    snprintf(path, sizeof(path), "/tmp/econ_bench.%d.sock", (int)getpid());
+
+    struct econ_server_config config = {};
+    config.unix_path = path;
+    config.tcp_port = -1;
+    config.prompt = "b>";
+    config.cmds = cmds;
+    config.max_clients = 4096;
+    struct econ_server *srv = econ_server_create(&config);
+    if (srv == NULL) {
+        perror("econ_server_create");
+        return;
+    }
+    std::thread server([srv]() { econ_server_run(srv); });
+
+    for (size_t n = 0; n < lengthof(sessions); ++n) {
+        size_t count = sessions[n];
+        if (2 * count + 16 > rl.rlim_cur) {
+            fprintf(stderr, "server/%zu: skipped, RLIMIT_NOFILE %lu\n", count, (unsigned long)rl.rlim_cur);
+            continue;
+        }
+        struct client {
+            int fd;
+            size_t sent, done, state;
+        };
+        std::vector<client> clients(count);
+        int epfd = epoll_create1(0);
+        size_t per_client = total / count;
+
+        for (size_t i = 0; i < count; ++i) {
+            struct sockaddr_un addr = {};
+            addr.sun_family = AF_UNIX;
+            strcpy(addr.sun_path, path);
+            clients[i].fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (connect(clients[i].fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+                perror("connect");
+                exit(1);
+            }
+            clients[i].sent = clients[i].done = clients[i].state = 0;
+            struct epoll_event ev;
+            ev.events = EPOLLIN;
+            ev.data.u64 = i;
+            __real_epoll_ctl(epfd, EPOLL_CTL_ADD, clients[i].fd, &ev);
+        }
+
+        uint64_t start = bench_begin();
+        size_t finished = 0;
+        for (size_t i = 0; i < count; ++i) {
+            std::string burst;
+            for (; clients[i].sent < window; ++clients[i].sent) {
+                burst += line;
+            }
+            if (__real_write(clients[i].fd, burst.data(), burst.size()) < 0) {
+                perror("write");
+            }
+        }
+        while (finished < count) {
+            struct epoll_event evs[64];
+            int nevs = __real_epoll_wait(epfd, evs, lengthof(evs), -1);
+            for (int e = 0; e < nevs; ++e) {
+                client &c = clients[evs[e].data.u64];
+                char buf[65536];
+                ssize_t len = __real_read(c.fd, buf, sizeof(buf));
+                if (len <= 0) {
+                    continue;
+                }
+                size_t before = c.done;
+                c.done += count_pattern(buf, len, "b> ", &c.state);
+                /* the first prompt is shown on connect. */
+                size_t completed = (c.done > 0) ? c.done - 1 : 0;
+                if ((before <= per_client) && (completed >= per_client)) {
+                    ++finished;
+                }
+                std::string burst;
+                while ((c.sent < per_client) && (c.sent < completed + window)) {
+                    burst += line;
+                    ++c.sent;
+                }
+                if (!burst.empty() && (__real_write(c.fd, burst.data(), burst.size()) < 0)) {
+                    perror("write");
+                }
+            }
+        }
+        uint64_t elapsed = now_ns() - start;
+        uint64_t ops = per_client * count;
+        report("server/sessions/" + std::to_string(count), ops, elapsed);
+        metric(ops * 1e9 / elapsed, "cmds/s");
+
+        for (size_t i = 0; i < count; ++i) {
+            close(clients[i].fd);
+        }
+        close(epfd);
+    }
+
+    econ_server_stop(srv);
+    server.join();
+    econ_server_destroy(srv);
+}
+
+/**
+ *  synthetic editing: typing, cursor moves, mid-line insert and delete.
+ */
+static std::string editing_keys(void)
+{
+    std::string keys = "show interface eth0 counters detail";
+    for (int i = 0; i < 10; ++i) {
+        keys += "\033[D";
+    }
+    keys += "xyz";
+    keys += "\x7f\x7f";
+    keys += "\033[3~";
+    keys += "\n";
+    return keys;
+}
+
+/**
+ *  edits in the middle of a pasted 16KiB line.
+ */
+static std::string long_line_keys(void)
+{
+    std::string keys(16 * 1024, 'a');
+    for (int i = 0; i < 100; ++i) {
+        keys += "\033[D";
+    }
+    keys += std::string(100, 'b');
+    keys += std::string(100, '\x7f');
+    for (int i = 0; i < 100; ++i) {
+        keys += "\033[3~";
+    }
+    keys += "\n";
+    return keys;
+}
+
+/**
+ *  line editor output cost per keystroke, one wake-up per key vs. pasted.
+ */
+static void bench_editor(void)
+{
+    const std::string short_keys = editing_keys();
+    const std::string long_keys = long_line_keys();
+    const int lines = 2000;
+    int pfd[2];
+    int null_fd = open("/dev/null", O_WRONLY);
+
+    if ((null_fd < 0) || (pipe(pfd) != 0)) {
+        perror("open");
+        return;
+    }
+    struct econ_session *s = econ_session_create(pfd[0], null_fd);
+
+    for (int mode = 0; mode < 3; ++mode) {
+        bool paste = (mode > 0);
+        const std::string &keys = (mode == 2) ? long_keys : short_keys;
+        econ_session_reset_stats(s);
+        uint64_t start = bench_begin();
+        for (int l = 0; l < ((mode == 2) ? 20 : lines); ++l) {
+            session_begin(s, "bench>");
+            if (paste) {
+                if (__real_write(pfd[1], keys.data(), keys.size()) < 0) {
+                    perror("write");
+                }
+                session_poll(s);
+                session_flush(s);
+            } else {
+                for (size_t k = 0; k < keys.size(); ++k) {
+                    if (__real_write(pfd[1], &keys[k], 1) < 0) {
+                        perror("write");
+                    }
+                    session_poll(s);
+                    session_flush(s);
+                }
+            }
+        }
+        uint64_t elapsed = now_ns() - start;
+
+        struct econ_session_stats st;
+        econ_session_get_stats(s, &st);
+        static const char *const names[] = {"editor/typing", "editor/paste", "editor/long-line"};
+        std::string name = names[mode];
+        report(name, st.keys, elapsed);
+        metric((double)st.out_bytes / st.keys, "bytes/key");
+        metric((double)st.writes / st.keys, "writes/key");
+    }
+
+    econ_session_destroy(s);
+    close(pfd[0]);
+    close(pfd[1]);
+    close(null_fd);
+}
+
+/**
+ *  input decoder and pasted input throughput.
+ */
+static void bench_input(void)
+{
+    static const char *const seqs[] = {
+        "\033[A", "\033[1;5C", "\033OH", "\033[3~", "\033[4;2~", "\033OP",
+    };
+    std::string data;
+    unsigned seed = 1;
+
+    while (data.size() < 16 * 1024 * 1024) {
+        seed = seed * 1103515245 + 12345;
+        if ((seed >> 16) % 8 == 0) {
+            data += seqs[(seed >> 8) % lengthof(seqs)];
+        } else {
+            data += (char)('a' + (seed >> 16) % 26);
+        }
+    }
+
+    /* decoder alone, fed in chunks which split escape sequences. */
+    struct key_decoder dec;
+    key_decoder_init(&dec);
+    uint64_t keys = 0;
+    uint64_t start = bench_begin();
+    for (size_t pos = 0; pos < data.size();) {
+        size_t chunk = 1 + (pos * 7919) % 61;
+        for (size_t end = std::min(pos + chunk, data.size()); pos < end; ++pos) {
+            keys += (key_decode(&dec, (unsigned char)data[pos], 0) != KEY_NONE);
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("input/decode", data.size(), elapsed);
+    metric(data.size() * 1e3 / elapsed, "MB/s");
+    metric(keys, "keys");
+
+    /* pasted lines through the session input path. */
+    std::string paste;
+    while (paste.size() < 8 * 1024 * 1024) {
+        paste += "set register 0x4000a000 0xdeadbeef mask 0xffffffff verify\n";
+    }
+    int pfd[2];
+    int null_fd = open("/dev/null", O_WRONLY);
+    if ((null_fd < 0) || (pipe(pfd) != 0)) {
+        perror("pipe");
+        return;
+    }
+    struct econ_session *s = econ_session_create(pfd[0], null_fd);
+    uint64_t lines = 0;
+    size_t written = 0;
+    session_begin(s, "bench>");
+    start = bench_begin();
+    while (written < paste.size()) {
+        ssize_t len = __real_write(pfd[1], &paste[written], std::min<size_t>(65536, paste.size() - written));
+        if (len <= 0) {
+            break;
+        }
+        written += len;
+        while (session_poll(s) > 0) {
+            ++lines;
+            session_begin(s, "bench>");
+        }
+        session_flush(s);
+    }
+    elapsed = now_ns() - start;
+    report("input/paste", paste.size(), elapsed);
+    metric(paste.size() * 1e3 / elapsed, "MB/s");
+    metric(lines, "lines");
+
+    econ_session_destroy(s);
+    close(pfd[0]);
+    close(pfd[1]);
+    close(null_fd);
+}
+
+/**
+ *  ticks of the step timer bench.
+ */
+struct step_ticks {
+    uint64_t last;      /**< time of the previous callback. */
+    uint64_t count;     /**< callbacks run. */
+    uint64_t jitter;    /**< sum of distance from the interval. (ns) */
+};
+
+static void step_tick(struct econ_timer *t, void *ctx)
+{
+    struct step_ticks *ticks = (struct step_ticks *)ctx;
+
+    uint64_t now = now_ns();
+    uint64_t interval = now - ticks->last;
+
+    ++ticks->count;
+    ticks->jitter += (interval > 1000000) ? interval - 1000000 : 1000000 - interval;
+    ticks->last = now;
+}
+
+/**
+ *  lines and timers through the embeddable event loop.
+ */
+static void bench_step(void)
+{
+    const std::string line = "set register 0x4000a000 0xdeadbeef\n";
+    const uint64_t lines = 20000;
+    int pfd[2];
+    int null_fd = open("/dev/null", O_WRONLY);
+
+    if ((null_fd < 0) || (pipe(pfd) != 0)) {
+        perror("pipe");
+        return;
+    }
+    struct econ_session *s = econ_session_create(pfd[0], null_fd);
+    struct pollfd ready = {econ_session_fd(s), POLLIN, 0};
+    char *argv[16];
+
+    /* one line at a time, as a host loop sees a typed command. */
+    uint64_t start = bench_begin();
+    for (uint64_t i = 0; i < lines; ++i) {
+        if (__real_write(pfd[1], line.data(), line.size()) < 0) {
+            perror("write");
+        }
+        while (econ_session_step(s, "bench>", argv, lengthof(argv)) < 0) {
+            poll(&ready, 1, -1);
+        }
+    }
+    report("step/line", lines, now_ns() - start);
+
+    /* 1 ms ticks while idle. */
+    struct step_ticks ticks = {0, 0, 0};
+    ticks.last = now_ns();
+    struct econ_timer *t = econ_timer_add(s, 1, 1, step_tick, &ticks);
+    start = bench_begin();
+    while (ticks.count < 500) {
+        poll(&ready, 1, -1);
+        econ_session_step(s, "bench>", argv, lengthof(argv));
+    }
+    report("step/timer", ticks.count, now_ns() - start);
+    metric((double)ticks.jitter / ticks.count / 1000, "us jitter");
+    econ_timer_remove(t);
+
+    econ_session_destroy(s);
+    close(pfd[0]);
+    close(pfd[1]);
+    close(null_fd);
+}
+
+/**
+ *  history append and search over a full history.
+ */
+static void bench_history(void)
+{
+    static const size_t entries = 65536;
+    struct econ_history *h = econ_history_open(NULL, entries);
+    char line[128];
+
+    if (h == NULL) {
+        perror("econ_history_open");
+        return;
+    }
+
+    uint64_t start = bench_begin();
+    for (size_t i = 0; i < entries; ++i) {
+        snprintf(line, sizeof(line), "set register 0x%08zx 0x%08zx verify", i * 4, i * 2654435761u);
+        econ_history_add(h, line);
+    }
+    report("history/add", entries, now_ns() - start);
+
+    /* a substring whose bigrams are common, and one which is rare. */
+    static const char *const queries[] = {"register 0x0000", "zq"};
+    for (size_t i = 0; i < lengthof(queries); ++i) {
+        static const int rounds = 16;
+        int64_t found = 0;
+        start = bench_begin();
+        for (int j = 0; j < rounds; ++j) {
+            found = econ_history_search(h, queries[i], -1);
+        }
+        uint64_t elapsed = now_ns() - start;
+        report(std::string("history/search '") + queries[i] + "'", rounds, elapsed);
+        metric((double)elapsed / rounds / entries, "ns/entry");
+        metric(found, "found");
+    }
+
+    econ_history_close(h);
+}
+
+/**
+ *  completion of command names and arguments.
+ */
+static void bench_complete(void)
+{
+    for (unsigned i = 0; i < lengthof(register_names); ++i) {
+        snprintf(register_names[i], sizeof(register_names[i]), "reg%05x", i * 2654435761u % 0xFFFFF);
+    }
+    command_table table(5000);
+    table.cmds.insert(table.cmds.begin(),
+                      ECON_COMMAND_COMPLETE("regs", nop, "bench", NULL, many_complete));
+    struct econ_registry *reg = econ_registry_create(table.cmds.data());
+    static const char *const lines[][2] = {
+        {"", NULL}, {"cmd1", NULL}, {"cmd1234", NULL}, {"regs", ""}, {"regs", "reg1"},
+    };
+
+    for (size_t i = 0; i < lengthof(lines); ++i) {
+        std::vector<std::string> words;
+        std::vector<char *> argv;
+        for (size_t j = 0; (j < 2) && (lines[i][j] != NULL); ++j) {
+            words.push_back(lines[i][j]);
+        }
+        for (size_t j = 0; j < words.size(); ++j) {
+            argv.push_back(&words[j][0]);
+        }
+
+        const uint64_t loops = 200;
+        struct econ_completion comp;
+        ssize_t count = 0;
+        uint64_t start = bench_begin();
+        for (uint64_t j = 0; j < loops; ++j) {
+            completion_init(&comp, argv.back());
+            econ_registry_complete(reg, argv.size(), argv.data(), &comp);
+            count = completion_finish(&comp);
+            completion_common(&comp);
+            completion_free(&comp);
+        }
+        std::string name = "complete/";
+        for (size_t j = 0; j < words.size(); ++j) {
+            name += (j > 0) ? " " + words[j] : words[j];
+        }
+        report(name + "|", loops, now_ns() - start);
+        metric(count, "candidates");
+    }
+
+    econ_registry_destroy(reg);
+}
+
+/**
+ *  feed @c data into a pipe from a thread, returns the read end.
+ */
+static int pipe_feed(const std::string &data, std::thread &writer)
+{
+    int pfd[2];
+
+    if (pipe(pfd) != 0) {
+        perror("pipe");
+        return -1;
+    }
+    writer = std::thread([&data](int fd) {
+        for (size_t pos = 0; pos < data.size();) {
+            ssize_t len = __real_write(fd, &data[pos], data.size() - pos);
+            if (len <= 0) {
+                break;
+            }
+            pos += len;
+        }
+        close(fd);
+    }, pfd[1]);
+
+    return pfd[0];
+}
+
+/**
+ *  script through the interactive editor vs. batch mode and framed requests.
+ */
+static void bench_batch(void)
+{
+    static struct econ_command cmds[] = {
+        ECON_COMMAND("nop", nop, "bench", NULL),
+        ECON_END_OF_COMMAND()
+    };
+    const uint64_t lines = 200000;
+    std::string script;
+    for (uint64_t i = 0; i < lines; ++i) {
+        script += "nop set 0x4000a000 0xdeadbeef\n";
+    }
+    int null_fd = open("/dev/null", O_WRONLY);
+
+    std::thread writer;
+    int fd = pipe_feed(script, writer);
+    struct econ_session *s = econ_session_create(fd, null_fd);
+    uint64_t count = 0;
+    uint64_t start = bench_begin();
+    for (;;) {
+        char *argv[16];
+        int argc = econ_session_prompt(s, "bench>", argv, lengthof(argv));
+        if (argc < 0) {
+            break;
+        }
+        econ_session_invoke(s, argc, argv, cmds);
+        ++count;
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("batch/interactive", count, elapsed);
+    metric(count * 1e9 / elapsed, "cmds/s");
+    econ_session_destroy(s);
+    writer.join();
+    close(fd);
+
+    fd = pipe_feed(script, writer);
+    struct econ_batch_stats stats;
+    start = bench_begin();
+    econ_run_stream(fd, cmds, 0, &stats);
+    elapsed = now_ns() - start;
+    report("batch/stream", stats.commands, elapsed);
+    metric(stats.commands * 1e9 / elapsed, "cmds/s");
+    writer.join();
+    close(fd);
+
+    /* framed requests, answered with their output as JSON. */
+    std::string requests;
+    for (uint64_t i = 0; i < lines; ++i) {
+        requests += "{\"id\":" + std::to_string(i) + ",\"argv\":[\"nop\",\"set\",\"0x4000a000\",\"0xdeadbeef\"]}\n";
+    }
+    fd = pipe_feed(requests, writer);
+    start = bench_begin();
+    econ_run_rpc(fd, null_fd, cmds, &stats);
+    elapsed = now_ns() - start;
+    report("batch/rpc", stats.commands, elapsed);
+    metric(stats.commands * 1e9 / elapsed, "cmds/s");
+    writer.join();
+    close(fd);
+    close(null_fd);
+}
+
+/**
+ *  output of a producer through pipeline stages.
+ */
+static void bench_pipe(void)
+{
+    static struct econ_command cmds[] = {
+        ECON_COMMAND("gen", gen, "bench", NULL),
+        ECON_PIPE_COMMANDS(),
+        ECON_END_OF_COMMAND()
+    };
+    static const char *const lines[] = {
+        "gen 200000",
+        "gen 200000 | wc -l",
+        "gen 200000 | grep IRQ",
+        "gen 200000 | grep DATA | grep -v IRQ | head -n 100000",
+    };
+    const uint64_t produced = 200000;
+    const double bytes = produced * strlen("40000000 DATA 0x00000000\r\n");
+    int null_fd = open("/dev/null", O_WRONLY);
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return;
+    }
+    struct econ_session *s = econ_session_create(fds[0], null_fd);
+
+    for (size_t i = 0; i < lengthof(lines); ++i) {
+        char line[128];
+        char *argv[16];
+        uint64_t elapsed = 0;
+        const int rounds = 5;
+
+        bench_begin();
+        for (int r = 0; r < rounds; ++r) {
+            snprintf(line, sizeof(line), "%s", lines[i]);
+            int argc = token_split(line, strlen(line), argv, lengthof(argv), NULL);
+            uint64_t start = now_ns();
+            econ_session_invoke(s, argc, argv, cmds);
+            elapsed += now_ns() - start;
+        }
+        report(std::string("pipe/") + lines[i], produced * rounds, elapsed);
+        metric(bytes * rounds * 1e3 / elapsed, "MB/s");
+    }
+    econ_session_destroy(s);
+    close(fds[0]);
+    close(fds[1]);
+    close(null_fd);
+}
+
+/**
+ *  cached output served, against the command run each time.
+ */
+static void bench_cache(void)
+{
+    static struct econ_command cmds[] = {
+        ECON_COMMAND("gen", gen, "bench", NULL),
+        ECON_CACHED_COMMAND("cached", gen, "bench", NULL, 0),
+        ECON_END_OF_COMMAND()
+    };
+    static const char *const counts[] = {"1", "100"};
+    int null_fd = open("/dev/null", O_WRONLY);
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return;
+    }
+    struct econ_session *s = econ_session_create(fds[0], null_fd);
+    const uint64_t loops = 20000;
+
+    for (size_t i = 0; i < lengthof(counts); ++i) {
+        char gen_word[] = "gen", cached_word[] = "cached";
+        char count[8];
+        snprintf(count, sizeof(count), "%s", counts[i]);
+        char *gen_argv[] = {gen_word, count, NULL};
+        char *cached_argv[] = {cached_word, count, NULL};
+
+        uint64_t start = bench_begin();
+        for (uint64_t l = 0; l < loops; ++l) {
+            econ_session_invoke(s, 2, gen_argv, cmds);
+        }
+        report(std::string("cache/run/") + counts[i], loops, now_ns() - start);
+
+        start = bench_begin();
+        for (uint64_t l = 0; l < loops; ++l) {
+            econ_cache_invalidate(NULL);
+            econ_session_invoke(s, 2, cached_argv, cmds);
+        }
+        report(std::string("cache/miss/") + counts[i], loops, now_ns() - start);
+
+        start = bench_begin();
+        for (uint64_t l = 0; l < loops; ++l) {
+            econ_session_invoke(s, 2, cached_argv, cmds);
+        }
+        report(std::string("cache/hit/") + counts[i], loops, now_ns() - start);
+    }
+    econ_cache_invalidate(NULL);
+
+    econ_session_destroy(s);
+    close(fds[0]);
+    close(fds[1]);
+    close(null_fd);
+}
+
+/**
+ *  line splitting with and without quoting.
+ */
+static void bench_token(void)
+{
+    std::string long_line = "write 0x4000a000";
+    while (long_line.size() < 4000) {
+        long_line += " deadbeefcafebabe0123456789abcdef";
+    }
+    /* worst cases: only separators, one-letter words and escapes. */
+    std::string blank_line(4000, ' ');
+    std::string tiny_line;
+    while (tiny_line.size() < 500) {
+        tiny_line += "a ";
+    }
+    std::string escaped_line = "echo ";
+    while (escaped_line.size() < 4000) {
+        escaped_line += "\\a\\b\\\\\\ ";
+    }
+    const struct {
+        const char *name;
+        std::string line;
+    } cases[] = {
+        {"token/short", "set 0x4000a000 0xdeadbeef"},
+        {"token/quoted", "echo \"hello world\" 'it''s' a\\ b"},
+        {"token/long-4k", long_line},
+        {"token/blank-4k", blank_line},
+        {"token/tiny-words", tiny_line},
+        {"token/escaped-4k", escaped_line},
+    };
+    std::vector<char> buf(8192);
+    char *argv[256];
+
+    for (size_t c = 0; c < lengthof(cases); ++c) {
+        const std::string &line = cases[c].line;
+        const uint64_t rounds = 100000;
+        uint64_t elapsed = 0;
+        int words = 0;
+
+        bench_begin();
+        for (uint64_t i = 0; i < rounds; ++i) {
+            memcpy(buf.data(), line.c_str(), line.size() + 1);
+            uint64_t start = now_ns();
+            words += token_split(buf.data(), line.size(), argv, lengthof(argv), NULL);
+            elapsed += now_ns() - start;
+        }
+        report(cases[c].name, rounds, elapsed);
+        metric(line.size() * rounds * 1e3 / elapsed, "MB/s");
+        metric(words / (double)rounds, "words");
+    }
+}
+
+/**
+ *  per-call cost of logging on the calling thread.
+ */
+static void bench_log(void)
+{
+    const int batch = 1000;
+    const int rounds = 200;
+    uint64_t elapsed = 0;
+
+    econ_log_open("/dev/null");
+    bench_begin();
+    for (int r = 0; r < rounds; ++r) {
+        uint64_t start = now_ns();
+        for (int i = 0; i < batch; ++i) {
+            econ_log_debug("reg %08x = %08x (%d)", 0x4000a000 + i, r, i);
+        }
+        elapsed += now_ns() - start;
+        /* keep the ring from filling up, outside the measurement. */
+        econ_log_flush();
+    }
+    report("log/ring", batch * rounds, elapsed);
+
+    elapsed = 0;
+    bench_begin();
+    for (int r = 0; r < rounds; ++r) {
+        uint64_t start = now_ns();
+        for (int i = 0; i < batch; ++i) {
+            econ_log_debug("cmd %s %d", "dummy", i);
+        }
+        elapsed += now_ns() - start;
+        econ_log_flush();
+    }
+    report("log/ring-string", batch * rounds, elapsed);
+
+    const int threads = 4;
+    std::vector<std::thread> workers;
+    std::vector<uint64_t> times(threads);
+    bench_begin();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&times, t, batch]() {
+            for (int r = 0; r < 20; ++r) {
+                uint64_t start = now_ns();
+                for (int i = 0; i < batch; ++i) {
+                    econ_log_debug("worker %d %d", t, i);
+                }
+                times[t] += now_ns() - start;
+                usleep(150 * 1000);
+            }
+        });
+    }
+    elapsed = 0;
+    for (int t = 0; t < threads; ++t) {
+        workers[t].join();
+        elapsed += times[t];
+    }
+    report("log/ring-4-threads", threads * batch * 20, elapsed);
+    econ_log_close();
+
+    /* the former logger_debug(): fprintf and fflush on each call. */
+    FILE *fp = fopen("/dev/null", "w");
+    uint64_t start = bench_begin();
+    for (int i = 0; i < batch * 20; ++i) {
+        fprintf(fp, "%s:%d:%s reg %08x = %08x (%d)\n", __FILE__, __LINE__, __func__, 0x4000a000 + i, 0, i);
+        fflush(fp);
+    }
+    report("log/fprintf-fflush", batch * 20, now_ns() - start);
+    fclose(fp);
+}
+
+/**
+ *  record relayed data.
+ */
+static size_t relay_record(void *ctx, char *data, size_t len, bool *end)
+{
+    record_add((struct recorder *)ctx, RECORD_OUTPUT, data, len);
+    return len;
+}
+
+/**
+ *  relay of a bulk stream from a pipe or a pty to a pipe,
+ *  by splice(), by copying, and by copying with recording.
+ */
+static void bench_relay(void)
+{
+    static const char *const modes[] = {"splice", "copy", "record"};
+    const size_t chunk = 64 * 1024;
+    const size_t total = 256 * 1024 * 1024;
+    std::vector<char> data(chunk, 'x');
+
+    for (int source = 0; source < 2; ++source) {
+        for (int mode = 0; mode < 3; ++mode) {
+            int in[2], out[2];
+
+            if (source == 0) {
+                if (pipe(in) != 0) {
+                    perror("pipe");
+                    return;
+                }
+            } else {
+                /* in[0] is the master side, in[1] the slave side. */
+                in[0] = posix_openpt(O_RDWR | O_NOCTTY);
+                if ((in[0] < 0) || (grantpt(in[0]) != 0) || (unlockpt(in[0]) != 0)) {
+                    perror("posix_openpt");
+                    return;
+                }
+                in[1] = open(ptsname(in[0]), O_RDWR | O_NOCTTY);
+                struct termios raw;
+                tcgetattr(in[1], &raw);
+                cfmakeraw(&raw);
+                tcsetattr(in[1], TCSANOW, &raw);
+            }
+            if (pipe(out) != 0) {
+                perror("pipe");
+                return;
+            }
+            size_t bytes = (source == 0) ? total : total / 8;
+
+            uint64_t start = bench_begin();
+            std::thread producer([&data, &in, bytes]() {
+                for (size_t sent = 0; sent < bytes;) {
+                    ssize_t len = __real_write(in[1], data.data(), std::min(data.size(), bytes - sent));
+                    if (len <= 0) {
+                        break;
+                    }
+                    sent += len;
+                }
+                close(in[1]);
+            });
+            uint64_t received = 0;
+            std::thread consumer([&out, &received]() {
+                char buf[65536];
+                ssize_t len;
+                while ((len = __real_read(out[0], buf, sizeof(buf))) > 0) {
+                    received += len;
+                }
+            });
+
+            struct relay relay;
+            struct recorder *rec = (mode == 2) ? record_open("/dev/null") : NULL;
+            if ((relay_init(&relay) != 0)
+                || (relay_add(&relay, in[0], out[1], RELAY_LAST | ((mode > 0) ? RELAY_COPY : 0),
+                              (rec) ? relay_record : NULL, rec) != 0)
+                || (relay_run(&relay) != 0)) {
+                perror("relay");
+            }
+            producer.join();
+            close(out[1]);
+            consumer.join();
+            uint64_t elapsed = now_ns() - start;
+            record_close(rec);
+
+            std::string name = std::string("relay/") + ((source == 0) ? "pipe/" : "pty/") + modes[mode];
+            report(name, received / chunk, elapsed);
+            metric(received * 1e3 / elapsed, "MB/s");
+            metric((double)(relay.dirs[0].splices + relay.dirs[0].copies) * chunk / received, "calls/64KiB");
+            relay_destroy(&relay);
+            close(in[0]);
+            close(out[0]);
+        }
+    }
+}
+
+/**
+ *  benchmark entry.
+ */
+struct bench_entry {
+    const char *name;   /**< benchmark name. */
+    void (*run)(void);  /**< benchmark function. */
+};
+
+static const struct bench_entry benches[] = {
+    {"dispatch", bench_dispatch},
+    {"suggest", bench_suggest},
+    {"server", bench_server},
+    {"editor", bench_editor},
+    {"input", bench_input},
+    {"step", bench_step},
+    {"history", bench_history},
+    {"complete", bench_complete},
+    {"batch", bench_batch},
+    {"pipe", bench_pipe},
+    {"cache", bench_cache},
+    {"log", bench_log},
+    {"token", bench_token},
+    {"relay", bench_relay},
+};
+
+/**
+ *  main.
+ *
+ *  with -j, results are printed as JSON lines.
+ *
+ *  @param  [in]    argc    command-line argument count.
+ *  @param  [in]    argv    command-line argument values.
+ *  @return returns 0 on success.
+ *          on error, 1 is returned.
+ */
+int main(int argc, char **argv)
+{
+    int ran = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "j")) != -1) {
+        switch (opt) {
+        case 'j':
+            json = true;
+            break;
+        default:
+            printf("usage: %s [-j] [benchmark ...]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    for (size_t i = 0; i < lengthof(benches); ++i) {
+        bool selected = (optind >= argc);
+        for (int j = optind; j < argc; ++j) {
+            selected = selected || (strcmp(argv[j], benches[i].name) == 0);
+        }
+        if (selected) {
+            benches[i].run();
+            ++ran;
+        }
+    }
+
+    if (ran == 0) {
+        printf("usage: %s [-j] [benchmark ...]\n", argv[0]);
+        return 1;
+    }
+    return 0;
+}
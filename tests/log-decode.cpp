@@ -0,0 +1,55 @@
+/** @file       log-decode.cpp
+ *  @brief      Binary log decoder.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "econ.h"
+
+/**
+ *  command usage.
+ *
+ *  @param  [in]    name    command name.
+ */
+static void usage(const char *name)
+{
+    printf("usage: %s [log-file]\n", name);
+}
+
+/**
+ *  main.
+ *
+ *  @param  [in]    argc    command-line argument count.
+ *  @param  [in]    argv    command-line argument values.
+ *  @return returns 0 on success.
+ *          on error, 1 is returned.
+ */
+int main(int argc, char **argv)
+{
+    int fd = STDIN_FILENO;
+
+    if (argc > 2) {
+        usage(argv[0]);
+        return 1;
+    } else if (argc == 2) {
+        fd = open(argv[1], O_RDONLY);
+        if (fd < 0) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    if (econ_log_decode(fd, STDOUT_FILENO) != 0) {
+        perror("decode");
+        return 1;
+    }
+    return 0;
+}
@@ -9,10 +9,15 @@
  */
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <termios.h>
 
-#include "econ.h"
+#include "econ.hpp"
 
 extern "C" {
 
@@ -20,7 +25,7 @@ extern "C" {
 
 static void dummy_usage(const char *name)
 {
-    printf("usage: %s\n", name);
+    econ_printf("usage: %s\r\n", name);
 }
 
 static int dummy(int argc, char **argv)
@@ -34,6 +39,17 @@ static int dummy(int argc, char **argv)
     return 0;
 }
 
+static void dummy_complete(struct econ_completion *comp, int argc, char **argv)
+{
+    static const char *const devices[] = {"eth0", "eth1", "uart0", "uart1", "spi0"};
+
+    if (argc == 2) {
+        for (size_t i = 0; i < sizeof(devices) / sizeof(devices[0]); ++i) {
+            econ_completion_add(comp, devices[i]);
+        }
+    }
+}
+
 static int aaa(int argc, char **argv)
 {
     DEBUG("called: %d", argc);
@@ -41,6 +57,120 @@ static int aaa(int argc, char **argv)
     return -1;
 }
 
+static int cmd_sleep(int argc, char **argv)
+{
+    int seconds = (argc > 1) ? atoi(argv[1]) : 1;
+
+    for (int i = 0; i < seconds * 10; ++i) {
+        if (econ_cancelled()) {
+            econ_printf("%s: cancelled\r\n", argv[0]);
+            return -1;
+        }
+        usleep(100 * 1000);
+        if ((i % 10) == 9) {
+            econ_printf("%s: %d/%d\r\n", argv[0], i / 10 + 1, seconds);
+        }
+    }
+
+    return 0;
+}
+
+static void alarm_ring(struct econ_timer *t, void *ctx)
+{
+    char *message = (char *)ctx;
+
+    econ_printf("alarm: %s\r\n", message);
+    free(message);
+    econ_timer_remove(t);
+}
+
+static int cmd_alarm(int argc, char **argv)
+{
+    int seconds = (argc > 1) ? atoi(argv[1]) : 1;
+    char *message = strdup((argc > 2) ? argv[2] : "ring");
+
+    if (econ_timer_add(econ_session_current(), seconds * 1000ULL, 0, alarm_ring, message) == NULL) {
+        econ_printf("%s: %s\r\n", argv[0], strerror(errno));
+        free(message);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int cmd_regs(int argc, char **argv)
+{
+    static const char *const names[] = {"CTRL", "STATUS", "IRQ_EN", "IRQ_STAT", "DMA_SRC", "DMA_DST"};
+    int count = (argc > 1) ? econ_values()[0].i : 1;
+
+    for (int i = 0; i < count; ++i) {
+        for (size_t j = 0; j < sizeof(names) / sizeof(names[0]); ++j) {
+            econ_printf("%08zx %-8s 0x%08x\r\n", 0x40000000 + (i * 0x100) + (j * 4), names[j], (unsigned int)(i ^ j));
+        }
+    }
+
+    return 0;
+}
+
+static int cmd_status(int argc, char **argv)
+{
+    static int reads = 0;
+
+    /* a slow device read. */
+    usleep(200 * 1000);
+    econ_printf("link up, %d reads\r\n", ++reads);
+
+    return 0;
+}
+
+static int cmd_counters(int argc, char **argv)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    unsigned long long ms = ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+
+    econ_printf("%-6s %12s %12s\r\n", "port", "rx", "tx");
+    for (int i = 0; i < 4; ++i) {
+        /* busier ports count faster. */
+        unsigned long long rx = (ms >> (i * 3)) * 64;
+        econ_printf("eth%-3d %12llu %12llu\r\n", i, rx, rx / 2);
+    }
+
+    return 0;
+}
+
+static const char *const poke_widths[] = {"8", "16", "32", NULL};
+
+static int cmd_poke(int argc, char **argv)
+{
+    const union econ_value *v = econ_values();
+    static const int bits[] = {8, 16, 32};
+
+    econ_printf("%s: 0x%08llx <- 0x%0*llx (%d bits) \"%s\"\r\n", argv[0], v[0].u,
+                bits[v[1].index] / 4, v[2].u, bits[v[1].index], (argc > 4) ? v[3].s : "");
+    econ_cache_invalidate(cmd_status);
+
+    return 0;
+}
+
+static const struct econ_arg poke_args[] = {
+    ECON_ARG_HEX("addr", 0x40000000, 0x4000ffff),
+    ECON_ARG_ENUM("width", poke_widths),
+    ECON_ARG_HEX("value", 0, 0xffffffff),
+    ECON_ARG("comment", ECON_TYPE_STRING, 0, 32, NULL, ECON_ARG_OPTIONAL),
+    ECON_END_OF_ARG()
+};
+
+static const struct econ_arg regs_args[] = {
+    ECON_ARG("count", ECON_TYPE_INT, 1, 100000, NULL, ECON_ARG_OPTIONAL),
+    ECON_END_OF_ARG()
+};
+
+static void close_log(void)
+{
+    econ_log_close();
+}
+
 static struct termios saved_term;
 static int cmd_exit(int argc, char **argv)
 {
@@ -50,20 +180,52 @@ static int cmd_exit(int argc, char **argv)
     exit(0);
 }
 
-static struct econ_command sub_cmds[] = {
-    ECON_COMMAND("dummy", dummy, "dummy help", NULL),
-    ECON_END_OF_COMMAND()
-};
+}
 
-static struct econ_command test_cmds[] = {
-    ECON_COMMAND("dummy", dummy, "help message", dummy_usage),
-    ECON_COMMAND("dummmmmmmmmmmmmmmmmmmmmmmy", dummy, "help message", dummy_usage),
-    ECON_SUBCOMMAND("sub", sub_cmds, "sub-commands help"),
+static int cmd_help(int argc, char **argv);
+static int cmd_registry(int argc, char **argv);
+
+static constexpr auto sub_table = econ::make_table({
+    econ::command("dummy", dummy, "dummy help"),
+});
+
+static constexpr auto test_table = econ::make_table({
+    econ::command("dummy", dummy, "help message", dummy_usage, dummy_complete),
+    econ::command("dummmmmmmmmmmmmmmmmmmmmmmy", dummy, "help message", dummy_usage),
+    econ::subcommand("sub", sub_table.commands(), "sub-commands help"),
     ECON_COMMAND("aaa", aaa, "aaa help", NULL),
+    ECON_ASYNC_COMMAND("sleep", cmd_sleep, "sleep seconds", NULL),
+    ECON_COMMAND("alarm", cmd_alarm, "print message after seconds", NULL),
+    ECON_COMMAND_ARGS("regs", cmd_regs, "dump registers", regs_args),
+    ECON_COMMAND_ARGS("poke", cmd_poke, "write register", poke_args),
+    econ::cached_command("status", cmd_status, "show link status", 2000),
+    ECON_COMMAND("counters", cmd_counters, "show port counters", NULL),
+    ECON_JOB_COMMANDS(),
+    ECON_PIPE_COMMANDS(),
+    ECON_LOG_COMMAND(),
+    ECON_STATS_COMMAND(),
+    ECON_CACHE_COMMAND(),
+    ECON_WATCH_COMMAND(),
+    ECON_COMMAND("registry", cmd_registry, "invoke a command through the registry", NULL),
     ECON_COMMAND("exit", cmd_exit, "exit console", NULL),
-    ECON_END_OF_COMMAND()
-};
+    ECON_COMMAND("help", cmd_help, "list commands", NULL),
+});
+
+static constexpr struct econ_command *test_cmds = test_table.commands();
+
+static struct econ_registry *test_registry = NULL;
 
+static int cmd_help(int argc, char **argv)
+{
+    const auto &text = econ::help_text<test_table>;
+
+    return (econ_write(text.data(), text.size() - 1) < 0) ? -1 : 0;
+}
+
+static int cmd_registry(int argc, char **argv)
+{
+    /* dispatched as from the table, only the lookup differs. */
+    return econ_registry_invoke(test_registry, argc - 1, &argv[1]);
 }
 
 /**
@@ -76,6 +238,100 @@ static struct econ_command test_cmds[] = {
  */
 int main(int argc, char **argv)
 {
+    struct econ_server_config config = {};
+    const char *history_path = NULL;
+    const char *script_path = NULL;
+    const char *log_path = NULL;
+    struct econ_output_config output = {64 * 1024, ECON_OUTPUT_BLOCK, 0};
+    bool stepping = false;
+    int opt;
+
+    config.tcp_port = -1;
+    config.prompt = "test $";
+    config.cmds = test_cmds;
+    while ((opt = getopt(argc, argv, "u:p:H:f:L:o:xer")) != -1) {
+        switch (opt) {
+        case 'r':
+            config.rpc = 1;
+            break;
+        case 'o':
+            if (strcmp(optarg, "drop") == 0) {
+                output.policy = ECON_OUTPUT_DROP;
+            } else if (strcmp(optarg, "more") == 0) {
+                output.policy = ECON_OUTPUT_MORE;
+            } else {
+                output.policy = ECON_OUTPUT_BLOCK;
+            }
+            break;
+        case 'x':
+            output.flow |= ECON_FLOW_XONXOFF;
+            break;
+        case 'e':
+            stepping = true;
+            break;
+        case 'L':
+            log_path = optarg;
+            break;
+        case 'f':
+            script_path = optarg;
+            break;
+        case 'H':
+            history_path = optarg;
+            break;
+        case 'u':
+            config.unix_path = optarg;
+            break;
+        case 'p':
+            config.tcp_port = atoi(optarg);
+            break;
+        default:
+            printf("usage: %s [-f script] [-H history-file] [-L log-file] [-u unix-path] [-p tcp-port]\n"
+                   "          [-o block|drop|more] [-x] [-e] [-r]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (log_path != NULL) {
+        if (econ_log_open(log_path) != 0) {
+            perror(log_path);
+            return 1;
+        }
+        atexit(close_log);
+    }
+    bool serving = (config.unix_path != NULL) || (config.tcp_port >= 0);
+    if (config.rpc && !serving) {
+        return (econ_run_rpc(STDIN_FILENO, STDOUT_FILENO, test_cmds, NULL) == 0) ? 0 : 1;
+    }
+    if ((script_path != NULL) || (!serving && !isatty(STDIN_FILENO))) {
+        int fd = STDIN_FILENO;
+        if ((script_path != NULL) && ((fd = open(script_path, O_RDONLY | O_CLOEXEC)) < 0)) {
+            perror(script_path);
+            return 1;
+        }
+        int ret = econ_run_stream(fd, test_cmds, 0, NULL);
+        if (fd != STDIN_FILENO) {
+            close(fd);
+        }
+        return (ret == 0) ? 0 : 1;
+    }
+
+    config.history = econ_history_open(history_path, 0);
+    if (config.history == NULL) {
+        perror("econ_history_open");
+        return 1;
+    }
+    if (serving) {
+        struct econ_server *srv = econ_server_create(&config);
+        if (srv == NULL) {
+            return 1;
+        }
+        if (config.tcp_port >= 0) {
+            printf("listening on 127.0.0.1:%d\n", econ_server_port(srv));
+        }
+        int ret = econ_server_run(srv);
+        econ_server_destroy(srv);
+        return (ret == 0) ? 0 : 1;
+    }
+
     if (isatty(STDIN_FILENO)) {
         tcgetattr(STDIN_FILENO, &saved_term);
 
@@ -91,14 +347,40 @@ int main(int argc, char **argv)
         tcsetattr(STDIN_FILENO, TCSAFLUSH, &new_term);
     }
 
+    struct econ_session *s = econ_session_create(STDIN_FILENO, STDOUT_FILENO);
+    if (s == NULL) {
+        return 1;
+    }
+    econ_session_set_history(s, config.history);
+    econ_session_set_flow(s, &output);
+    struct econ_registry *reg = econ_registry_create(test_cmds);
+    econ_session_set_registry(s, reg);
+    test_registry = reg;
+    struct pollfd pfd = {econ_session_fd(s), POLLIN, 0};
     do {
         char *cmd_args[24] = {0};
-        int cmd_argc = econ_prompt("test $", cmd_args, 24);
+        int cmd_argc;
+
+        if (stepping) {
+            /* as a host event loop would, polling the session among its own fds. */
+            cmd_argc = econ_session_step(s, "test $", cmd_args, 24);
+            if ((cmd_argc < 0) && (errno == EAGAIN)) {
+                poll(&pfd, 1, -1);
+                continue;
+            }
+        } else {
+            cmd_argc = econ_session_prompt(s, "test $", cmd_args, 24);
+        }
 
         if (cmd_argc > 0) {
-            econ_invoke(cmd_argc, cmd_args, test_cmds);
+            econ_session_invoke(s, cmd_argc, cmd_args, test_cmds);
+        } else if ((cmd_argc < 0) && (errno == ENODATA)) {
+            break;
         }
     } while (1);
+    econ_session_destroy(s);
+    econ_registry_destroy(reg);
+    econ_history_close(config.history);
 
     return 0;
 }
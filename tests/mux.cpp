@@ -0,0 +1,652 @@
+/** @file       mux.cpp
+ *  @brief      Console session multiplexer.
+ *
+ *  every session is a child on a pty of its own, all of them and the
+ *  client are served by one epoll loop. output of each session is kept
+ *  in a ring of fixed size, so that a client attaching or switching to
+ *  it sees recent output without the commands being run again.
+ *
+ *  memory of a session is bounded by its ring and by
+ *  @ref MUX_QUEUE_MAX of keys pending for it, reading from the client
+ *  pauses while the active session has that much pending. likewise
+ *  reading from the active session pauses while the client has
+ *  @ref MUX_QUEUE_MAX pending, the other sessions only fill their rings.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstdarg>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include "mux.h"
+
+/**
+ *  epoll tags other than session indexes.
+ */
+enum {
+    MUX_TAG_LISTEN = 100,   /**< listening socket. */
+    MUX_TAG_IN,             /**< client input, and output if the same fd. */
+    MUX_TAG_OUT,            /**< client output. */
+};
+
+/**
+ *  bytes read at once.
+ */
+#define MUX_READ_SIZE (16 * 1024)
+
+/**
+ *  clear the screen of the client.
+ */
+#define MUX_CLEAR "\x1b[H\x1b[2J"
+
+/**
+ *  change events registered for @c fd.
+ */
+static void mux_watch(struct mux *m, int fd, uint32_t tag, uint32_t events, uint32_t *current)
+{
+    if (events != *current) {
+        struct epoll_event ev;
+
+        ev.events = events;
+        ev.data.u32 = tag;
+        epoll_ctl(m->epfd, EPOLL_CTL_MOD, fd, &ev);
+        *current = events;
+    }
+}
+
+/**
+ *  get bytes queued to the client.
+ */
+static size_t mux_queued(const struct mux *m)
+{
+    return m->queue.size() - m->head;
+}
+
+/**
+ *  write queued output to the client.
+ */
+static void mux_flush(struct mux *m)
+{
+    while (mux_queued(m) > 0) {
+        ssize_t n = write(m->out, &m->queue[m->head], mux_queued(m));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            /* on error, the client is dropped when its input fails. */
+            break;
+        }
+        m->head += n;
+    }
+    if (m->head == m->queue.size()) {
+        m->queue.clear();
+        m->head = 0;
+    } else if (m->head > m->queue.size() / 2) {
+        m->queue.erase(0, m->head);
+        m->head = 0;
+    }
+}
+
+/**
+ *  send @c data to the client, if any.
+ */
+static void mux_send(struct mux *m, const char *data, size_t len)
+{
+    if (m->out < 0) {
+        return;
+    }
+    m->queue.append(data, len);
+    mux_flush(m);
+}
+
+/**
+ *  tell the client @c fmt.
+ */
+static void mux_notify(struct mux *m, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void mux_notify(struct mux *m, const char *fmt, ...)
+{
+    char msg[256];
+    va_list ap;
+
+    va_start(ap, fmt);
+    int len = vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+    if (len > 0) {
+        mux_send(m, msg, ((size_t)len < sizeof(msg)) ? len : sizeof(msg) - 1);
+    }
+}
+
+/**
+ *  keep output @c data of @c s in its ring.
+ */
+static void mux_keep(struct mux *m, struct mux_session *s, const char *data, size_t len)
+{
+    const size_t cap = m->scrollback;
+
+    if (len >= cap) {
+        data += len - cap;
+        len = cap;
+        s->wrapped = s->wrapped || (s->len > 0);
+        s->start = s->len = 0;
+    }
+    size_t end = (s->start + s->len) % cap;
+    size_t first = (len < cap - end) ? len : cap - end;
+    memcpy(&s->ring[end], data, first);
+    memcpy(s->ring, &data[first], len - first);
+    s->len += len;
+    if (s->len > cap) {
+        s->start = (s->start + s->len - cap) % cap;
+        s->len = cap;
+        s->wrapped = true;
+    }
+}
+
+/**
+ *  show session @c index to the client, replaying its scrollback.
+ */
+static void mux_show(struct mux *m, size_t index)
+{
+    struct mux_session *s = &m->sessions[index];
+    const size_t cap = m->scrollback;
+    std::string screen(MUX_CLEAR);
+
+    m->active = index;
+    if (m->out < 0) {
+        return;
+    }
+    size_t first = (s->len < cap - s->start) ? s->len : cap - s->start;
+    screen.append(&s->ring[s->start], first);
+    screen.append(s->ring, s->len - first);
+    size_t from = strlen(MUX_CLEAR);
+    if (s->wrapped) {
+        /* the oldest line is likely cut. */
+        size_t nl = screen.find('\n', from);
+        screen.erase(from, (nl != std::string::npos) ? nl + 1 - from : 0);
+    }
+    mux_send(m, screen.data(), screen.size());
+}
+
+/**
+ *  get the next live session after @c index.
+ *
+ *  @return returns index of the session.
+ *          if none, @c count is returned.
+ */
+static size_t mux_next(const struct mux *m, size_t index)
+{
+    for (size_t i = 1; i <= m->count; ++i) {
+        size_t next = (index + i) % m->count;
+        if (!m->sessions[next].exited) {
+            return next;
+        }
+    }
+    return m->count;
+}
+
+/**
+ *  drop the client.
+ */
+static void mux_detach(struct mux *m)
+{
+    if (m->in < 0) {
+        return;
+    }
+    mux_flush(m);
+    epoll_ctl(m->epfd, EPOLL_CTL_DEL, m->in, NULL);
+    if (m->out != m->in) {
+        epoll_ctl(m->epfd, EPOLL_CTL_DEL, m->out, NULL);
+    }
+    if (m->local) {
+        /* the terminal goes on after us. */
+        fcntl(m->in, F_SETFL, fcntl(m->in, F_GETFL) & ~O_NONBLOCK);
+        fcntl(m->out, F_SETFL, fcntl(m->out, F_GETFL) & ~O_NONBLOCK);
+    } else {
+        close(m->in);
+    }
+    m->in = m->out = -1;
+    m->queue.clear();
+    m->head = 0;
+    m->prefix = false;
+}
+
+/**
+ *  take @c in and @c out as the client, dropping any other.
+ *
+ *  @return returns 0 on success.
+ *          on error, -1 is returned, and @c errno set.
+ */
+static int mux_attach(struct mux *m, int in, int out, bool local)
+{
+    struct epoll_event ev;
+
+    if (m->in >= 0) {
+        mux_notify(m, "\r\n[taken over]\r\n");
+        mux_detach(m);
+    }
+    ev.events = 0;
+    ev.data.u32 = MUX_TAG_IN;
+    if (epoll_ctl(m->epfd, EPOLL_CTL_ADD, in, &ev) != 0) {
+        return -1;
+    }
+    if (out != in) {
+        ev.data.u32 = MUX_TAG_OUT;
+        if (epoll_ctl(m->epfd, EPOLL_CTL_ADD, out, &ev) != 0) {
+            epoll_ctl(m->epfd, EPOLL_CTL_DEL, in, NULL);
+            return -1;
+        }
+    }
+    if (local) {
+        fcntl(in, F_SETFL, fcntl(in, F_GETFL) | O_NONBLOCK);
+        fcntl(out, F_SETFL, fcntl(out, F_GETFL) | O_NONBLOCK);
+    }
+    m->in = in;
+    m->out = out;
+    m->local = local;
+    m->in_events = m->out_events = 0;
+    mux_show(m, m->active);
+
+    return 0;
+}
+
+/**
+ *  write pending keys to @c s.
+ */
+static void mux_feed(struct mux_session *s)
+{
+    while (!s->input.empty()) {
+        ssize_t n = write(s->master, s->input.data(), s->input.size());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            /* EIO once hung up, found by reading. */
+            break;
+        }
+        s->input.erase(0, n);
+    }
+}
+
+/**
+ *  list sessions and their memory to the client.
+ */
+static void mux_list(struct mux *m)
+{
+    size_t total = m->queue.capacity();
+
+    mux_notify(m, "\r\n");
+    for (size_t i = 0; i < m->count; ++i) {
+        struct mux_session *s = &m->sessions[i];
+        char state[32];
+
+        if (s->exited && (s->status == -1) && (waitpid(s->pid, &s->status, WNOHANG) <= 0)) {
+            s->status = -1;
+        }
+        if (!s->exited) {
+            snprintf(state, sizeof(state), "running");
+        } else if (WIFEXITED(s->status)) {
+            snprintf(state, sizeof(state), "exit %d", WEXITSTATUS(s->status));
+        } else if (WIFSIGNALED(s->status)) {
+            snprintf(state, sizeof(state), "signal %d", WTERMSIG(s->status));
+        } else {
+            /* the pty closed before the child exited. */
+            snprintf(state, sizeof(state), "hung up");
+        }
+        mux_notify(m, "%c%zu  pid %d  %-10s  scrollback %zu/%zu  input %zu\r\n",
+                   (i == m->active) ? '*' : ' ', i, (int)s->pid, state,
+                   s->len, m->scrollback, s->input.size());
+        total += m->scrollback + s->input.capacity();
+    }
+    mux_notify(m, " memory %zu bytes, %zu per session at most, client queue %zu\r\n",
+               total, m->scrollback + MUX_QUEUE_MAX, mux_queued(m));
+}
+
+/**
+ *  run the command key @c c typed after the prefix.
+ */
+static void mux_command(struct mux *m, char c)
+{
+    if ((c >= '0') && (c <= '9')) {
+        size_t index = c - '0';
+        if ((index < m->count) && !m->sessions[index].exited) {
+            mux_show(m, index);
+        } else {
+            mux_notify(m, "\r\n[no session %zu]\r\n", index);
+        }
+    } else if (c == 'n') {
+        mux_show(m, mux_next(m, m->active));
+    } else if (c == 'l') {
+        mux_list(m);
+    } else if (c == 'd') {
+        if (m->local) {
+            mux_notify(m, "\r\n[the terminal cannot detach]\r\n");
+        } else {
+            mux_notify(m, "\r\n[detached]\r\n");
+            mux_detach(m);
+        }
+    } else if (c == 'q') {
+        m->quit = true;
+    } else if (c == MUX_PREFIX) {
+        m->sessions[m->active].input += c;
+    } else {
+        mux_notify(m, "\r\n[^] then 0-9 select, n next, l list, d detach, q quit, ^] itself]\r\n");
+    }
+}
+
+/**
+ *  read keys from the client.
+ */
+static void mux_keys(struct mux *m)
+{
+    char buf[4096];
+    ssize_t n = read(m->in, buf, sizeof(buf));
+
+    if (n <= 0) {
+        if ((n < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))) {
+            return;
+        }
+        if (m->local) {
+            m->quit = true;
+        } else {
+            mux_detach(m);
+        }
+        return;
+    }
+
+    size_t run = 0;
+    for (ssize_t i = 0; i < n; ++i) {
+        if (m->prefix) {
+            m->prefix = false;
+            run = i + 1;
+            mux_command(m, buf[i]);
+            if (m->in < 0) {
+                return;
+            }
+        } else if (buf[i] == MUX_PREFIX) {
+            m->sessions[m->active].input.append(&buf[run], i - run);
+            m->prefix = true;
+        }
+    }
+    if (!m->prefix) {
+        m->sessions[m->active].input.append(&buf[run], n - run);
+    }
+    mux_feed(&m->sessions[m->active]);
+}
+
+/**
+ *  the child of @c index hung up.
+ */
+static void mux_exited(struct mux *m, size_t index)
+{
+    struct mux_session *s = &m->sessions[index];
+
+    epoll_ctl(m->epfd, EPOLL_CTL_DEL, s->master, NULL);
+    close(s->master);
+    s->master = -1;
+    s->exited = true;
+    s->input.clear();
+    s->input.shrink_to_fit();
+    if (waitpid(s->pid, &s->status, WNOHANG) <= 0) {
+        s->status = -1;
+    }
+    mux_notify(m, "\r\n[session %zu exited]\r\n", index);
+
+    size_t next = mux_next(m, index);
+    if (next == m->count) {
+        m->quit = true;
+    } else if (index == m->active) {
+        mux_show(m, next);
+    }
+}
+
+/**
+ *  read output of session @c index.
+ */
+static void mux_output(struct mux *m, size_t index)
+{
+    struct mux_session *s = &m->sessions[index];
+    char buf[MUX_READ_SIZE];
+    ssize_t n = read(s->master, buf, sizeof(buf));
+
+    if (n > 0) {
+        mux_keep(m, s, buf, n);
+        if (index == m->active) {
+            mux_send(m, buf, n);
+        }
+    } else if ((n == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))) {
+        /* EIO once the slave is closed. */
+        mux_exited(m, index);
+    }
+}
+
+/**
+ *  register events wanted from now on.
+ */
+static void mux_interest(struct mux *m)
+{
+    for (size_t i = 0; i < m->count; ++i) {
+        struct mux_session *s = &m->sessions[i];
+        uint32_t events = 0;
+
+        if (s->exited) {
+            continue;
+        }
+        if ((i != m->active) || (mux_queued(m) < MUX_QUEUE_MAX)) {
+            events |= EPOLLIN;
+        }
+        if (!s->input.empty()) {
+            events |= EPOLLOUT;
+        }
+        mux_watch(m, s->master, i, events, &s->events);
+    }
+    if (m->in >= 0) {
+        uint32_t in_events = 0, out_events = 0;
+
+        if (m->sessions[m->active].input.size() < MUX_QUEUE_MAX) {
+            in_events |= EPOLLIN;
+        }
+        if (mux_queued(m) > 0) {
+            out_events |= EPOLLOUT;
+        }
+        if (m->out == m->in) {
+            mux_watch(m, m->in, MUX_TAG_IN, in_events | out_events, &m->in_events);
+        } else {
+            mux_watch(m, m->in, MUX_TAG_IN, in_events, &m->in_events);
+            mux_watch(m, m->out, MUX_TAG_OUT, out_events, &m->out_events);
+        }
+    }
+}
+
+/**
+ *  initialize multiplexer.
+ *
+ *  @param  [in]    m           multiplexer.
+ *  @param  [in]    scrollback  bytes of output kept per session.
+ *  @return returns 0 on success.
+ *          on error, -1 is returned, and @c errno set.
+ */
+int mux_init(struct mux *m, size_t scrollback)
+{
+    if (scrollback == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    m->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (m->epfd < 0) {
+        return -1;
+    }
+    m->scrollback = scrollback;
+    m->count = m->active = 0;
+    m->listen_fd = m->in = m->out = -1;
+    m->local = m->prefix = m->quit = false;
+    m->head = 0;
+
+    return 0;
+}
+
+/**
+ *  add child @c pid on pty @c master.
+ *
+ *  the multiplexer owns @c master from now on.
+ *
+ *  @param  [in]    m       multiplexer.
+ *  @param  [in]    pid     child.
+ *  @param  [in]    master  pty master of the child.
+ *  @return returns 0 on success.
+ *          on error, -1 is returned, and @c errno set.
+ */
+int mux_add(struct mux *m, pid_t pid, int master)
+{
+    if (m->count >= MUX_MAX_SESSIONS) {
+        errno = ENOSPC;
+        return -1;
+    }
+
+    struct mux_session *s = &m->sessions[m->count];
+    s->ring = (char *)malloc(m->scrollback);
+    if (s->ring == NULL) {
+        return -1;
+    }
+
+    struct epoll_event ev;
+    ev.events = 0;
+    ev.data.u32 = m->count;
+    if (epoll_ctl(m->epfd, EPOLL_CTL_ADD, master, &ev) != 0) {
+        free(s->ring);
+        return -1;
+    }
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    s->pid = pid;
+    s->master = master;
+    s->status = -1;
+    s->exited = s->wrapped = false;
+    s->start = s->len = 0;
+    s->events = 0;
+    ++m->count;
+
+    return 0;
+}
+
+/**
+ *  serve sessions until they all exit or the client quits.
+ *
+ *  @param  [in]    m           multiplexer.
+ *  @param  [in]    listen_fd   socket to accept clients on, or -1.
+ *  @param  [in]    in          terminal to serve first, or -1.
+ *  @param  [in]    out         output of the terminal.
+ *  @return returns 0 on success.
+ *          on error, -1 is returned, and @c errno set.
+ */
+int mux_run(struct mux *m, int listen_fd, int in, int out)
+{
+    if (m->count == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (listen_fd >= 0) {
+        struct epoll_event ev;
+
+        ev.events = EPOLLIN;
+        ev.data.u32 = MUX_TAG_LISTEN;
+        if (epoll_ctl(m->epfd, EPOLL_CTL_ADD, listen_fd, &ev) != 0) {
+            return -1;
+        }
+        m->listen_fd = listen_fd;
+    }
+    if ((in >= 0) && (mux_attach(m, in, out, true) != 0)) {
+        return -1;
+    }
+
+    while (!m->quit) {
+        struct epoll_event evs[MUX_MAX_SESSIONS + 3];
+
+        mux_interest(m);
+        int nevs = epoll_wait(m->epfd, evs, MUX_MAX_SESSIONS + 3, -1);
+        if (nevs < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        for (int e = 0; (e < nevs) && !m->quit; ++e) {
+            uint32_t tag = evs[e].data.u32;
+            uint32_t events = evs[e].events;
+
+            if (tag < m->count) {
+                struct mux_session *s = &m->sessions[tag];
+                if (s->exited) {
+                    continue;
+                }
+                if (events & EPOLLOUT) {
+                    mux_feed(s);
+                }
+                if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    mux_output(m, tag);
+                }
+            } else if (tag == MUX_TAG_LISTEN) {
+                int fd = accept4(m->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if ((fd >= 0) && (mux_attach(m, fd, fd, false) != 0)) {
+                    close(fd);
+                }
+            } else if (m->in < 0) {
+                /* a client dropped earlier in this round. */
+                continue;
+            } else if (tag == MUX_TAG_OUT) {
+                if (events & (EPOLLHUP | EPOLLERR)) {
+                    m->quit = m->quit || m->local;
+                    mux_detach(m);
+                } else {
+                    mux_flush(m);
+                }
+            } else {
+                if (events & EPOLLOUT) {
+                    mux_flush(m);
+                }
+                if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    mux_keys(m);
+                }
+            }
+        }
+    }
+    if (m->in >= 0) {
+        mux_notify(m, "\r\n");
+        mux_detach(m);
+    }
+
+    return 0;
+}
+
+/**
+ *  release multiplexer, stopping children.
+ *
+ *  @param  [in]    m       multiplexer.
+ */
+void mux_destroy(struct mux *m)
+{
+    mux_detach(m);
+    for (size_t i = 0; i < m->count; ++i) {
+        struct mux_session *s = &m->sessions[i];
+
+        if (s->master >= 0) {
+            kill(s->pid, SIGTERM);
+            close(s->master);
+        }
+        if (!s->exited || (s->status == -1)) {
+            waitpid(s->pid, NULL, 0);
+        }
+        free(s->ring);
+    }
+    close(m->epfd);
+    m->count = 0;
+}
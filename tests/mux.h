@@ -0,0 +1,91 @@
+/** @file       mux.h
+ *  @brief      Console session multiplexer.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __MUX_H__
+#define __MUX_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+/**
+ *  most sessions of a multiplexer.
+ */
+#define MUX_MAX_SESSIONS (10)
+
+/**
+ *  bytes queued to the client, or to a session, before reading
+ *  from its source pauses.
+ */
+#define MUX_QUEUE_MAX (256 * 1024)
+
+/**
+ *  prefix key of multiplexer commands. (Ctrl-])
+ */
+#define MUX_PREFIX (0x1D)
+
+/**
+ *  one child on its own pty.
+ */
+struct mux_session {
+    pid_t pid;                  /**< child. */
+    int master;                 /**< pty master, or -1 once exited. */
+    int status;                 /**< wait status once exited, -1 until reaped. */
+    bool exited;                /**< the child hung up. */
+    char *ring;                 /**< scrollback. */
+    size_t start;               /**< oldest byte of @c ring. */
+    size_t len;                 /**< bytes held in @c ring. */
+    bool wrapped;               /**< older output was overwritten. */
+    std::string input;          /**< keys not written to the child yet. */
+    uint32_t events;            /**< events registered. */
+};
+
+/**
+ *  sessions served to at most one client.
+ */
+struct mux {
+    int epfd;                   /**< epoll fd. */
+    size_t scrollback;          /**< capacity of each ring. */
+    size_t count;               /**< sessions in use. */
+    size_t active;              /**< session shown to the client. */
+    struct mux_session sessions[MUX_MAX_SESSIONS]; /**< sessions. */
+    int listen_fd;              /**< listening socket, or -1. */
+    int in;                     /**< client input, or -1. */
+    int out;                    /**< client output, or -1. */
+    bool local;                 /**< client is the terminal, not a socket. */
+    uint32_t in_events;         /**< events registered for @c in. */
+    uint32_t out_events;        /**< events registered for @c out. */
+    std::string queue;          /**< output not written to the client yet. */
+    size_t head;                /**< first queued byte of @c queue. */
+    bool prefix;                /**< the prefix key was typed. */
+    bool quit;                  /**< loop is asked to end. */
+};
+
+/**
+ *  initialize multiplexer.
+ */
+int mux_init(struct mux *m, size_t scrollback);
+
+/**
+ *  add child @c pid on pty @c master.
+ */
+int mux_add(struct mux *m, pid_t pid, int master);
+
+/**
+ *  serve sessions until they all exit or the client quits.
+ */
+int mux_run(struct mux *m, int listen_fd, int in, int out);
+
+/**
+ *  release multiplexer, stopping children.
+ */
+void mux_destroy(struct mux *m);
+
+#endif /* __MUX_H__ */
@@ -0,0 +1,252 @@
+/** @file       record.cpp
+ *  @brief      Session recording.
+ *
+ *  records are encoded into a memory buffer on the relaying thread and
+ *  written by a thread of their own, so that the file never delays the
+ *  interactive path. if the writer falls behind by more than
+ *  @ref RECORD_PENDING_MAX bytes, data is dropped and a drop record
+ *  tells how much.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "record.h"
+
+/**
+ *  most bytes waiting for the writer.
+ */
+#define RECORD_PENDING_MAX (4 * 1024 * 1024)
+
+struct recorder {
+    int fd;                         /**< recording file. */
+    uint64_t last;                  /**< time of the previous record. (ns) */
+    uint64_t dropped;               /**< bytes dropped, not reported yet. */
+    std::string pending;            /**< encoded records for the writer. */
+    bool stopping;                  /**< writer is asked to finish. */
+    std::mutex lock;                /**< guards the above. */
+    std::condition_variable cond;   /**< signals the writer. */
+    std::thread writer;             /**< writer thread. */
+};
+
+/**
+ *  get monotonic time in nanoseconds.
+ */
+static uint64_t record_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ *  append @c value as LEB128.
+ */
+static void record_varint(std::string &out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out += (char)(value | 0x80);
+        value >>= 7;
+    }
+    out += (char)value;
+}
+
+/**
+ *  parse LEB128 at @c *pos.
+ *
+ *  @return returns 0 on success.
+ *          on error, -1 is returned.
+ */
+static int record_parse_varint(const char *buf, size_t len, size_t *pos, uint64_t *value)
+{
+    *value = 0;
+    for (int shift = 0; (*pos < len) && (shift < 64); shift += 7) {
+        unsigned char c = buf[(*pos)++];
+        *value |= (uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ *  write pending records until asked to stop.
+ */
+static void record_writer(struct recorder *rec)
+{
+    std::string out;
+    std::unique_lock<std::mutex> guard(rec->lock);
+
+    for (;;) {
+        rec->cond.wait(guard, [rec]() {
+            return rec->stopping || !rec->pending.empty();
+        });
+        if (rec->pending.empty() && rec->stopping) {
+            break;
+        }
+        out.swap(rec->pending);
+        guard.unlock();
+
+        for (size_t pos = 0; pos < out.size();) {
+            ssize_t len = write(rec->fd, &out[pos], out.size() - pos);
+            if (len < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("record");
+                break;
+            }
+            pos += len;
+        }
+        out.clear();
+        guard.lock();
+    }
+}
+
+/**
+ *  open @c path for appending a recording.
+ *
+ *  @param  [in]    path    recording file.
+ *  @return returns recorder on success.
+ *          on error, NULL is returned, and @c errno set.
+ */
+struct recorder *record_open(const char *path)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct recorder *rec = new recorder();
+    rec->fd = fd;
+    rec->last = record_now();
+    rec->dropped = 0;
+    rec->stopping = false;
+    rec->pending = RECORD_MAGIC;
+    rec->writer = std::thread(record_writer, rec);
+
+    return rec;
+}
+
+/**
+ *  add a record, without waiting for the file.
+ *
+ *  @param  [in]    rec     recorder, or NULL.
+ *  @param  [in]    kind    @ref RECORD_INPUT or @ref RECORD_OUTPUT.
+ *  @param  [in]    data    data.
+ *  @param  [in]    len     data length.
+ */
+void record_add(struct recorder *rec, int kind, const char *data, size_t len)
+{
+    if ((rec == NULL) || (len == 0)) {
+        return;
+    }
+
+    uint64_t now = record_now();
+    std::lock_guard<std::mutex> guard(rec->lock);
+    if (rec->pending.size() + len > RECORD_PENDING_MAX) {
+        rec->dropped += len;
+        return;
+    }
+    bool wake = rec->pending.empty();
+    if (rec->dropped > 0) {
+        rec->pending += (char)RECORD_DROP;
+        record_varint(rec->pending, 0);
+        record_varint(rec->pending, rec->dropped);
+        rec->dropped = 0;
+    }
+    rec->pending += (char)kind;
+    record_varint(rec->pending, (now - rec->last) / 1000);
+    record_varint(rec->pending, len);
+    rec->pending.append(data, len);
+    /* the rounding of deltas does not accumulate. */
+    rec->last += (now - rec->last) / 1000 * 1000;
+    if (wake) {
+        rec->cond.notify_one();
+    }
+}
+
+/**
+ *  write pending records and close.
+ *
+ *  @param  [in]    rec     recorder, or NULL.
+ */
+void record_close(struct recorder *rec)
+{
+    if (rec == NULL) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(rec->lock);
+        rec->stopping = true;
+        rec->cond.notify_one();
+    }
+    rec->writer.join();
+    if (rec->dropped > 0) {
+        fprintf(stderr, "record: %llu bytes dropped\n", (unsigned long long)rec->dropped);
+    }
+    close(rec->fd);
+    delete rec;
+}
+
+/**
+ *  parse next record of @c buf.
+ *
+ *  @param  [in]    buf     recording.
+ *  @param  [in]    len     recording length.
+ *  @param  [inout] pos     parse position, 0 at first.
+ *  @param  [inout] base    time of the previous record, 0 at first.
+ *  @param  [out]   entry   record.
+ *  @return returns 1 if a record is parsed, 0 at end of @c buf.
+ *          on error, -1 is returned.
+ */
+int record_next(const char *buf, size_t len, size_t *pos, uint64_t *base, struct record_entry *entry)
+{
+    const size_t magic_len = strlen(RECORD_MAGIC);
+
+    /* another recording appended, it has its own time base. */
+    while ((len - *pos >= magic_len) && (memcmp(&buf[*pos], RECORD_MAGIC, magic_len) == 0)) {
+        *pos += magic_len;
+    }
+    if (*pos >= len) {
+        return 0;
+    }
+
+    uint64_t delta, size;
+    entry->kind = (unsigned char)buf[(*pos)++];
+    if ((record_parse_varint(buf, len, pos, &delta) != 0)
+        || (record_parse_varint(buf, len, pos, &size) != 0)) {
+        return -1;
+    }
+    *base += delta;
+    entry->time = *base;
+    entry->data = &buf[*pos];
+    entry->len = size;
+    if (entry->kind == RECORD_DROP) {
+        entry->data = NULL;
+    } else if ((entry->kind != RECORD_INPUT) && (entry->kind != RECORD_OUTPUT)) {
+        return -1;
+    } else if (size > len - *pos) {
+        return -1;
+    } else {
+        *pos += size;
+    }
+
+    return 1;
+}
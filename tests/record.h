@@ -0,0 +1,75 @@
+/** @file       record.h
+ *  @brief      Session recording.
+ *
+ *  a recording is "ECONREC1" followed by records of
+ *
+ *  | size    | field                                        |
+ *  |---------|----------------------------------------------|
+ *  | 1       | kind, @ref RECORD_INPUT, @ref RECORD_OUTPUT   |
+ *  |         | or @ref RECORD_DROP                          |
+ *  | varint  | microseconds since the previous record       |
+ *  | varint  | data length (bytes lost for RECORD_DROP)     |
+ *  | length  | data (none for RECORD_DROP)                  |
+ *
+ *  varints are LEB128. the magic appears again where another recording
+ *  was appended, its first delta counts from when it was opened.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __RECORD_H__
+#define __RECORD_H__
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ *  recording magic.
+ */
+#define RECORD_MAGIC "ECONREC1"
+
+/**
+ *  record kinds.
+ */
+enum {
+    RECORD_INPUT = 'i',     /**< typed to the child. */
+    RECORD_OUTPUT = 'o',    /**< written by the child. */
+    RECORD_DROP = 'D',      /**< data lost, recorder fell behind. */
+};
+
+/**
+ *  one record read back.
+ */
+struct record_entry {
+    int kind;               /**< record kind. */
+    uint64_t time;          /**< microseconds since start of the recording. */
+    const char *data;       /**< data. */
+    size_t len;             /**< data length. */
+};
+
+struct recorder;
+
+/**
+ *  open @c path for appending a recording.
+ */
+struct recorder *record_open(const char *path);
+
+/**
+ *  add a record, without waiting for the file.
+ */
+void record_add(struct recorder *rec, int kind, const char *data, size_t len);
+
+/**
+ *  write pending records and close.
+ */
+void record_close(struct recorder *rec);
+
+/**
+ *  parse next record of @c buf from @c *pos.
+ */
+int record_next(const char *buf, size_t len, size_t *pos, uint64_t *base, struct record_entry *entry);
+
+#endif /* __RECORD_H__ */
@@ -0,0 +1,435 @@
+/** @file       relay.cpp
+ *  @brief      File descriptor relay.
+ *
+ *  data is moved by splice() through a pipe held by each direction, so
+ *  that it does not pass through user space. where either end does not
+ *  support splice(), or the data is inspected, it is copied through a
+ *  buffer instead. writes which would block are queued, and reading
+ *  stops while the queue is full.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+
+#include "relay.h"
+
+/**
+ *  most queue operations of a direction per round, so that one busy
+ *  direction does not starve the others.
+ */
+#define RELAY_ROUND (16)
+
+/**
+ *  get bytes queued in @c d.
+ */
+static size_t dir_queued(const struct relay_dir *d)
+{
+    return (d->buf != NULL) ? d->tail - d->head : d->pipe_len;
+}
+
+/**
+ *  get room left in the queue of @c d.
+ */
+static size_t dir_room(const struct relay_dir *d)
+{
+    return (d->buf != NULL) ? RELAY_QUEUE_SIZE - (d->tail - d->head) : d->pipe_cap - d->pipe_len;
+}
+
+/**
+ *  switch @c d to copying, moving queued data out of its pipe.
+ *
+ *  @return     returns 0 on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+static int dir_copy_mode(struct relay_dir *d)
+{
+    d->buf = (char *)malloc(RELAY_QUEUE_SIZE);
+    if (d->buf == NULL) {
+        return -1;
+    }
+    d->head = d->tail = 0;
+    if (d->pipe[0] >= 0) {
+        while (d->tail < d->pipe_len) {
+            ssize_t n = read(d->pipe[0], &d->buf[d->tail], d->pipe_len - d->tail);
+            if (n <= 0) {
+                break;
+            }
+            d->tail += n;
+        }
+        close(d->pipe[0]);
+        close(d->pipe[1]);
+        d->pipe[0] = d->pipe[1] = -1;
+        d->pipe_len = 0;
+    }
+
+    return 0;
+}
+
+/**
+ *  read from @c in into the queue of @c d.
+ *
+ *  @return     returns bytes read.
+ */
+static size_t dir_fill(struct relay_dir *d)
+{
+    ssize_t n;
+
+    if (d->buf == NULL) {
+        ++d->splices;
+        n = splice(d->in, NULL, d->pipe[1], NULL, dir_room(d), SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if ((n < 0) && (errno == EINVAL)) {
+            if (dir_copy_mode(d) != 0) {
+                d->done = true;
+                return 0;
+            }
+            return dir_fill(d);
+        }
+        if (n > 0) {
+            d->pipe_len += n;
+        }
+    } else {
+        if (d->tail == RELAY_QUEUE_SIZE) {
+            memmove(d->buf, &d->buf[d->head], d->tail - d->head);
+            d->tail -= d->head;
+            d->head = 0;
+        }
+        ++d->copies;
+        n = read(d->in, &d->buf[d->tail], RELAY_QUEUE_SIZE - d->tail);
+        if ((n > 0) && (d->inspect != NULL)) {
+            bool end = false;
+            d->tail += d->inspect(d->ctx, &d->buf[d->tail], n, &end);
+            if (end) {
+                d->eof = true;
+                d->flags |= RELAY_LAST;
+            }
+            return n;
+        }
+        if (n > 0) {
+            d->tail += n;
+        }
+    }
+
+    if (n > 0) {
+        return n;
+    } else if (n == 0) {
+        d->eof = true;
+    } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        d->in_wait = true;
+    } else if (errno != EINTR) {
+        /* EIO from a pty master whose slave is closed. */
+        d->eof = true;
+    }
+    return 0;
+}
+
+/**
+ *  write queued data of @c d to @c out.
+ *
+ *  @return     returns bytes written.
+ */
+static size_t dir_drain(struct relay_dir *d)
+{
+    ssize_t n;
+
+    if (d->buf == NULL) {
+        ++d->splices;
+        n = splice(d->pipe[0], NULL, d->out, NULL, d->pipe_len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if ((n < 0) && (errno == EINVAL)) {
+            if (dir_copy_mode(d) != 0) {
+                d->done = true;
+                return 0;
+            }
+            return dir_drain(d);
+        }
+        if (n > 0) {
+            d->pipe_len -= n;
+        }
+    } else {
+        ++d->copies;
+        n = write(d->out, &d->buf[d->head], d->tail - d->head);
+        if (n > 0) {
+            d->head += n;
+            if (d->head == d->tail) {
+                d->head = d->tail = 0;
+            }
+        }
+    }
+
+    if (n > 0) {
+        d->bytes += n;
+        return n;
+    } else if ((n < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+        d->out_wait = true;
+    } else if ((n < 0) && (errno != EINTR)) {
+        /* output is gone, the rest is dropped. */
+        d->done = true;
+    }
+    return 0;
+}
+
+/**
+ *  move data of @c d until it would block.
+ *
+ *  @return     returns true if @c d may move more without waiting.
+ */
+static bool dir_step(struct relay_dir *d)
+{
+    for (int i = 0; (i < RELAY_ROUND) && !d->done; ++i) {
+        size_t moved = 0;
+
+        if ((dir_queued(d) > 0) && !d->out_wait) {
+            moved += dir_drain(d);
+        }
+        if (!d->eof && !d->in_wait && !d->done && (dir_room(d) > 0)) {
+            moved += dir_fill(d);
+        }
+        if (d->eof && (dir_queued(d) == 0)) {
+            d->done = true;
+        }
+        if (moved == 0) {
+            return false;
+        }
+    }
+    return !d->done;
+}
+
+/**
+ *  get slot of @c fd, adding it in non-blocking mode.
+ *
+ *  @return     returns slot index on success.
+ *              on error, -1 is returned, and @c errno set.
+ */
+static int relay_fd(struct relay *r, int fd)
+{
+    for (size_t i = 0; i < r->nfds; ++i) {
+        if (r->fds[i].fd == fd) {
+            return i;
+        }
+    }
+
+    int flags = fcntl(fd, F_GETFL);
+    if ((flags < 0) || (fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0)) {
+        return -1;
+    }
+    size_t i = r->nfds++;
+    r->fds[i].fd = fd;
+    r->fds[i].events = 0;
+    r->fds[i].flags = flags;
+    r->fds[i].ready = false;
+
+    struct epoll_event ev = {};
+    ev.data.u32 = i;
+    if (epoll_ctl(r->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        if (errno != EPERM) {
+            return -1;
+        }
+        /* a regular file, never blocks. */
+        r->fds[i].ready = true;
+    }
+
+    return i;
+}
+
+/**
+ *  initialize relay.
+ *
+ *  @param  [out]   r       relay.
+ *  @return returns 0 on success.
+ *          on error, -1 is returned, and @c errno set.
+ */
+int relay_init(struct relay *r)
+{
+    memset(r, 0, sizeof(*r));
+    r->epfd = epoll_create1(EPOLL_CLOEXEC);
+
+    return (r->epfd < 0) ? -1 : 0;
+}
+
+/**
+ *  add a direction from @c in to @c out.
+ *
+ *  @param  [in]    r       relay.
+ *  @param  [in]    in      source fd.
+ *  @param  [in]    out     destination fd.
+ *  @param  [in]    flags   @ref RELAY_COPY, @ref RELAY_LAST.
+ *  @param  [in]    inspect inspector of data read, or NULL.
+ *                          an inspected direction always copies.
+ *  @param  [in]    ctx     inspector context.
+ *  @return returns 0 on success.
+ *          on error, -1 is returned, and @c errno set.
+ */
+int relay_add(struct relay *r, int in, int out, int flags,
+              relay_inspect_fn inspect, void *ctx)
+{
+    if (r->count >= RELAY_MAX_DIRS) {
+        errno = ENOSPC;
+        return -1;
+    }
+    if ((relay_fd(r, in) < 0) || (relay_fd(r, out) < 0)) {
+        return -1;
+    }
+
+    struct relay_dir *d = &r->dirs[r->count];
+    memset(d, 0, sizeof(*d));
+    d->in = in;
+    d->out = out;
+    d->flags = flags;
+    d->inspect = inspect;
+    d->ctx = ctx;
+    d->pipe[0] = d->pipe[1] = -1;
+    if ((inspect != NULL) || (flags & RELAY_COPY) || (pipe2(d->pipe, O_CLOEXEC) != 0)) {
+        if (dir_copy_mode(d) != 0) {
+            return -1;
+        }
+    } else {
+        int cap = fcntl(d->pipe[0], F_GETPIPE_SZ);
+        d->pipe_cap = ((cap <= 0) || (cap > RELAY_QUEUE_SIZE)) ? RELAY_QUEUE_SIZE : cap;
+    }
+    ++r->count;
+
+    return 0;
+}
+
+/**
+ *  register events wanted by waiting directions.
+ */
+static int relay_watch(struct relay *r)
+{
+    for (size_t i = 0; i < r->nfds; ++i) {
+        if (r->fds[i].ready) {
+            continue;
+        }
+
+        uint32_t events = 0;
+        for (size_t j = 0; j < r->count; ++j) {
+            const struct relay_dir *d = &r->dirs[j];
+            if (d->done) {
+                continue;
+            }
+            if ((d->in == r->fds[i].fd) && d->in_wait) {
+                events |= EPOLLIN;
+            }
+            if ((d->out == r->fds[i].fd) && d->out_wait) {
+                events |= EPOLLOUT;
+            }
+        }
+        if (events != r->fds[i].events) {
+            struct epoll_event ev = {};
+            ev.events = events;
+            ev.data.u32 = i;
+            if (epoll_ctl(r->epfd, EPOLL_CTL_MOD, r->fds[i].fd, &ev) != 0) {
+                return -1;
+            }
+            r->fds[i].events = events;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ *  clear waits of directions on fd slot @c i for @c events.
+ */
+static void relay_wake(struct relay *r, size_t i, uint32_t events)
+{
+    for (size_t j = 0; j < r->count; ++j) {
+        struct relay_dir *d = &r->dirs[j];
+
+        if ((d->in == r->fds[i].fd) && (events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+            d->in_wait = false;
+        }
+        if ((d->out == r->fds[i].fd) && (events & (EPOLLOUT | EPOLLHUP | EPOLLERR))) {
+            d->out_wait = false;
+        }
+    }
+}
+
+/**
+ *  pass data until a @ref RELAY_LAST direction ends, or all do.
+ *
+ *  queued data of the ending direction is passed on first.
+ *
+ *  @param  [in]    r       relay.
+ *  @return returns 0 on success.
+ *          on error, -1 is returned, and @c errno set.
+ */
+int relay_run(struct relay *r)
+{
+    for (;;) {
+        bool busy = false;
+        bool ended = true;
+
+        for (size_t i = 0; i < r->nfds; ++i) {
+            if (r->fds[i].ready) {
+                relay_wake(r, i, EPOLLIN | EPOLLOUT);
+            }
+        }
+        for (size_t i = 0; i < r->count; ++i) {
+            struct relay_dir *d = &r->dirs[i];
+
+            busy = dir_step(d) || busy;
+            if (d->done && (d->flags & RELAY_LAST)) {
+                return 0;
+            }
+            ended = ended && d->done;
+        }
+        if (ended) {
+            return 0;
+        }
+        if (relay_watch(r) != 0) {
+            return -1;
+        }
+
+        struct epoll_event evs[2 * RELAY_MAX_DIRS];
+        int nevs = epoll_wait(r->epfd, evs, r->nfds, (busy) ? 0 : -1);
+        if (nevs < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        for (int e = 0; e < nevs; ++e) {
+            size_t i = evs[e].data.u32;
+
+            if (evs[e].events & (EPOLLHUP | EPOLLERR)) {
+                /* reported on every wait from now on, stop watching. */
+                epoll_ctl(r->epfd, EPOLL_CTL_DEL, r->fds[i].fd, NULL);
+                r->fds[i].ready = true;
+            }
+            relay_wake(r, i, evs[e].events);
+        }
+    }
+}
+
+/**
+ *  release relay, restoring fd flags.
+ *
+ *  @param  [in]    r       relay.
+ */
+void relay_destroy(struct relay *r)
+{
+    for (size_t i = 0; i < r->count; ++i) {
+        struct relay_dir *d = &r->dirs[i];
+
+        if (d->pipe[0] >= 0) {
+            close(d->pipe[0]);
+            close(d->pipe[1]);
+        }
+        free(d->buf);
+    }
+    for (size_t i = 0; i < r->nfds; ++i) {
+        fcntl(r->fds[i].fd, F_SETFL, r->fds[i].flags);
+    }
+    close(r->epfd);
+    r->count = r->nfds = 0;
+}
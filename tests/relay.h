@@ -0,0 +1,107 @@
+/** @file       relay.h
+ *  @brief      File descriptor relay.
+ *
+ *  @author     t-kenji <protect.2501@gmail.com>
+ *  @date       2026-10-16 create new.
+ *  @copyright  Copyright © 2018 t-kenji
+ *
+ *  This code is licensed under the MIT License.
+ */
+#ifndef __RELAY_H__
+#define __RELAY_H__
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ *  most directions of a relay.
+ */
+#define RELAY_MAX_DIRS (4)
+
+/**
+ *  bytes queued per direction.
+ */
+#define RELAY_QUEUE_SIZE (64 * 1024)
+
+/**
+ *  direction flags.
+ */
+enum {
+    RELAY_COPY = 0x01,  /**< copy through a user buffer, never splice. */
+    RELAY_LAST = 0x02,  /**< relay ends when this direction ends. */
+};
+
+/**
+ *  look at data read by a direction.
+ *
+ *  @c data may be rewritten in place, no longer than @c len.
+ *  setting @c end ends the direction after passing the data on,
+ *  and so the relay.
+ *
+ *  @return     returns bytes of @c data to pass on.
+ */
+typedef size_t (*relay_inspect_fn)(void *ctx, char *data, size_t len, bool *end);
+
+/**
+ *  one direction of a relay.
+ */
+struct relay_dir {
+    int in;                     /**< source fd. */
+    int out;                    /**< destination fd. */
+    int flags;                  /**< direction flags. */
+    relay_inspect_fn inspect;   /**< inspector, or NULL. */
+    void *ctx;                  /**< inspector context. */
+    int pipe[2];                /**< queue for splice, or -1. */
+    size_t pipe_len;            /**< bytes held in @c pipe. */
+    size_t pipe_cap;            /**< capacity of @c pipe. */
+    char *buf;                  /**< queue for copying, or NULL. */
+    size_t head;                /**< first queued byte of @c buf. */
+    size_t tail;                /**< end of queued bytes of @c buf. */
+    bool in_wait;               /**< @c in would block. */
+    bool out_wait;              /**< @c out would block. */
+    bool eof;                   /**< nothing more comes from @c in. */
+    bool done;                  /**< direction ended. */
+    uint64_t bytes;             /**< bytes passed on. */
+    uint64_t splices;           /**< splice calls. */
+    uint64_t copies;            /**< read and write calls. */
+};
+
+/**
+ *  relay between file descriptors.
+ */
+struct relay {
+    int epfd;                   /**< epoll fd. */
+    size_t count;               /**< directions in use. */
+    struct relay_dir dirs[RELAY_MAX_DIRS]; /**< directions. */
+    struct {
+        int fd;                 /**< watched fd. */
+        uint32_t events;        /**< events registered. */
+        int flags;              /**< file status flags to restore. */
+        bool ready;             /**< not watched, taken as always ready.
+                                     (hung up, or not pollable) */
+    } fds[2 * RELAY_MAX_DIRS];  /**< fds of all directions. */
+    size_t nfds;                /**< fds in use. */
+};
+
+/**
+ *  initialize relay.
+ */
+int relay_init(struct relay *r);
+
+/**
+ *  add a direction from @c in to @c out.
+ */
+int relay_add(struct relay *r, int in, int out, int flags,
+              relay_inspect_fn inspect, void *ctx);
+
+/**
+ *  pass data until a @ref RELAY_LAST direction ends.
+ */
+int relay_run(struct relay *r);
+
+/**
+ *  release relay, restoring fd flags.
+ */
+void relay_destroy(struct relay *r);
+
+#endif /* __RELAY_H__ */
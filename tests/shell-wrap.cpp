@@ -12,16 +12,44 @@
 #include <cstdbool>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <cerrno>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <inttypes.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <signal.h>
 #include <termios.h>
-#include <sys/epoll.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
 
 #include "ascii.h"
+#include "mux.h"
+#include "record.h"
+#include "relay.h"
+
+/**
+ *  wrapper options and state.
+ */
+struct wrap {
+    const char *record_path;    /**< recording to append to, or NULL. */
+    const char *replay_path;    /**< recording to replay, or NULL. */
+    bool fast;                  /**< replay without the recorded delays. */
+    size_t count;               /**< children to run. */
+    size_t scrollback;          /**< bytes of output kept per child. */
+    const char *serve_path;     /**< socket to serve children on, or NULL. */
+    const char *attach_path;    /**< socket to attach to, or NULL. */
+    struct recorder *rec;       /**< recorder, or NULL. */
+    bool prefix;                /**< the user typed Ctrl-], a command key follows. */
+    bool stopping;              /**< replay is asked to stop. */
+    std::mutex lock;            /**< guards @c stopping. */
+    std::condition_variable cond; /**< signals @c stopping. */
+};
 
 /**
  *  command usage.
@@ -30,35 +58,194 @@
  */
 static void usage(const char *name)
 {
-    printf("usage: %s command [args]\n", name);
+    printf("usage: %s [-r record-file] [-p replay-file [-F]] command [args]\n"
+           "       %s [-n count] [-m scrollback-bytes] [-S socket] command [args]\n"
+           "       %s -a socket\n"
+           "\n"
+           "Ctrl-] and then q quits, Ctrl-] itself. with -n or -S, also\n"
+           "0-9 select, n next, l list, d detach.\n",
+           name, name, name);
 }
 
-static int invoke(int argc, char **argv)
+/**
+ *  record keys, taking out Ctrl-] and the command key after it.
+ *
+ *  everything else, ETX too, goes to the child.
+ *
+ *  @return returns bytes to pass to the child.
+ */
+static size_t wrap_keys(void *ctx, char *data, size_t len, bool *end)
 {
-    struct termios old_term;
-    struct winsize old_size;
+    struct wrap *w = (struct wrap *)ctx;
+    size_t kept = 0;
 
-    tcgetattr(STDIN_FILENO, &old_term);
-    ioctl(STDIN_FILENO, TIOCGWINSZ, (char *)&old_size);
+    for (size_t i = 0; (i < len) && !*end; ++i) {
+        if (w->prefix) {
+            w->prefix = false;
+            if (data[i] == 'q') {
+                *end = true;
+            } else if (data[i] == MUX_PREFIX) {
+                data[kept++] = data[i];
+            }
+        } else if (data[i] == MUX_PREFIX) {
+            w->prefix = true;
+        } else {
+            data[kept++] = data[i];
+        }
+    }
+    record_add(w->rec, RECORD_INPUT, data, kept);
+    return kept;
+}
+
+/**
+ *  record replayed input.
+ */
+static size_t wrap_replayed(void *ctx, char *data, size_t len, bool *end)
+{
+    record_add(((struct wrap *)ctx)->rec, RECORD_INPUT, data, len);
+    return len;
+}
+
+/**
+ *  record output of the child.
+ */
+static size_t wrap_output(void *ctx, char *data, size_t len, bool *end)
+{
+    record_add(((struct wrap *)ctx)->rec, RECORD_OUTPUT, data, len);
+    return len;
+}
+
+/**
+ *  get monotonic time in microseconds.
+ */
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ *  wait until @c until. (microseconds)
+ *
+ *  @return returns false if the replay is stopped meanwhile.
+ */
+static bool replay_wait(struct wrap *w, uint64_t until)
+{
+    uint64_t now = now_us();
+    std::unique_lock<std::mutex> guard(w->lock);
+
+    if (until > now) {
+        w->cond.wait_for(guard, std::chrono::microseconds(until - now), [w]() {
+            return w->stopping;
+        });
+    }
+    return !w->stopping;
+}
+
+/**
+ *  write recorded input to @c fd, then close it.
+ *
+ *  the child is stopped once the recording is over and it has not
+ *  exited by itself, after the recorded time following the last input
+ *  (none if fast) and a second of grace.
+ */
+static void replay(struct wrap *w, const std::string &recording, int fd, pid_t cpid)
+{
+    struct record_entry entry;
+    uint64_t base = 0;
+    uint64_t last = 0;
+    uint64_t start = now_us();
+    size_t pos = 0;
+    int ret;
 
+    while ((ret = record_next(recording.data(), recording.size(), &pos, &base, &entry)) > 0) {
+        last = entry.time;
+        if (entry.kind != RECORD_INPUT) {
+            continue;
+        }
+        if (!replay_wait(w, (w->fast) ? 0 : start + entry.time)) {
+            break;
+        }
+        for (size_t done = 0; done < entry.len;) {
+            ssize_t len = write(fd, &entry.data[done], entry.len - done);
+            if (len <= 0) {
+                break;
+            }
+            done += len;
+        }
+        if (w->fast) {
+            start = now_us() - entry.time;
+        }
+    }
+    if (ret < 0) {
+        fprintf(stderr, "replay: broken recording at %zu\r\n", pos);
+    }
+    close(fd);
+
+    if (replay_wait(w, ((w->fast) ? now_us() : start + last) + 1000000)) {
+        kill(cpid, SIGTERM);
+    }
+}
+
+/**
+ *  load @c path into @c out.
+ *
+ *  @return returns 0 on success.
+ *          on error, -1 is returned, and @c errno set.
+ */
+static int load(const char *path, std::string &out)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return -1;
+    }
+    char buf[65536];
+    size_t len;
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        out.append(buf, len);
+    }
+    fclose(fp);
+
+    return 0;
+}
+
+/**
+ *  start @c argv on a new pty set up as @c term and @c size.
+ *
+ *  @param  [in]    argv    command and arguments.
+ *  @param  [in]    term    terminal settings.
+ *  @param  [in]    size    window size.
+ *  @param  [out]   master  pty master.
+ *  @return returns pid of the child on success.
+ *          on error, -1 is returned.
+ */
+static pid_t spawn(char **argv, const struct termios *term, const struct winsize *size, int *master)
+{
     int pty_master = posix_openpt(O_RDWR);
     grantpt(pty_master);
     unlockpt(pty_master);
+    fcntl(pty_master, F_SETFD, FD_CLOEXEC);
     char *pts_name = ptsname(pty_master);
     printf("using pts: %s\n", pts_name);
+    fflush(stdout);
+
+    /* held until the child has it, so that the master does not hang up early. */
+    int pty_hold = open(pts_name, O_RDWR | O_NOCTTY);
 
     pid_t cpid = fork();
     if (cpid < 0) {
+        close(pty_hold);
         close(pty_master);
-        perror("fork");
-        return 1;
+        return -1;
     } else if (cpid == 0) {
         setsid();
         close(pty_master);
 
         int pty_slave = open(pts_name, O_RDWR);
-        tcsetattr(pty_slave, TCSAFLUSH, &old_term);
-        ioctl(pty_slave, TIOCSWINSZ, &old_size);
+        tcsetattr(pty_slave, TCSAFLUSH, term);
+        ioctl(pty_slave, TIOCSWINSZ, size);
 
         if (dup2(pty_slave, STDIN_FILENO) < 0) {
             perror("dup2");
@@ -73,96 +260,262 @@ static int invoke(int argc, char **argv)
             exit(2);
         }
         close(pty_slave);
+        close(pty_hold);
 
         execvp(argv[0], argv);
         perror("execvp");
         exit(2);
+    }
+    close(pty_hold);
+    *master = pty_master;
+
+    return cpid;
+}
+
+/**
+ *  put terminal @c fd in raw mode, starting from @c term.
+ */
+static void raw_mode(int fd, const struct termios *term)
+{
+    struct termios new_term = *term;
+
+    new_term.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+    new_term.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+    new_term.c_cflag &= ~(CSIZE | PARENB);
+    new_term.c_cflag |= CS8;
+    new_term.c_oflag &= ~(OPOST);
+    new_term.c_cc[VMIN] = 1;
+    new_term.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSAFLUSH, &new_term);
+}
+
+/**
+ *  run one child, relaying the terminal to it.
+ */
+static int invoke(struct wrap *w, int argc, char **argv)
+{
+    std::string recording;
+
+    if ((w->replay_path != NULL) && (load(w->replay_path, recording) != 0)) {
+        perror(w->replay_path);
+        return 1;
+    }
+    if ((w->record_path != NULL) && ((w->rec = record_open(w->record_path)) == NULL)) {
+        perror(w->record_path);
+        return 1;
+    }
+
+    struct termios old_term;
+    struct winsize old_size;
+
+    tcgetattr(STDIN_FILENO, &old_term);
+    ioctl(STDIN_FILENO, TIOCGWINSZ, (char *)&old_size);
+
+    int pty_master;
+    pid_t cpid = spawn(argv, &old_term, &old_size, &pty_master);
+    if (cpid < 0) {
+        record_close(w->rec);
+        perror("fork");
+        return 1;
     } else {
+        struct relay relay;
+        std::thread replayer;
+        int replay_fds[2] = {-1, -1};
 
-        do {
-            int epfd;
-            struct epoll_event ev;
-            struct termios new_term = old_term;
-
-            new_term.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
-            new_term.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
-            new_term.c_cflag &= ~(CSIZE | PARENB);
-            new_term.c_cflag |= CS8;
-            new_term.c_oflag &= ~(OPOST);
-            new_term.c_cc[VMIN] = 1;
-            new_term.c_cc[VTIME] = 0;
-            tcsetattr(STDIN_FILENO, TCSAFLUSH, &new_term);
-
-            epfd = epoll_create1(0);
-            if (epfd < 0) {
-                perror("epoll_create1");
-                break;
+        raw_mode(STDIN_FILENO, &old_term);
+
+        /*
+         * output of the child is spliced unless recorded,
+         * keys are copied to find Ctrl-].
+         */
+        int ret = relay_init(&relay);
+        if ((ret == 0) && (w->replay_path != NULL)) {
+            ret = pipe(replay_fds);
+            if (ret == 0) {
+                ret = relay_add(&relay, replay_fds[0], pty_master, 0, (w->rec) ? wrap_replayed : NULL, w);
             }
-            ev.events = EPOLLIN;
-            ev.data.fd = STDIN_FILENO;
-            if (epoll_ctl(epfd, EPOLL_CTL_ADD, STDIN_FILENO, &ev) != 0) {
-                perror("epoll_ctl");
-                break;
+            if (ret == 0) {
+                replayer = std::thread(replay, w, std::cref(recording), replay_fds[1], cpid);
             }
-            ev.data.fd = pty_master;
-            if (epoll_ctl(epfd, EPOLL_CTL_ADD, pty_master, &ev) != 0) {
-                perror("epoll_ctl");
-                break;
+        }
+        if ((ret != 0)
+            || (relay_add(&relay, STDIN_FILENO, pty_master, 0, wrap_keys, w) != 0)
+            || (relay_add(&relay, pty_master, STDOUT_FILENO, RELAY_LAST, (w->rec) ? wrap_output : NULL, w) != 0)
+            || (relay_run(&relay) != 0)) {
+            perror("relay");
+        }
+        relay_destroy(&relay);
+
+        kill(cpid, SIGTERM);
+        if (replayer.joinable()) {
+            {
+                std::lock_guard<std::mutex> guard(w->lock);
+                w->stopping = true;
+                w->cond.notify_one();
             }
+            replayer.join();
+        }
+        if (replay_fds[0] >= 0) {
+            close(replay_fds[0]);
+        }
+        record_close(w->rec);
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &old_term);
+        close(pty_master);
+    }
+
+    return 0;
+}
+
+/**
+ *  relay the terminal to the multiplexer serving @c path.
+ */
+static int attach(const char *path)
+{
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror(path);
+        close(fd);
+        return 1;
+    }
+
+    struct termios old_term;
+    struct relay relay;
+
+    tcgetattr(STDIN_FILENO, &old_term);
+    raw_mode(STDIN_FILENO, &old_term);
+
+    /* the multiplexer ends the relay by closing the socket. */
+    if ((relay_init(&relay) != 0)
+        || (relay_add(&relay, STDIN_FILENO, fd, 0, NULL, NULL) != 0)
+        || (relay_add(&relay, fd, STDOUT_FILENO, RELAY_LAST, NULL, NULL) != 0)
+        || (relay_run(&relay) != 0)) {
+        perror("relay");
+    }
+    relay_destroy(&relay);
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &old_term);
+    close(fd);
+
+    return 0;
+}
+
+/**
+ *  listen on a Unix socket at @c path.
+ *
+ *  @return returns the socket on success.
+ *          on error, -1 is returned, and @c errno set.
+ */
+static int listen_on(const char *path)
+{
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (fd < 0) {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        close(fd);
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) || (listen(fd, 4) != 0)) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ *  run children under the multiplexer.
+ *
+ *  with a socket, the multiplexer runs in the background and outlives
+ *  the terminal, which attaches as its first client.
+ */
+static int multiplex(struct wrap *w, char **argv)
+{
+    struct termios old_term;
+    struct winsize old_size;
+    int listen_fd = -1;
+
+    tcgetattr(STDIN_FILENO, &old_term);
+    ioctl(STDIN_FILENO, TIOCGWINSZ, (char *)&old_size);
+
+    if (w->serve_path != NULL) {
+        listen_fd = listen_on(w->serve_path);
+        if (listen_fd < 0) {
+            perror(w->serve_path);
+            return 1;
+        }
+        pid_t server = fork();
+        if (server < 0) {
+            perror("fork");
+            unlink(w->serve_path);
+            close(listen_fd);
+            return 1;
+        } else if (server > 0) {
+            close(listen_fd);
+            return attach(w->serve_path);
+        }
 
-            bool is_exit = false;
-            do {
-                static char buf[BUFSIZ];
-                static struct epoll_event evs[10];
-                int nevs = epoll_wait(epfd, evs, 10, -1);
-                if (nevs < 0) {
-                    perror("epoll_wait");
-                    continue;
-                }
-                for (int i = 0; i < nevs; ++i) {
-                    ssize_t read_len, written_len;
-                    uint32_t events = evs[i].events;
-                    int fd = evs[i].data.fd;
-
-                    if ((events & EPOLLIN) && (fd == STDIN_FILENO)) {
-                        read_len = read(STDIN_FILENO, buf, sizeof(buf));
-                        if (read_len < 0) {
-                            perror("read");
-                        }
-                        switch (buf[0]) {
-                        case ETX:
-                            is_exit = true;
-                            printf("^C\r\n");
-                            break;
-                        default:
-                            written_len = write(pty_master, buf, read_len);
-                            if (written_len < 0) {
-                                perror("write");
-                            }
-                            break;
-                        }
-                    } else if ((events & EPOLLIN) && (fd == pty_master)) {
-                        read_len = read(pty_master, buf, sizeof(buf));
-                        if (read_len < 0) {
-                            perror("read");
-                        }
-                        written_len = write(STDOUT_FILENO, buf, read_len);
-                        if (written_len < 0) {
-                            perror("write");
-                        }
-                    } else {
-                        is_exit = !!(events & (EPOLLHUP | EPOLLERR));
-                    }
-                }
-            } while (!is_exit);
+        setsid();
+        int null = open("/dev/null", O_RDWR);
+        dup2(null, STDIN_FILENO);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        close(null);
+    }
 
+    struct mux m;
+    if (mux_init(&m, w->scrollback) != 0) {
+        perror("mux");
+        return 1;
+    }
+    for (size_t i = 0; i < w->count; ++i) {
+        int pty_master;
+        pid_t cpid = spawn(argv, &old_term, &old_size, &pty_master);
+        if (cpid < 0) {
+            perror("fork");
+            break;
+        }
+        if (mux_add(&m, cpid, pty_master) != 0) {
+            perror("mux");
             kill(cpid, SIGTERM);
-            tcsetattr(STDIN_FILENO, TCSAFLUSH, &old_term);
+            waitpid(cpid, NULL, 0);
             close(pty_master);
-        } while (0);
+            break;
+        }
     }
 
-    return 0;
+    int ret;
+    if (listen_fd >= 0) {
+        ret = mux_run(&m, listen_fd, -1, -1);
+        unlink(w->serve_path);
+        close(listen_fd);
+    } else {
+        raw_mode(STDIN_FILENO, &old_term);
+        ret = mux_run(&m, -1, STDIN_FILENO, STDOUT_FILENO);
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &old_term);
+    }
+    if (ret != 0) {
+        perror("mux");
+    }
+    mux_destroy(&m);
+
+    return (ret == 0) ? 0 : 1;
 }
 
 /**
@@ -175,16 +528,61 @@ static int invoke(int argc, char **argv)
  */
 int main(int argc, char **argv)
 {
-    enum {
-        ARG_SELF,
-        ARG_COMMAND,
-        ARG_COMMAND_ARGS,
-    };
-
-    if (argc < ARG_COMMAND_ARGS) {
-        usage(argv[ARG_SELF]);
+    struct wrap w;
+    int opt;
+
+    w.record_path = w.replay_path = NULL;
+    w.fast = w.prefix = w.stopping = false;
+    w.rec = NULL;
+    w.count = 1;
+    w.scrollback = 64 * 1024;
+    w.serve_path = w.attach_path = NULL;
+    signal(SIGPIPE, SIG_IGN);
+
+    /* options after the command belong to it. */
+    while ((opt = getopt(argc, argv, "+r:p:Fn:m:S:a:")) != -1) {
+        switch (opt) {
+        case 'r':
+            w.record_path = optarg;
+            break;
+        case 'p':
+            w.replay_path = optarg;
+            break;
+        case 'F':
+            w.fast = true;
+            break;
+        case 'n':
+            w.count = strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            w.scrollback = strtoul(optarg, NULL, 0);
+            break;
+        case 'S':
+            w.serve_path = optarg;
+            break;
+        case 'a':
+            w.attach_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            exit(1);
+        }
+    }
+    if (w.attach_path != NULL) {
+        return attach(w.attach_path);
+    }
+    if ((optind >= argc) || (w.count < 1) || (w.count > MUX_MAX_SESSIONS) || (w.scrollback == 0)) {
+        usage(argv[0]);
         exit(1);
     }
+    if ((w.count > 1) || (w.serve_path != NULL)) {
+        if ((w.record_path != NULL) || (w.replay_path != NULL)) {
+            /* recording is of one child. */
+            usage(argv[0]);
+            exit(1);
+        }
+        return multiplex(&w, &argv[optind]);
+    }
 
-    return invoke(argc - ARG_COMMAND, &argv[ARG_COMMAND]);
+    return invoke(&w, argc - optind, &argv[optind]);
 }